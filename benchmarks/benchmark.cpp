@@ -11,6 +11,11 @@
 #include <algorithm>   // For std::min_element, std::max_element, std::transform
 #include <cmath>       // For std::sqrt
 #include <type_traits> // For std::remove_reference_t
+#include <thread>      // For std::this_thread::sleep_for
+#include <cstdint>     // For std::uint64_t
+#include <filesystem>  // For std::filesystem::remove
+#include <atomic>      // For the merge event consumer flag
+#include <functional>  // For std::greater
 
 // Assuming union_find.hpp defines the canonical OperationType and Operation struct
 #include "union_find.hpp" // Serial (defines CanonicalOperation)
@@ -23,6 +28,7 @@
 #endif
 #ifdef UNIONFIND_LOCKFREE_ENABLED
 #include "union_find_parallel_lockfree.hpp"
+#include "disjoint_set_map.hpp"
 #endif
 #ifdef UNIONFIND_LOCKFREE_PLAIN_ENABLED // Include the new header
 #include "union_find_parallel_lockfree_plain_write.hpp"
@@ -30,20 +36,68 @@
 #ifdef UNIONFIND_LOCKFREE_IPC_ENABLED // Include the new header
 #include "union_find_parallel_lockfree_ipc.hpp"
 #endif
+#ifdef UNIONFIND_RELATIVE_ENABLED
+#include "union_find_relative.hpp"
+#endif
+
+#include "background_compactor.hpp"
+#include "root_hint_cache.hpp"
+#include "timeline_trace.hpp"
+#include "hot_element_profiler.hpp"
+#include "durable_union_find.hpp"
+#include "union_find_stats.hpp"
+#include "merge_event_stream.hpp"
+#include "query_deduplicator.hpp"
+#include "compressed_trace.hpp"
+#include "trace_recorder.hpp"
+#include "replicated_union_find.hpp"
+#include "top_k_tracker.hpp"
+#include "transactional_union_find.hpp"
 
 // Use the Operation struct and OperationType defined within the canonical UnionFind class.
 using CanonicalOperation = UnionFind::Operation;
 using CanonicalOperationType = UnionFind::OperationType;
 
 
+// Loads a compressed trace (compressed_trace.hpp) with a parallel decode of all blocks.
+bool load_compressed_operations(const std::string& filename, int& n_elements, std::vector<CanonicalOperation>& ops)
+{
+    try
+    {
+        CompressedTraceReader reader(filename);
+        auto start_time = std::chrono::high_resolution_clock::now();
+        reader.readAll(ops);
+        auto end_time = std::chrono::high_resolution_clock::now();
+        n_elements = reader.elements();
+        double decode_ms = std::chrono::duration<double, std::milli>(end_time - start_time).count();
+        std::cout << "Successfully decoded " << ops.size() << " operations for " << n_elements << " elements from "
+                  << filename << " (" << reader.blocks() << " blocks, " << std::fixed << std::setprecision(2)
+                  << static_cast<double>(reader.fileBytes()) / std::max<size_t>(ops.size(), 1) << " bytes/op, "
+                  << decode_ms << " ms, " << ops.size() / decode_ms / 1000.0 << " Mops/s)" << std::endl;
+        std::cout.unsetf(std::ios::floatfield);
+        std::cout << std::setprecision(6);
+        return true;
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "Error: " << e.what() << std::endl;
+        ops.clear();
+        return false;
+    }
+}
+
 // Function to load operations from a file
-// Format:
+// Compressed traces (see compressed_trace.hpp) are detected by their magic; otherwise the text format:
 // <num_elements> <num_operations>
-// <type> <a> <b>  (type: 0 for UNION, 1 for FIND, 2 for SAMESET)
+// <type> <a> <b>  (type: 0 for UNION, 1 for FIND, 2 for SAMESET, 3 for RANGE_UNION of [a, b])
 // ...
 // Loads into std::vector<CanonicalOperation>
 bool load_operations(const std::string& filename, int& n_elements, std::vector<CanonicalOperation>& ops) 
 {
+    if (CompressedTraceReader::isCompressedTrace(filename)) 
+    {
+        return load_compressed_operations(filename, n_elements, ops);
+    }
     std::ifstream infile(filename);
     if (!infile) 
     {
@@ -78,9 +132,9 @@ bool load_operations(const std::string& filename, int& n_elements, std::vector<C
 
         // --- Validation ---
         // 1. Check valid type value
-        if (type_val < 0 || type_val > 2) 
+        if (type_val < 0 || type_val > 3) 
         {
-            std::cerr << "Error: Invalid operation type at line " << i + 2 << ": type=" << type_val << " (must be 0, 1, or 2)" << std::endl;
+            std::cerr << "Error: Invalid operation type at line " << i + 2 << ": type=" << type_val << " (must be 0, 1, 2 or 3)" << std::endl;
             ops.clear();
             return false;
         }
@@ -91,11 +145,11 @@ bool load_operations(const std::string& filename, int& n_elements, std::vector<C
             ops.clear();
             return false;
         }
-        // 3. Check index 'b' bounds (required for UNION and SAMESET)
-        if (type_val == 0 || type_val == 2) 
+        // 3. Check index 'b' bounds (required for UNION, SAMESET and RANGE_UNION)
+        if (type_val != 1) 
         {
             if (b < 0 || b >= n_elements) {
-                std::cerr << "Error: Invalid index 'b' for UNION/SAMESET op at line " << i + 2 << ": b=" << b << " (n_elements=" << n_elements << ")" << std::endl;
+                std::cerr << "Error: Invalid index 'b' for UNION/SAMESET/RANGE_UNION op at line " << i + 2 << ": b=" << b << " (n_elements=" << n_elements << ")" << std::endl;
                 ops.clear();
                 return false;
             }
@@ -113,6 +167,7 @@ bool load_operations(const std::string& filename, int& n_elements, std::vector<C
             case 0: op.type = CanonicalOperationType::UNION_OP; break;
             case 1: op.type = CanonicalOperationType::FIND_OP; break;
             case 2: op.type = CanonicalOperationType::SAMESET_OP; break;
+            case 3: op.type = CanonicalOperationType::RANGE_UNION_OP; break;
             // default case already handled by validation above
         }
         ops.push_back(op);
@@ -124,11 +179,20 @@ bool load_operations(const std::string& filename, int& n_elements, std::vector<C
         // Decide if this is a fatal error or just a warning
     }
 
-    std::cout << "Successfully loaded " << ops.size() << " operations (UNION=0, FIND=1, SAMESET=2) for "
+    std::cout << "Successfully loaded " << ops.size() << " operations (UNION=0, FIND=1, SAMESET=2, RANGE_UNION=3) for "
               << n_elements << " elements from " << filename << std::endl;
     return true;
 }
 
+// Maps a dense element id to a distinct, hash-like 64-bit key (splitmix64 is a bijection).
+inline std::uint64_t sparse_key(int id)
+{
+    std::uint64_t x = static_cast<std::uint64_t>(id) + 0x9e3779b97f4a7c15ULL;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+}
+
 // Helper function to convert between compatible Operation structs
 // Assumes the structs have the same members (type, a, b) and compatible enum values.
 template <typename TargetOp, typename SourceOp>
@@ -138,22 +202,85 @@ TargetOp convert_operation(const SourceOp& source_op)
     // Use static_cast for the enum type conversion. This relies on the enum values
     // (e.g., UNION_OP=0, FIND_OP=1, SAMESET_OP=2) being consistent across implementations.
     target_op.type = static_cast<decltype(TargetOp::type)>(source_op.type);
-    target_op.a = source_op.a;
-    target_op.b = source_op.b;
+    if constexpr (std::is_same_v<decltype(TargetOp::a), int>)
+    {
+        target_op.a = source_op.a;
+        target_op.b = source_op.b;
+    }
+    else
+    {
+        // Sparse-key implementations: spread the dense ids over the 64-bit key space.
+        target_op.a = sparse_key(source_op.a);
+        target_op.b = sparse_key(source_op.b);
+    }
     return target_op;
 }
 
+// Replaces every RANGE_UNION_OP [a, b] by the unions (i, i + 1), i in [min, max):
+// what implementations without unionRange() run, and the --expand-ranges baseline.
+std::vector<CanonicalOperation> expand_range_operations(const std::vector<CanonicalOperation>& ops)
+{
+    std::vector<CanonicalOperation> expanded;
+    expanded.reserve(ops.size());
+    for (const auto& op : ops)
+    {
+        if (op.type != CanonicalOperationType::RANGE_UNION_OP)
+        {
+            expanded.push_back(op);
+            continue;
+        }
+        for (int i = std::min(op.a, op.b); i < std::max(op.a, op.b); i++)
+        {
+            expanded.push_back(CanonicalOperation{CanonicalOperationType::UNION_OP, i, i + 1});
+        }
+    }
+    return expanded;
+}
+
 
 // --- Main Benchmark Function ---
 int main(int argc, char* argv[]) 
 {
     if (argc < 4) 
     {
-        std::cerr << "Usage: " << argv[0] << " <implementation_type> <operations_file> <num_runs> [num_threads]" << std::endl;
-        std::cerr << "  implementation_type: serial, coarse, fine, lockfree, lockfree_plain, lockfree_ipc" << std::endl;
+        std::cerr << "Usage: " << argv[0] << " <implementation_type> <operations_file> <num_runs> [num_threads] [options]" << std::endl;
+        std::cerr << "  implementation_type: serial, coarse, fine, lockfree, lockfree_plain, lockfree_ipc, relative, map" << std::endl;
         std::cerr << "  operations_file: Path to the file containing operations (Type: 0=UNION, 1=FIND, 2=SAMESET)." << std::endl;
         std::cerr << "  num_runs: Number of times to run processOperations for timing." << std::endl;
         std::cerr << "  num_threads (optional): Number of threads for parallel versions (default: max available)." << std::endl;
+        std::cerr << "Options:" << std::endl;
+        std::cerr << "  --root-hints: Lock-free only. Enable the thread-local root hint cache and report its hit rate." << std::endl;
+        std::cerr << "  --compact-idle-ms <ms>: Lock-free only. Run all unions, stay idle for <ms> with and without" << std::endl;
+        std::cerr << "                          the background compactor, then time the first query batch." << std::endl;
+        std::cerr << "  --wal <dir>: Repeat the timed runs with a write-ahead log in <dir> (files are overwritten)" << std::endl;
+        std::cerr << "               and report the overhead against the log-disabled runs." << std::endl;
+        std::cerr << "  --wal-interval-ms <ms>: Group commit interval for --wal (default: 5)." << std::endl;
+        std::cerr << "  --trace <file>: Lock-free only. Run one extra traced batch and write its per-thread timeline" << std::endl;
+        std::cerr << "                  to <file> as Chrome trace-event JSON (open in chrome://tracing or Perfetto)." << std::endl;
+        std::cerr << "  --profile-hot <k>: Lock-free only. Run one extra profiled batch and print the k hottest roots and" << std::endl;
+        std::cerr << "                     elements with their share of CAS failures (table, then JSON)." << std::endl;
+        std::cerr << "  --profile-json <file>: Write the --profile-hot JSON to <file> instead of stdout (k defaults to 10)." << std::endl;
+        std::cerr << "  --merge-events <ring>: Lock-free only. Repeat the timed runs emitting merge events into per-thread" << std::endl;
+        std::cerr << "                         rings of <ring> events, drained concurrently into a MergeIndex." << std::endl;
+        std::cerr << "  --top-k <k>: Lock-free only. Repeat the timed runs with a TopKTracker (10 ms refresh) attached, and" << std::endl;
+        std::cerr << "               compare topK() against a full scan of component sizes." << std::endl;
+        std::cerr << "  --expand-ranges: Run range unions (type 3) as one union per adjacent pair, as implementations" << std::endl;
+        std::cerr << "                   without unionRange() always do." << std::endl;
+        std::cerr << "  --dedup-queries: Run all unions, then time the trace's queries as one batch on the fresh forest," << std::endl;
+        std::cerr << "                   with and without QueryDeduplicator (each distinct query answered once)." << std::endl;
+        std::cerr << "  --stream-blocks <n>: Compressed traces only. Repeat the timed runs decoding <n> blocks at a time" << std::endl;
+        std::cerr << "                       and processing each window, and report decode against process throughput." << std::endl;
+        std::cerr << "  --record <file>: Repeat the timed runs through the single-operation API from all threads, without" << std::endl;
+        std::cerr << "                   and with a TraceRecorder writing <file> (replayable by this benchmark)." << std::endl;
+        std::cerr << "  --record-sample <k>: Record one call in k per thread for --record (default: 1)." << std::endl;
+        std::cerr << "  --record-max <ops>: Stop recording after <ops> operations for --record (default: no cap)." << std::endl;
+        std::cerr << "  --replicated <max_lag>: Repeat the timed runs in windows of 65536 operations, unions then queries," << std::endl;
+        std::cerr << "                          on the engine and on ReplicatedUnionFind (queries from per-node label copies" << std::endl;
+        std::cerr << "                          at most <max_lag> union windows stale); reports query throughput and staleness." << std::endl;
+        std::cerr << "  --replicas <r>: Read copies for --replicated (default: one per NUMA node)." << std::endl;
+        std::cerr << "  --transactions <g>: Repeat the timed runs through the single-operation API from all threads, with" << std::endl;
+        std::cerr << "                      plain unions and with each thread's unions committed <g> at a time by" << std::endl;
+        std::cerr << "                      TransactionalUnionFind (queries never see a commit half applied)." << std::endl;
         return 1;
     }
 
@@ -161,8 +288,9 @@ int main(int argc, char* argv[])
     std::string ops_file = argv[2];
     int num_runs = std::stoi(argv[3]);
     int num_threads = omp_get_max_threads(); // Default to max threads
+    bool threads_given = argc > 4 && std::string(argv[4]).rfind("--", 0) != 0;
 
-    if (argc > 4) 
+    if (threads_given) 
     {
         num_threads = std::stoi(argv[4]);
         if (num_threads <= 0) {
@@ -171,11 +299,117 @@ int main(int argc, char* argv[])
         }
     }
 
+    // --- Optional flags (after the positional arguments) ---
+    int compact_idle_ms = -1; // < 0: compaction experiment disabled
+    bool root_hints = false;
+    std::string wal_dir; // Empty: write-ahead log experiment disabled
+    int wal_interval_ms = 5;
+    std::string trace_file; // Empty: no timeline trace
+    int hot_k = 0;          // 0: hot-element profiling disabled
+    std::string hot_json_file;
+    int merge_ring = 0;     // 0: merge event stream disabled
+    int top_k = 0;          // 0: top-k tracker experiment disabled
+    bool expand_ranges = false;
+    bool dedup_queries = false;
+    int stream_blocks = 0;  // 0: streaming decode experiment disabled
+    std::string record_file; // Empty: trace recorder experiment disabled
+    TraceRecorder::Options record_options;
+    long long replicated_lag = -1; // < 0: replicated read copies experiment disabled
+    int replica_count = 0;
+    int txn_group = 0;      // 0: transactional commit experiment disabled
+    for (int arg_idx = threads_given ? 5 : 4; arg_idx < argc; arg_idx++) 
+    {
+        std::string flag = argv[arg_idx];
+        if (flag == "--compact-idle-ms" && arg_idx + 1 < argc) 
+        {
+            compact_idle_ms = std::stoi(argv[++arg_idx]);
+        } 
+        else if (flag == "--root-hints") 
+        {
+            root_hints = true;
+        } 
+        else if (flag == "--wal" && arg_idx + 1 < argc) 
+        {
+            wal_dir = argv[++arg_idx];
+        } 
+        else if (flag == "--wal-interval-ms" && arg_idx + 1 < argc) 
+        {
+            wal_interval_ms = std::stoi(argv[++arg_idx]);
+        } 
+        else if (flag == "--trace" && arg_idx + 1 < argc) 
+        {
+            trace_file = argv[++arg_idx];
+        } 
+        else if (flag == "--profile-hot" && arg_idx + 1 < argc) 
+        {
+            hot_k = std::stoi(argv[++arg_idx]);
+        } 
+        else if (flag == "--profile-json" && arg_idx + 1 < argc) 
+        {
+            hot_json_file = argv[++arg_idx];
+            hot_k = hot_k > 0 ? hot_k : 10;
+        } 
+        else if (flag == "--merge-events" && arg_idx + 1 < argc) 
+        {
+            merge_ring = std::stoi(argv[++arg_idx]);
+        } 
+        else if (flag == "--top-k" && arg_idx + 1 < argc) 
+        {
+            top_k = std::max(1, std::stoi(argv[++arg_idx]));
+        } 
+        else if (flag == "--expand-ranges") 
+        {
+            expand_ranges = true;
+        } 
+        else if (flag == "--dedup-queries") 
+        {
+            dedup_queries = true;
+        } 
+        else if (flag == "--stream-blocks" && arg_idx + 1 < argc) 
+        {
+            stream_blocks = std::stoi(argv[++arg_idx]);
+        } 
+        else if (flag == "--record" && arg_idx + 1 < argc) 
+        {
+            record_file = argv[++arg_idx];
+        } 
+        else if (flag == "--record-sample" && arg_idx + 1 < argc) 
+        {
+            record_options.sample_period = std::stoi(argv[++arg_idx]);
+        } 
+        else if (flag == "--record-max" && arg_idx + 1 < argc) 
+        {
+            record_options.max_ops = std::stoull(argv[++arg_idx]);
+        } 
+        else if (flag == "--replicated" && arg_idx + 1 < argc) 
+        {
+            replicated_lag = std::max(0LL, std::stoll(argv[++arg_idx]));
+        } 
+        else if (flag == "--replicas" && arg_idx + 1 < argc) 
+        {
+            replica_count = std::max(0, std::stoi(argv[++arg_idx]));
+        } 
+        else if (flag == "--transactions" && arg_idx + 1 < argc) 
+        {
+            txn_group = std::max(1, std::stoi(argv[++arg_idx]));
+        } 
+        else 
+        {
+            std::cerr << "Error: Unknown or incomplete option '" << flag << "'." << std::endl;
+            return 1;
+        }
+    }
+
     if (num_runs <= 0) 
     {
         std::cerr << "Error: Number of runs must be positive." << std::endl;
         return 1;
     }
+    if (stream_blocks > 0 && !CompressedTraceReader::isCompressedTrace(ops_file)) 
+    {
+        std::cerr << "Error: --stream-blocks needs a compressed trace (see trace_convert)." << std::endl;
+        return 1;
+    }
 
     // --- Load Operations ---
     int n_elements;
@@ -190,9 +424,24 @@ int main(int argc, char* argv[])
         std::cerr << "Error: No operations loaded." << std::endl;
         return 1;
     }
+    // Range unions: native for implementations with unionRange(), expanded otherwise
+    size_t range_ops = std::count_if(canonical_operations.begin(), canonical_operations.end(),
+                                     [](const CanonicalOperation& op) { return op.type == CanonicalOperationType::RANGE_UNION_OP; });
+    std::vector<CanonicalOperation> expanded_operations;
+    if (range_ops > 0) 
+    {
+        expanded_operations = expand_range_operations(canonical_operations);
+        std::cout << "Range unions: " << range_ops << " (" << expanded_operations.size() - (canonical_operations.size() - range_ops)
+                  << " pair unions when expanded)" << std::endl;
+        if (expand_ranges) 
+        {
+            canonical_operations = std::move(expanded_operations);
+            range_ops = 0; // Every implementation now runs the pair unions.
+        }
+    }
 
     // --- Configure OpenMP ---
-    if (impl_type != "serial") 
+    if (impl_type != "serial" && impl_type != "relative") 
     {
         omp_set_num_threads(num_threads);
         std::cout << "Using OpenMP with " << num_threads << " threads." << std::endl;
@@ -206,6 +455,83 @@ int main(int argc, char* argv[])
     std::vector<double> durations; // Store durations in milliseconds
     durations.reserve(num_runs);
     std::vector<int> results; // To store results from processOperations
+    std::vector<double> construct_durations; // Constructor time per timed run (ms)
+    construct_durations.reserve(num_runs);
+    // Latency of the first batch on a fresh instance, where lazily zeroed pages get faulted in
+    const size_t first_batch_ops = std::min<size_t>(canonical_operations.size(), 65536);
+    double first_batch_ms = 0.0;
+    // Compaction experiment: first query batch after the union phase, without/with the compactor
+    bool compact_ran = false;
+    double first_query_ms_plain = 0.0;
+    double first_query_ms_compacted = 0.0;
+    std::uint64_t compactor_sweeps = 0;
+    size_t first_query_ops = 0;
+    // Root hint cache counters summed over all threads, timed runs only
+    std::uint64_t hint_hits = 0;
+    std::uint64_t hint_misses = 0;
+    // Write-ahead log experiment: same runs through DurableUnionFind, including the final sync()
+    std::vector<double> wal_durations;
+    std::uint64_t wal_commits = 0;
+    std::uint64_t wal_records = 0;
+    // Timeline trace: one extra traced run on a fresh instance
+    bool trace_ran = false;
+    double traced_ms = 0.0;
+    size_t trace_events = 0;
+    std::uint64_t trace_dropped = 0;
+    // Hot-element profile: one extra profiled run on a fresh instance
+    bool hot_ran = false;
+    double profiled_ms = 0.0;
+    HotElementProfiler::Report hot_report{};
+    // Merge event stream: timed runs with emission on and a concurrent consumer
+    std::vector<double> merge_durations;
+    // Top-k tracker: timed runs with the tracker attached, then topK() against a full scan
+    std::vector<double> top_k_durations;
+    double top_k_query_us = 0.0;
+    double top_k_scan_ms = 0.0;
+    std::uint64_t top_k_rebuilds = 0;
+    std::uint64_t top_k_refreshes = 0;
+    std::uint64_t top_k_overflowed = 0;
+    bool top_k_matches = true;
+    std::uint64_t merge_events_drained = 0;
+    std::uint64_t merge_events_overflowed = 0;
+    bool merge_index_matches = true;
+    // Query deduplication: the query phase after all unions, plain and deduplicated
+    std::vector<double> query_plain_durations;
+    std::vector<double> query_dedup_durations;
+    size_t dedup_query_ops = 0;
+    size_t dedup_unique_ops = 0;
+    bool dedup_results_match = true;
+    // Streaming decode: timed runs decoding the compressed trace one window of blocks at a time
+    std::vector<double> stream_decode_durations;
+    std::vector<double> stream_process_durations;
+    size_t stream_windows = 0;
+    std::uint64_t stream_bytes = 0;
+    std::uint64_t stream_ops = 0;
+    // Trace recorder: single-operation API runs without and with recording
+    std::vector<double> single_op_durations;
+    std::vector<double> recorded_durations;
+    std::uint64_t recorded_ops = 0;
+    std::uint64_t recorded_dropped = 0;
+    // Replicated read copies: windowed runs, union and query phases timed separately
+    std::vector<double> window_union_durations;
+    std::vector<double> window_query_durations;
+    std::vector<double> replicated_union_durations; // Includes the replica refreshes
+    std::vector<double> replicated_query_durations;
+    size_t replicated_query_ops = 0;
+    std::uint64_t replicated_answers = 0;
+    std::uint64_t replicated_refreshes = 0;
+    std::uint64_t replicated_labels = 0;
+    std::uint64_t replicated_stale = 0;
+    int replicated_copies = 0;
+    // Transactional commits: single-operation API runs with plain and with grouped, committed unions
+    std::vector<double> txn_plain_durations;
+    std::vector<double> txn_durations;
+    std::uint64_t txn_commits = 0;
+    std::uint64_t txn_retries = 0;
+    bool txn_partition_matches = true;
+    // Structure statistics after the last timed run (introspect(), not timed)
+    bool stats_ran = false;
+    UnionFindStats final_stats;
 
     std::cout << "\nStarting benchmark..." << std::endl;
     std::cout << "Implementation: " << impl_type << std::endl;
@@ -223,9 +549,17 @@ int main(int argc, char* argv[])
         using SpecificOperation = typename SpecificUF::Operation; // Get the nested Operation type
 
         // --- Perform conversion once before warm-up and timed runs ---
+        const std::vector<CanonicalOperation>* source_operations = &canonical_operations;
+        if constexpr (!requires(SpecificUF& u) { u.unionRange(0, 0); })
+        {
+            if (range_ops > 0) 
+            {
+                source_operations = &expanded_operations; // No native range unions.
+            }
+        }
         std::vector<SpecificOperation> specific_operations;
-        specific_operations.reserve(canonical_operations.size());
-        std::transform(canonical_operations.begin(), canonical_operations.end(),
+        specific_operations.reserve(source_operations->size());
+        std::transform(source_operations->begin(), source_operations->end(),
                        std::back_inserter(specific_operations),
                        convert_operation<SpecificOperation, CanonicalOperation>);
         // --- Conversion complete ---
@@ -240,11 +574,35 @@ int main(int argc, char* argv[])
             std::cout << "Warm-up complete." << std::endl;
         }
 
+        // First-batch latency on a fresh instance
+        {
+            std::vector<SpecificOperation> first_batch(specific_operations.begin(),
+                                                       specific_operations.begin() + std::min(first_batch_ops, specific_operations.size()));
+            auto fresh_uf = std::make_unique<SpecificUF>(n_elements);
+            auto start_time = std::chrono::high_resolution_clock::now();
+            fresh_uf->processOperations(first_batch, results);
+            auto end_time = std::chrono::high_resolution_clock::now();
+            first_batch_ms = std::chrono::duration<double, std::milli>(end_time - start_time).count();
+        }
+
         // Timed runs
         for (int i = 0; i < num_runs; ++i) 
         {
-            // Create a fresh instance for each run
+            // Create a fresh instance for each run (construction timed separately)
+            auto construct_start = std::chrono::high_resolution_clock::now();
             auto current_uf = std::make_unique<SpecificUF>(n_elements);
+            auto construct_end = std::chrono::high_resolution_clock::now();
+            construct_durations.push_back(std::chrono::duration<double, std::milli>(construct_end - construct_start).count());
+
+            if constexpr (requires { current_uf->setRootHints(true); })
+            {
+                if (root_hints) 
+                {
+                    current_uf->setRootHints(true);
+                    #pragma omp parallel
+                    RootHintCache::local().resetStats();
+                }
+            }
 
             // --- Timing starts HERE ---
             auto start_time = std::chrono::high_resolution_clock::now();
@@ -257,6 +615,15 @@ int main(int argc, char* argv[])
 
             std::chrono::duration<double, std::milli> duration_ms = end_time - start_time;
             durations.push_back(duration_ms.count());
+
+            if (root_hints) 
+            {
+                #pragma omp parallel reduction(+ : hint_hits, hint_misses)
+                {
+                    hint_hits += RootHintCache::local().hits;
+                    hint_misses += RootHintCache::local().misses;
+                }
+            }
             std::cout << "Run " << (i + 1) << ": " << duration_ms.count() << " ms" << std::endl;
 
             // Optional: Add basic validation check on results size after first run
@@ -266,6 +633,535 @@ int main(int argc, char* argv[])
                            << ") does not match operations vector size (" << specific_operations.size()
                            << ") after first run." << std::endl;
             }
+
+            // Forest shape after the run (outside the timed region)
+            if constexpr (requires { current_uf->introspect(); })
+            {
+                UnionFindStats stats = current_uf->introspect();
+                std::cout << "  Structure: ";
+                stats.printSummary(std::cout);
+                if (i == num_runs - 1)
+                {
+                    final_stats = std::move(stats);
+                    stats_ran = true;
+                }
+            }
+
+            // Relative-parent engine: report how many parents spilled to the overflow table.
+            if constexpr (requires { current_uf->overflowCount(); })
+            {
+                if (i == num_runs - 1)
+                {
+                    std::cout << "Overflow entries: " << current_uf->overflowCount() << " of " << n_elements << std::endl;
+                }
+            }
+        }
+
+        // Background compaction experiment (engines exposing compactRange/isBusy only)
+        if constexpr (requires(SpecificUF& u) { u.compactRange(0, 0); u.isBusy(); })
+        {
+            if (compact_idle_ms >= 0) 
+            {
+                std::vector<SpecificOperation> union_ops;
+                std::vector<SpecificOperation> query_ops;
+                for (const auto& op : specific_operations) 
+                {
+                    // Range unions keep their canonical value (3) after convert_operation().
+                    if (op.type == SpecificUF::OperationType::UNION_OP ||
+                        op.type == static_cast<typename SpecificUF::OperationType>(CanonicalOperationType::RANGE_UNION_OP)) 
+                    {
+                        union_ops.push_back(op);
+                    } 
+                    else if (query_ops.size() < first_batch_ops) 
+                    {
+                        query_ops.push_back(op);
+                    }
+                }
+                first_query_ops = query_ops.size();
+
+                auto first_query_after_unions = [&](bool use_compactor) 
+                {
+                    auto uf = std::make_unique<SpecificUF>(n_elements);
+                    uf->processOperations(union_ops, results);
+                    {
+                        BackgroundCompactor<SpecificUF> compactor(*uf);
+                        if (use_compactor) 
+                        {
+                            compactor.start();
+                        }
+                        std::this_thread::sleep_for(std::chrono::milliseconds(compact_idle_ms));
+                        compactor.stop();
+                        if (use_compactor) 
+                        {
+                            compactor_sweeps = compactor.sweepsCompleted();
+                        }
+                    }
+                    auto start_time = std::chrono::high_resolution_clock::now();
+                    uf->processOperations(query_ops, results);
+                    auto end_time = std::chrono::high_resolution_clock::now();
+                    return std::chrono::duration<double, std::milli>(end_time - start_time).count();
+                };
+
+                std::cout << "Running compaction experiment (idle " << compact_idle_ms << " ms)..." << std::endl;
+                first_query_ms_plain = first_query_after_unions(false);
+                first_query_ms_compacted = first_query_after_unions(true);
+                compact_ran = true;
+            }
+        }
+
+        // Timeline trace (engines exposing setTimeline only)
+        if constexpr (requires(SpecificUF& u) { u.setTimeline(nullptr); })
+        {
+            if (!trace_file.empty()) 
+            {
+                TimelineTrace trace;
+                auto uf = std::make_unique<SpecificUF>(n_elements);
+                uf->setTimeline(&trace);
+                auto start_time = std::chrono::high_resolution_clock::now();
+                uf->processOperations(specific_operations, results);
+                auto end_time = std::chrono::high_resolution_clock::now();
+                traced_ms = std::chrono::duration<double, std::milli>(end_time - start_time).count();
+                trace_events = trace.eventCount();
+                trace_dropped = trace.droppedCount();
+                if (!trace.writeChromeTrace(trace_file)) 
+                {
+                    throw std::runtime_error("Cannot write trace file " + trace_file);
+                }
+                trace_ran = true;
+            }
+        }
+
+        // Hot-element profile (engines exposing setProfiler only)
+        if constexpr (requires(SpecificUF& u) { u.setProfiler(nullptr); })
+        {
+            if (hot_k > 0) 
+            {
+                HotElementProfiler profiler;
+                auto uf = std::make_unique<SpecificUF>(n_elements);
+                uf->setProfiler(&profiler);
+                auto start_time = std::chrono::high_resolution_clock::now();
+                uf->processOperations(specific_operations, results);
+                auto end_time = std::chrono::high_resolution_clock::now();
+                profiled_ms = std::chrono::duration<double, std::milli>(end_time - start_time).count();
+                hot_report = profiler.report(static_cast<size_t>(hot_k));
+                hot_ran = true;
+            }
+        }
+
+        // Merge event stream (engines exposing setMergeEvents only)
+        if constexpr (requires(SpecificUF& u) { u.setMergeEvents(nullptr); })
+        {
+            if (merge_ring > 0) 
+            {
+                std::cout << "Running merge event runs (" << merge_ring << " events per ring)..." << std::endl;
+                for (int i = 0; i < num_runs; ++i) 
+                {
+                    MergeEventStream stream(static_cast<size_t>(merge_ring));
+                    MergeIndex index(n_elements);
+                    auto uf = std::make_unique<SpecificUF>(n_elements);
+                    uf->setMergeEvents(&stream);
+
+                    std::atomic<bool> done{false};
+                    std::thread consumer([&]() 
+                    {
+                        while (!done.load(std::memory_order_acquire)) 
+                        {
+                            if (index.update(stream) == 0) 
+                            {
+                                std::this_thread::yield();
+                            }
+                        }
+                    });
+
+                    auto start_time = std::chrono::high_resolution_clock::now();
+                    uf->processOperations(specific_operations, results);
+                    auto end_time = std::chrono::high_resolution_clock::now();
+                    done.store(true, std::memory_order_release);
+                    consumer.join();
+                    index.update(stream); // Events published after the consumer's last pass
+
+                    merge_durations.push_back(std::chrono::duration<double, std::milli>(end_time - start_time).count());
+                    merge_events_drained = stream.drainedCount();
+                    merge_events_overflowed = stream.overflowCount();
+                    merge_index_matches = merge_index_matches && index.components() == uf->introspect().components;
+                    std::cout << "Merge Event Run " << (i + 1) << ": " << merge_durations.back() << " ms" << std::endl;
+                }
+            }
+        }
+
+        // Top-k tracker (engines exposing setMergeEvents only)
+        if constexpr (requires(SpecificUF& u) { u.setMergeEvents(nullptr); })
+        {
+            if (top_k > 0) 
+            {
+                std::cout << "Running top-k tracker runs (k = " << top_k << ")..." << std::endl;
+                for (int i = 0; i < num_runs; ++i) 
+                {
+                    auto uf = std::make_unique<SpecificUF>(n_elements);
+                    TopKTracker tracker(n_elements, static_cast<size_t>(top_k));
+                    uf->setMergeEvents(&tracker.stream());
+
+                    auto start_time = std::chrono::high_resolution_clock::now();
+                    uf->processOperations(specific_operations, results);
+                    auto end_time = std::chrono::high_resolution_clock::now();
+                    top_k_durations.push_back(std::chrono::duration<double, std::milli>(end_time - start_time).count());
+                    tracker.refresh(); // Not timed: the events still pending after the batch
+
+                    // What a dashboard pays per query: the snapshot, or a full scan
+                    start_time = std::chrono::high_resolution_clock::now();
+                    std::vector<ComponentSize> top = tracker.topK();
+                    end_time = std::chrono::high_resolution_clock::now();
+                    top_k_query_us = std::chrono::duration<double, std::micro>(end_time - start_time).count();
+                    start_time = std::chrono::high_resolution_clock::now();
+                    std::vector<int> counts(n_elements, 0);
+                    for (int e = 0; e < n_elements; e++) 
+                    {
+                        counts[uf->find(e)]++;
+                    }
+                    size_t keep = std::min<size_t>(top_k, counts.size());
+                    std::partial_sort(counts.begin(), counts.begin() + keep, counts.end(), std::greater<int>());
+                    end_time = std::chrono::high_resolution_clock::now();
+                    top_k_scan_ms = std::chrono::duration<double, std::milli>(end_time - start_time).count();
+
+                    for (size_t t = 0; t < keep; t++) 
+                    {
+                        int expected = counts[t] > 1 ? counts[t] : 0; // Singletons are not listed
+                        top_k_matches = top_k_matches && (t < top.size() ? top[t].size : 0) == expected;
+                    }
+                    top_k_rebuilds = tracker.rebuildCount();
+                    top_k_refreshes = tracker.refreshCount();
+                    top_k_overflowed = tracker.stream().overflowCount();
+                    std::cout << "Top-k Run " << (i + 1) << ": " << top_k_durations.back() << " ms" << std::endl;
+                }
+            }
+        }
+
+        // Query deduplication experiment (dense element ids only)
+        if constexpr (std::is_same_v<decltype(SpecificOperation::a), int>)
+        {
+            if (dedup_queries) 
+            {
+                std::vector<SpecificOperation> union_ops;
+                std::vector<SpecificOperation> query_ops;
+                for (const auto& op : specific_operations) 
+                {
+                    if (op.type == SpecificUF::OperationType::FIND_OP || op.type == SpecificUF::OperationType::SAMESET_OP) 
+                    {
+                        query_ops.push_back(op);
+                    } 
+                    else 
+                    {
+                        union_ops.push_back(op);
+                    }
+                }
+                dedup_query_ops = query_ops.size();
+
+                std::cout << "Running query deduplication runs (" << query_ops.size() << " queries after "
+                          << union_ops.size() << " unions)..." << std::endl;
+                std::vector<int> expected;
+                for (int i = 0; i < num_runs; ++i) 
+                {
+                    // Each side queries a fresh forest built by the same unions (not timed).
+                    auto uf_plain = std::make_unique<SpecificUF>(n_elements);
+                    uf_plain->processOperations(union_ops, results);
+                    auto start_time = std::chrono::high_resolution_clock::now();
+                    uf_plain->processOperations(query_ops, expected);
+                    auto end_time = std::chrono::high_resolution_clock::now();
+                    query_plain_durations.push_back(std::chrono::duration<double, std::milli>(end_time - start_time).count());
+                    uf_plain.reset();
+
+                    auto uf_dedup = std::make_unique<SpecificUF>(n_elements);
+                    uf_dedup->processOperations(union_ops, results);
+                    QueryDeduplicator<SpecificUF> dedup(*uf_dedup);
+                    dedup.reserve(query_ops.size()); // Buffers are reused across batches in practice.
+                    start_time = std::chrono::high_resolution_clock::now();
+                    dedup.processOperations(query_ops, results);
+                    end_time = std::chrono::high_resolution_clock::now();
+                    query_dedup_durations.push_back(std::chrono::duration<double, std::milli>(end_time - start_time).count());
+                    dedup_unique_ops = dedup.lastUniqueQueries();
+                    dedup_results_match = dedup_results_match && results == expected;
+                    std::cout << "Query Run " << (i + 1) << ": " << query_plain_durations.back() << " ms plain / "
+                              << query_dedup_durations.back() << " ms deduplicated" << std::endl;
+                }
+            }
+        }
+
+        // Streaming decode experiment: decode a window of blocks, process it, repeat
+        if (stream_blocks > 0) 
+        {
+            CompressedTraceReader reader(ops_file);
+            stream_bytes = reader.fileBytes();
+            stream_ops = reader.operations();
+            std::cout << "Running streaming decode runs (" << stream_blocks << " of " << reader.blocks() << " blocks per window)..." << std::endl;
+            std::vector<CanonicalOperation> window;
+            std::vector<SpecificOperation> window_operations;
+            for (int i = 0; i < num_runs; ++i) 
+            {
+                auto uf = std::make_unique<SpecificUF>(n_elements);
+                double decode_ms = 0.0;
+                double process_ms = 0.0;
+                stream_windows = 0;
+                for (size_t first = 0; first < reader.blocks(); first += static_cast<size_t>(stream_blocks)) 
+                {
+                    auto start_time = std::chrono::high_resolution_clock::now();
+                    reader.readBlocks(first, std::min<size_t>(stream_blocks, reader.blocks() - first), window);
+                    auto end_time = std::chrono::high_resolution_clock::now();
+                    decode_ms += std::chrono::duration<double, std::milli>(end_time - start_time).count();
+
+                    // Same operation stream as the timed runs (not timed)
+                    bool expand = expand_ranges;
+                    if constexpr (!requires(SpecificUF& u) { u.unionRange(0, 0); })
+                    {
+                        expand = true;
+                    }
+                    if (expand) 
+                    {
+                        window = expand_range_operations(window);
+                    }
+                    window_operations.resize(window.size());
+                    std::transform(window.begin(), window.end(), window_operations.begin(),
+                                   convert_operation<SpecificOperation, CanonicalOperation>);
+
+                    start_time = std::chrono::high_resolution_clock::now();
+                    uf->processOperations(window_operations, results);
+                    end_time = std::chrono::high_resolution_clock::now();
+                    process_ms += std::chrono::duration<double, std::milli>(end_time - start_time).count();
+                    stream_windows++;
+                }
+                stream_decode_durations.push_back(decode_ms);
+                stream_process_durations.push_back(process_ms);
+                std::cout << "Stream Run " << (i + 1) << ": " << decode_ms << " ms decode / " << process_ms << " ms process" << std::endl;
+            }
+        }
+
+        // Trace recorder experiment (dense element ids only): every thread calls the
+        // single-operation API on its share of the trace, as a service's request threads would.
+        if constexpr (std::is_same_v<decltype(SpecificOperation::a), int>)
+        {
+            if (!record_file.empty()) 
+            {
+                auto single_op_run = [&](TraceRecorder* recorder) 
+                {
+                    auto uf = std::make_unique<RecordedUnionFind<SpecificUF>>(n_elements);
+                    uf->setRecorder(recorder);
+                    auto start_time = std::chrono::high_resolution_clock::now();
+                    #pragma omp parallel for schedule(static)
+                    for (size_t k = 0; k < specific_operations.size(); k++) 
+                    {
+                        const SpecificOperation& op = specific_operations[k];
+                        switch (op.type) 
+                        {
+                            case SpecificUF::OperationType::UNION_OP: uf->unionSets(op.a, op.b); break;
+                            case SpecificUF::OperationType::FIND_OP: uf->find(op.a); break;
+                            case SpecificUF::OperationType::SAMESET_OP: uf->sameSet(op.a, op.b); break;
+                            default:
+                                if constexpr (requires { uf->unionRange(0, 0); })
+                                {
+                                    uf->unionRange(op.a, op.b); // Only engines with unionRange() see type 3.
+                                }
+                                break;
+                        }
+                    }
+                    auto end_time = std::chrono::high_resolution_clock::now();
+                    return std::chrono::duration<double, std::milli>(end_time - start_time).count();
+                };
+
+                std::cout << "Running trace recorder runs (" << record_file << ", 1 in " << record_options.sample_period << " calls)..." << std::endl;
+                for (int i = 0; i < num_runs; ++i) 
+                {
+                    // Alternate which side runs first, so allocator and page cache effects cancel out.
+                    if (i % 2 == 0) 
+                    {
+                        single_op_durations.push_back(single_op_run(nullptr));
+                    }
+                    TraceRecorder recorder(record_file, n_elements, record_options);
+                    recorded_durations.push_back(single_op_run(&recorder));
+                    recorder.stop(); // Not timed: the last flush and closing the file
+                    if (i % 2 == 1) 
+                    {
+                        single_op_durations.push_back(single_op_run(nullptr));
+                    }
+                    recorded_ops = recorder.recordedCount();
+                    recorded_dropped = recorder.droppedCount();
+                    std::cout << "Single-Op Run " << (i + 1) << ": " << single_op_durations.back() << " ms plain / "
+                              << recorded_durations.back() << " ms recorded" << std::endl;
+                }
+            }
+        }
+
+        // Transactional commit experiment (dense element ids only): every thread runs its
+        // share of the trace through the single-operation API, once with immediate unions
+        // on the engine and once staging its unions and committing them <g> at a time.
+        if constexpr (std::is_same_v<decltype(SpecificOperation::a), int>)
+        {
+            if (txn_group > 0) 
+            {
+                std::cout << "Running transactional commit runs (" << txn_group << " unions per transaction)..." << std::endl;
+                for (int i = 0; i < num_runs; ++i) 
+                {
+                    auto plain = std::make_unique<SpecificUF>(n_elements);
+                    auto start_time = std::chrono::high_resolution_clock::now();
+                    #pragma omp parallel for schedule(static)
+                    for (size_t k = 0; k < specific_operations.size(); k++) 
+                    {
+                        const SpecificOperation& op = specific_operations[k];
+                        switch (op.type) 
+                        {
+                            case SpecificUF::OperationType::UNION_OP: plain->unionSets(op.a, op.b); break;
+                            case SpecificUF::OperationType::FIND_OP: plain->find(op.a); break;
+                            case SpecificUF::OperationType::SAMESET_OP: plain->sameSet(op.a, op.b); break;
+                            default: break; // Range unions are not part of this comparison.
+                        }
+                    }
+                    auto end_time = std::chrono::high_resolution_clock::now();
+                    txn_plain_durations.push_back(std::chrono::duration<double, std::milli>(end_time - start_time).count());
+
+                    using Txn = TransactionalUnionFind<SpecificUF>;
+                    auto txn = std::make_unique<Txn>(n_elements);
+                    start_time = std::chrono::high_resolution_clock::now();
+                    #pragma omp parallel
+                    {
+                        typename Txn::Transaction tx;
+                        #pragma omp for schedule(static)
+                        for (size_t k = 0; k < specific_operations.size(); k++) 
+                        {
+                            const SpecificOperation& op = specific_operations[k];
+                            switch (op.type) 
+                            {
+                                case SpecificUF::OperationType::UNION_OP:
+                                    tx.unionSets(op.a, op.b);
+                                    if (tx.size() == static_cast<size_t>(txn_group)) 
+                                    {
+                                        txn->commit(tx);
+                                    }
+                                    break;
+                                case SpecificUF::OperationType::FIND_OP: txn->find(op.a); break;
+                                case SpecificUF::OperationType::SAMESET_OP: txn->sameSet(op.a, op.b); break;
+                                default: break;
+                            }
+                        }
+                        txn->commit(tx);
+                    }
+                    end_time = std::chrono::high_resolution_clock::now();
+                    txn_durations.push_back(std::chrono::duration<double, std::milli>(end_time - start_time).count());
+                    txn_commits = txn->commitCount();
+                    txn_retries = txn->readerRetries();
+                    if constexpr (requires { plain->introspect(); })
+                    {
+                        txn_partition_matches = txn_partition_matches &&
+                                                txn->engine().introspect().components == plain->introspect().components;
+                    }
+                    std::cout << "Transaction Run " << (i + 1) << ": " << txn_plain_durations.back() << " ms plain / "
+                              << txn_durations.back() << " ms transactional" << std::endl;
+                }
+            }
+        }
+
+        // Replicated read copies experiment (dense element ids only): the trace in
+        // windows, each window's unions as one batch and then its queries as another,
+        // on the engine and through ReplicatedUnionFind.
+        if constexpr (std::is_same_v<decltype(SpecificOperation::a), int>)
+        {
+            if (replicated_lag >= 0) 
+            {
+                const size_t window_ops = 65536;
+                std::vector<std::vector<SpecificOperation>> window_unions;
+                std::vector<std::vector<SpecificOperation>> window_queries;
+                replicated_query_ops = 0;
+                for (size_t first = 0; first < specific_operations.size(); first += window_ops) 
+                {
+                    window_unions.emplace_back();
+                    window_queries.emplace_back();
+                    for (size_t k = first; k < std::min(first + window_ops, specific_operations.size()); k++) 
+                    {
+                        const SpecificOperation& op = specific_operations[k];
+                        bool query = op.type == SpecificUF::OperationType::FIND_OP || op.type == SpecificUF::OperationType::SAMESET_OP;
+                        (query ? window_queries : window_unions).back().push_back(op);
+                        replicated_query_ops += query ? 1 : 0;
+                    }
+                }
+
+                std::cout << "Running replicated read copy runs (" << window_unions.size() << " windows, max lag "
+                          << replicated_lag << ")..." << std::endl;
+                std::vector<int> expected;
+                for (int i = 0; i < num_runs; ++i) 
+                {
+                    double union_ms = 0.0;
+                    double query_ms = 0.0;
+                    auto uf = std::make_unique<SpecificUF>(n_elements);
+                    for (size_t w = 0; w < window_unions.size(); w++) 
+                    {
+                        auto start_time = std::chrono::high_resolution_clock::now();
+                        uf->processOperations(window_unions[w], results);
+                        auto mid_time = std::chrono::high_resolution_clock::now();
+                        uf->processOperations(window_queries[w], results);
+                        auto end_time = std::chrono::high_resolution_clock::now();
+                        union_ms += std::chrono::duration<double, std::milli>(mid_time - start_time).count();
+                        query_ms += std::chrono::duration<double, std::milli>(end_time - mid_time).count();
+                    }
+                    window_union_durations.push_back(union_ms);
+                    window_query_durations.push_back(query_ms);
+                    uf.reset();
+
+                    union_ms = 0.0;
+                    query_ms = 0.0;
+                    replicated_stale = 0;
+                    auto replicated = std::make_unique<ReplicatedUnionFind<SpecificUF>>(n_elements, replica_count,
+                                                                                         static_cast<std::uint64_t>(replicated_lag));
+                    for (size_t w = 0; w < window_unions.size(); w++) 
+                    {
+                        auto start_time = std::chrono::high_resolution_clock::now();
+                        replicated->processOperations(window_unions[w], results);
+                        auto mid_time = std::chrono::high_resolution_clock::now();
+                        replicated->processOperations(window_queries[w], results);
+                        auto end_time = std::chrono::high_resolution_clock::now();
+                        union_ms += std::chrono::duration<double, std::milli>(mid_time - start_time).count();
+                        query_ms += std::chrono::duration<double, std::milli>(end_time - mid_time).count();
+
+                        // Staleness (not timed): answers that differ from the primary's right now
+                        replicated->engine().processOperations(window_queries[w], expected);
+                        for (size_t k = 0; k < expected.size(); k++) 
+                        {
+                            replicated_stale += results[k] != expected[k] ? 1 : 0;
+                        }
+                    }
+                    replicated_union_durations.push_back(union_ms);
+                    replicated_query_durations.push_back(query_ms);
+                    replicated_answers = replicated->replicaAnswers();
+                    replicated_refreshes = replicated->refreshCount();
+                    replicated_labels = replicated->labelsUpdated();
+                    replicated_copies = replicated->replicaCount();
+                    std::cout << "Replicated Run " << (i + 1) << ": " << window_query_durations.back() << " ms queries / "
+                              << query_ms << " ms replicated queries, " << window_union_durations.back() << " ms unions / "
+                              << union_ms << " ms replicated unions + refresh" << std::endl;
+                }
+            }
+        }
+
+        // Write-ahead log experiment (dense element ids only)
+        if constexpr (std::is_same_v<decltype(SpecificOperation::a), int>)
+        {
+            if (!wal_dir.empty()) 
+            {
+                std::cout << "Running write-ahead log runs (" << wal_dir << ", commit every " << wal_interval_ms << " ms)..." << std::endl;
+                for (int i = 0; i < num_runs; ++i) 
+                {
+                    // Start from an empty log so construction does not replay the previous run.
+                    std::filesystem::remove(wal_dir + "/wal");
+                    std::filesystem::remove(wal_dir + "/snapshot");
+                    DurableUnionFind<SpecificUF> durable(n_elements, wal_dir, std::chrono::milliseconds(wal_interval_ms));
+
+                    auto start_time = std::chrono::high_resolution_clock::now();
+                    durable.processOperations(specific_operations, results);
+                    durable.sync(); // Count the time until every union is on stable storage
+                    auto end_time = std::chrono::high_resolution_clock::now();
+
+                    wal_durations.push_back(std::chrono::duration<double, std::milli>(end_time - start_time).count());
+                    wal_commits = durable.commitCount();
+                    wal_records = durable.recordsLogged();
+                    std::cout << "WAL Run " << (i + 1) << ": " << wal_durations.back() << " ms" << std::endl;
+                }
+            }
         }
     };
 
@@ -298,6 +1194,14 @@ int main(int argc, char* argv[])
             run_benchmark(uf_proto);
         }
         #endif
+        #ifdef UNIONFIND_LOCKFREE_ENABLED
+        else if (impl_type == "map") 
+        {
+            // Lock-free engine behind the concurrent 64-bit key -> dense index table
+            DisjointSetMap<std::uint64_t> uf_proto(n_elements);
+            run_benchmark(uf_proto);
+        }
+        #endif
         #ifdef UNIONFIND_LOCKFREE_PLAIN_ENABLED // New implementation
         else if (impl_type == "lockfree_plain") 
         {
@@ -312,6 +1216,13 @@ int main(int argc, char* argv[])
             run_benchmark(uf_proto);
         }
         #endif
+        #ifdef UNIONFIND_RELATIVE_ENABLED
+        else if (impl_type == "relative") 
+        {
+            UnionFindRelative uf_proto(n_elements);
+            run_benchmark(uf_proto);
+        }
+        #endif
         else 
         {
             std::cerr << "Error: Unknown implementation type '" << impl_type << "'." << std::endl;
@@ -323,7 +1234,7 @@ int main(int argc, char* argv[])
             std::cerr << ", fine";
             #endif
             #ifdef UNIONFIND_LOCKFREE_ENABLED
-            std::cerr << ", lockfree";
+            std::cerr << ", lockfree, map";
             #endif
             #ifdef UNIONFIND_LOCKFREE_PLAIN_ENABLED // New implementation
             std::cerr << ", lockfree_plain";
@@ -331,6 +1242,9 @@ int main(int argc, char* argv[])
             #ifdef UNIONFIND_LOCKFREE_IPC_ENABLED // New implementation
             std::cerr << ", lockfree_ipc";
             #endif
+            #ifdef UNIONFIND_RELATIVE_ENABLED
+            std::cerr << ", relative";
+            #endif
             std::cerr << std::endl;
             return 1;
         }
@@ -377,8 +1291,128 @@ int main(int argc, char* argv[])
     std::cout << "Min Time:       " << min_duration << " ms" << std::endl;
     std::cout << "Max Time:       " << max_duration << " ms" << std::endl;
     std::cout << "Std Dev:        " << std_dev << " ms" << std::endl;
+    std::cout << "Avg Construct:  " << std::accumulate(construct_durations.begin(), construct_durations.end(), 0.0) / construct_durations.size() << " ms" << std::endl;
+    std::cout << "First Batch:    " << first_batch_ms << " ms (" << first_batch_ops << " ops, fresh instance)" << std::endl;
+    if (root_hints && hint_hits + hint_misses > 0) 
+    {
+        std::cout << "Root Hint Hits: " << (100.0 * hint_hits / (hint_hits + hint_misses)) << " % ("
+                  << hint_hits << " hits / " << hint_misses << " misses)" << std::endl;
+    }
+    if (compact_ran) 
+    {
+        std::cout << "First Queries:  " << first_query_ms_plain << " ms idle / " << first_query_ms_compacted
+                  << " ms compacted (" << first_query_ops << " ops after union phase, " << compactor_sweeps << " sweeps)" << std::endl;
+    }
+    if (trace_ran) 
+    {
+        std::cout << "Traced Run:     " << traced_ms << " ms (" << trace_events << " events, " << trace_dropped
+                  << " dropped) -> " << trace_file << std::endl;
+    }
+    if (hot_ran) 
+    {
+        std::cout << "Profiled Run:   " << profiled_ms << " ms" << std::endl;
+    }
+    if (!merge_durations.empty()) 
+    {
+        double avg_merge = std::accumulate(merge_durations.begin(), merge_durations.end(), 0.0) / merge_durations.size();
+        std::cout << "Avg Time (CDC): " << avg_merge << " ms (" << (100.0 * (avg_merge - avg_duration) / avg_duration)
+                  << " % overhead, " << merge_events_drained << " events, " << merge_events_overflowed
+                  << " overflowed in last run, index " << (merge_index_matches ? "matches" : "DIFFERS") << ")" << std::endl;
+    }
+    if (!top_k_durations.empty()) 
+    {
+        double avg_top_k = std::accumulate(top_k_durations.begin(), top_k_durations.end(), 0.0) / top_k_durations.size();
+        std::cout << "Avg Time (TopK): " << avg_top_k << " ms (" << (100.0 * (avg_top_k - avg_duration) / avg_duration)
+                  << " % overhead, " << top_k_refreshes << " refreshes, " << top_k_rebuilds << " rebuilds, " << top_k_overflowed
+                  << " events overflowed in last run; topK() "
+                  << top_k_query_us << " us vs full scan " << top_k_scan_ms << " ms, " << (top_k_matches ? "matches" : "DIFFERS")
+                  << ")" << std::endl;
+    }
+    if (!wal_durations.empty()) 
+    {
+        double avg_wal = std::accumulate(wal_durations.begin(), wal_durations.end(), 0.0) / wal_durations.size();
+        std::cout << "Avg Time (WAL): " << avg_wal << " ms (" << (100.0 * (avg_wal - avg_duration) / avg_duration)
+                  << " % overhead, " << wal_records << " records, " << wal_commits << " commits in last run)" << std::endl;
+    }
+    if (!query_dedup_durations.empty()) 
+    {
+        double avg_plain = std::accumulate(query_plain_durations.begin(), query_plain_durations.end(), 0.0) / query_plain_durations.size();
+        double avg_dedup = std::accumulate(query_dedup_durations.begin(), query_dedup_durations.end(), 0.0) / query_dedup_durations.size();
+        double duplicate_pct = dedup_query_ops == 0 ? 0.0 : 100.0 * (dedup_query_ops - dedup_unique_ops) / dedup_query_ops;
+        std::cout << "Avg Queries:    " << avg_plain << " ms plain / " << avg_dedup << " ms deduplicated ("
+                  << avg_plain / avg_dedup << "x, " << dedup_unique_ops << " of " << dedup_query_ops << " distinct, "
+                  << duplicate_pct << " % duplicates, results " << (dedup_results_match ? "identical" : "DIFFER") << ")" << std::endl;
+    }
+    if (!stream_decode_durations.empty()) 
+    {
+        double avg_decode = std::accumulate(stream_decode_durations.begin(), stream_decode_durations.end(), 0.0) / stream_decode_durations.size();
+        double avg_process = std::accumulate(stream_process_durations.begin(), stream_process_durations.end(), 0.0) / stream_process_durations.size();
+        std::cout << "Avg Stream:     " << avg_decode << " ms decode / " << avg_process << " ms process ("
+                  << stream_ops / avg_decode / 1000.0 << " / " << stream_ops / avg_process / 1000.0 << " Mops/s of trace, "
+                  << static_cast<double>(stream_bytes) / stream_ops << " bytes/op, "
+                  << stream_windows << " windows)" << std::endl;
+    }
+    if (!recorded_durations.empty()) 
+    {
+        double avg_plain = std::accumulate(single_op_durations.begin(), single_op_durations.end(), 0.0) / single_op_durations.size();
+        double avg_recorded = std::accumulate(recorded_durations.begin(), recorded_durations.end(), 0.0) / recorded_durations.size();
+        std::cout << "Avg Single-Op:  " << avg_plain << " ms plain / " << avg_recorded << " ms recorded ("
+                  << (100.0 * (avg_recorded - avg_plain) / avg_plain) << " % overhead, " << recorded_ops << " recorded, "
+                  << recorded_dropped << " dropped in last run) -> " << record_file << std::endl;
+    }
+    if (!replicated_query_durations.empty()) 
+    {
+        double avg_query = std::accumulate(window_query_durations.begin(), window_query_durations.end(), 0.0) / window_query_durations.size();
+        double avg_replicated = std::accumulate(replicated_query_durations.begin(), replicated_query_durations.end(), 0.0) / replicated_query_durations.size();
+        double avg_union = std::accumulate(window_union_durations.begin(), window_union_durations.end(), 0.0) / window_union_durations.size();
+        double avg_refresh = std::accumulate(replicated_union_durations.begin(), replicated_union_durations.end(), 0.0) / replicated_union_durations.size();
+        double queries = static_cast<double>(std::max<size_t>(replicated_query_ops, 1));
+        std::cout << "Avg Replicated: " << avg_query << " ms / " << avg_replicated << " ms queries ("
+                  << replicated_query_ops / avg_query / 1000.0 << " / " << replicated_query_ops / avg_replicated / 1000.0
+                  << " Mops/s, " << 100.0 * replicated_answers / queries << " % from " << replicated_copies << " replica(s), "
+                  << 100.0 * replicated_stale / queries << " % stale), " << avg_union << " ms / " << avg_refresh
+                  << " ms unions + refresh (" << replicated_refreshes << " refreshes, " << replicated_labels
+                  << " labels rewritten in last run)" << std::endl;
+    }
+    if (!txn_durations.empty()) 
+    {
+        double avg_plain = std::accumulate(txn_plain_durations.begin(), txn_plain_durations.end(), 0.0) / txn_plain_durations.size();
+        double avg_txn = std::accumulate(txn_durations.begin(), txn_durations.end(), 0.0) / txn_durations.size();
+        std::cout << "Avg Transactions: " << avg_plain << " ms plain / " << avg_txn << " ms transactional ("
+                  << (100.0 * (avg_txn - avg_plain) / avg_plain) << " % overhead, " << txn_commits << " commits of up to "
+                  << txn_group << " unions, " << txn_retries << " reader retries in last run, partition "
+                  << (txn_partition_matches ? "matches" : "DIFFERS") << ")" << std::endl;
+    }
     std::cout << "-------------------------" << std::endl;
 
+    if (stats_ran) 
+    {
+        std::cout << "\nStructure after last run (" << final_stats.elements << " elements):" << std::endl;
+        final_stats.print(std::cout);
+    }
+
+    if (hot_ran) 
+    {
+        std::cout << std::endl;
+        HotElementProfiler::printTable(std::cout, hot_report);
+        if (hot_json_file.empty()) 
+        {
+            HotElementProfiler::writeJson(std::cout, hot_report);
+        } 
+        else 
+        {
+            std::ofstream json_out(hot_json_file);
+            HotElementProfiler::writeJson(json_out, hot_report);
+            if (!json_out) 
+            {
+                std::cerr << "Error: Cannot write " << hot_json_file << std::endl;
+                return 1;
+            }
+            std::cout << "Hot-element JSON written to " << hot_json_file << std::endl;
+        }
+        std::cout << std::setprecision(4);
+    }
+
     std::cout << "\nNote on Cache Metrics:" << std::endl;
     std::cout << "To measure cache performance (e.g., cache misses), use external tools." << std::endl;
     std::cout << "On Linux, try 'perf stat':" << std::endl;
@@ -388,7 +1422,7 @@ int main(int argc, char* argv[])
     perf_command += " " + impl_type;
     perf_command += " " + ops_file;
     perf_command += " " + std::to_string(num_runs);
-    if (argc > 4) 
+    if (threads_given) 
     { 
         perf_command += " " + std::to_string(num_threads);
     }
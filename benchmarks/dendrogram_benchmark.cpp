@@ -0,0 +1,184 @@
+#include <iostream>
+#include <vector>
+#include <string>
+#include <fstream>
+#include <chrono>
+#include <stdexcept>
+#include <memory>      // For std::unique_ptr
+#include <iomanip>     // For std::fixed, std::setprecision
+#include <omp.h>       // For omp_set_num_threads and omp_get_max_threads
+#include <cstdint>     // For std::uint64_t
+#include <algorithm>   // For std::max_element
+
+#include "union_find.hpp"
+#ifdef UNIONFIND_LOCKFREE_ENABLED
+#include "union_find_parallel_lockfree.hpp"
+#endif
+#include "dendrogram.hpp"
+
+// Single-linkage clustering benchmark on a synthetic similarity graph.
+// Edges are random pairs with uniform random weights, generated in parallel from
+// a counter-based hash (same graph for every thread count and engine).
+
+// splitmix64: statistically solid, and cheap enough to generate 10^8 edges in place.
+static inline std::uint64_t mix(std::uint64_t x)
+{
+    x += 0x9e3779b97f4a7c15ULL;
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    return x ^ (x >> 31);
+}
+
+std::vector<WeightedEdge> generate_edges(int n, std::size_t m, std::uint64_t seed)
+{
+    std::vector<WeightedEdge> edges(m);
+    #pragma omp parallel for schedule(static)
+    for (std::size_t i = 0; i < m; i++)
+    {
+        std::uint64_t h1 = mix(seed ^ (2 * i));
+        std::uint64_t h2 = mix(seed ^ (2 * i + 1));
+        edges[i].u = static_cast<int>((h1 >> 32) % static_cast<std::uint64_t>(n));
+        edges[i].v = static_cast<int>((h1 & 0xffffffffULL) % static_cast<std::uint64_t>(n));
+        edges[i].weight = static_cast<double>(h2 >> 11) * 0x1.0p-53; // Uniform in [0, 1)
+    }
+    return edges;
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc < 4)
+    {
+        std::cerr << "Usage: " << argv[0] << " <implementation_type> <num_elements> <num_edges> [num_threads] [options]" << std::endl;
+        std::cerr << "  implementation_type: serial, lockfree" << std::endl;
+        std::cerr << "Options:" << std::endl;
+        std::cerr << "  --similarity: Treat weights as similarities (merge the largest first)." << std::endl;
+        std::cerr << "  --seed <s>: Graph seed (default: 1)." << std::endl;
+        std::cerr << "  --cut <t>: Threshold for the timed flat cut (default: median merge height)." << std::endl;
+        std::cerr << "  --linkage-out <file>: Write the linkage matrix to <file>." << std::endl;
+        return 1;
+    }
+
+    std::string impl_type = argv[1];
+    int n_elements = std::stoi(argv[2]);
+    std::size_t n_edges = std::stoull(argv[3]);
+    int num_threads = omp_get_max_threads();
+    bool threads_given = argc > 4 && std::string(argv[4]).rfind("--", 0) != 0;
+    if (threads_given)
+    {
+        num_threads = std::max(1, std::stoi(argv[4]));
+    }
+
+    bool similarity = false;
+    std::uint64_t seed = 1;
+    bool cut_given = false;
+    double cut_threshold = 0.0;
+    std::string linkage_file;
+    for (int arg_idx = threads_given ? 5 : 4; arg_idx < argc; arg_idx++)
+    {
+        std::string flag = argv[arg_idx];
+        if (flag == "--similarity")
+        {
+            similarity = true;
+        }
+        else if (flag == "--seed" && arg_idx + 1 < argc)
+        {
+            seed = std::stoull(argv[++arg_idx]);
+        }
+        else if (flag == "--cut" && arg_idx + 1 < argc)
+        {
+            cut_threshold = std::stod(argv[++arg_idx]);
+            cut_given = true;
+        }
+        else if (flag == "--linkage-out" && arg_idx + 1 < argc)
+        {
+            linkage_file = argv[++arg_idx];
+        }
+        else
+        {
+            std::cerr << "Error: Unknown or incomplete option '" << flag << "'." << std::endl;
+            return 1;
+        }
+    }
+    if (n_elements <= 0)
+    {
+        std::cerr << "Error: Number of elements must be positive." << std::endl;
+        return 1;
+    }
+
+    omp_set_num_threads(num_threads);
+    std::cout << "Generating " << n_edges << " edges over " << n_elements << " elements..." << std::endl;
+    auto gen_start = std::chrono::high_resolution_clock::now();
+    std::vector<WeightedEdge> edges = generate_edges(n_elements, n_edges, seed);
+    auto gen_end = std::chrono::high_resolution_clock::now();
+
+    auto run = [&](auto& dendrogram)
+    {
+        auto build_start = std::chrono::high_resolution_clock::now();
+        dendrogram.build(edges);
+        auto build_end = std::chrono::high_resolution_clock::now();
+
+        const auto& rows = dendrogram.linkage();
+        if (!cut_given && !rows.empty())
+        {
+            cut_threshold = rows[rows.size() / 2].height;
+        }
+        auto cut_start = std::chrono::high_resolution_clock::now();
+        std::vector<int> labels = dendrogram.cut(cut_threshold);
+        auto cut_end = std::chrono::high_resolution_clock::now();
+        int flat_clusters = labels.empty() ? 0 : *std::max_element(labels.begin(), labels.end()) + 1;
+
+        double build_ms = std::chrono::duration<double, std::milli>(build_end - build_start).count();
+        double cut_ms = std::chrono::duration<double, std::milli>(cut_end - cut_start).count();
+
+        std::cout << "\n--- Dendrogram Benchmark Summary ---" << std::endl;
+        std::cout << std::fixed << std::setprecision(4);
+        std::cout << "Implementation: " << impl_type << std::endl;
+        std::cout << "Threads:        " << num_threads << std::endl;
+        std::cout << "Element Count:  " << n_elements << std::endl;
+        std::cout << "Edge Count:     " << n_edges << std::endl;
+        std::cout << "-------------------------" << std::endl;
+        std::cout << "Generate:       " << std::chrono::duration<double, std::milli>(gen_end - gen_start).count() << " ms" << std::endl;
+        std::cout << "Sort + Link:    " << build_ms << " ms (" << (n_edges / (build_ms / 1000.0) / 1e6) << " M edges/s)" << std::endl;
+        std::cout << "Merges:         " << rows.size() << " (" << dendrogram.components() << " clusters at the top)" << std::endl;
+        std::cout << "Cut:            " << cut_ms << " ms (threshold " << cut_threshold << ", " << flat_clusters << " clusters)" << std::endl;
+        std::cout << "-------------------------" << std::endl;
+
+        if (!linkage_file.empty())
+        {
+            std::ofstream out(linkage_file);
+            dendrogram.writeLinkage(out);
+            if (!out)
+            {
+                throw std::runtime_error("Cannot write linkage file " + linkage_file);
+            }
+            std::cout << "Linkage matrix written to " << linkage_file << std::endl;
+        }
+    };
+
+    try
+    {
+        if (impl_type == "serial")
+        {
+            auto dendrogram = std::make_unique<Dendrogram<UnionFind>>(n_elements, similarity);
+            run(*dendrogram);
+        }
+        #ifdef UNIONFIND_LOCKFREE_ENABLED
+        else if (impl_type == "lockfree")
+        {
+            auto dendrogram = std::make_unique<Dendrogram<UnionFindParallelLockFree>>(n_elements, similarity);
+            run(*dendrogram);
+        }
+        #endif
+        else
+        {
+            std::cerr << "Error: Unknown or disabled implementation type '" << impl_type << "'." << std::endl;
+            return 1;
+        }
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
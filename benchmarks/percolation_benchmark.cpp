@@ -0,0 +1,435 @@
+#include <iostream>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <stdexcept>
+#include <memory>      // For std::unique_ptr
+#include <iomanip>     // For std::fixed, std::setprecision
+#include <omp.h>       // For omp_set_num_threads and omp_get_max_threads
+#include <algorithm>   // For std::shuffle, std::transform, std::remove_if
+#include <numeric>     // For std::iota
+#include <random>      // For std::mt19937_64
+#include <cmath>       // For std::sqrt
+#include <cstdint>     // For std::uint64_t
+#include <iterator>    // For std::back_inserter
+
+#include "union_find.hpp"
+#ifdef UNIONFIND_LOCKFREE_ENABLED
+#include "union_find_parallel_lockfree.hpp"
+#endif
+#ifdef UNIONFIND_LOCKFREE_PLAIN_ENABLED
+#include "union_find_parallel_lockfree_plain_write.hpp"
+#endif
+#ifdef UNIONFIND_LOCKFREE_IPC_ENABLED
+#include "union_find_parallel_lockfree_ipc.hpp"
+#endif
+
+// Percolation on L^d hypercubic lattices (d = 2 or 3, open boundaries), spanning
+// along the first axis. Two virtual elements TOP and BOTTOM are joined to the
+// first and last layer, so "spans" is sameSet(TOP, BOTTOM).
+//
+// Two modes:
+//   --trials T       Many independent lattices, one per thread at a time, each filled
+//                    in random order with the serial engine (Newman-Ziff); the occupation
+//                    fraction at which a trial first spans estimates the threshold.
+//   --lattice <impl> One large lattice. All unions for occupation p go through one
+//                    parallel processOperations() batch; p is bisected on a single
+//                    realization (occupation is monotone in p for a fixed seed).
+
+using CanonicalOperation = UnionFind::Operation;
+using CanonicalOperationType = UnionFind::OperationType;
+
+struct Lattice
+{
+    int dim;
+    int side;
+    int sites;
+    int stride[3]; // stride[k] = side^(dim-1-k); axis 0 is the spanning axis
+
+    Lattice(int dim, int side) : dim(dim), side(side), sites(1)
+    {
+        for (int k = 0; k < dim; k++)
+        {
+            sites *= side;
+        }
+        int s = 1;
+        for (int k = dim - 1; k >= 0; k--)
+        {
+            stride[k] = s;
+            s *= side;
+        }
+    }
+
+    int top() const { return sites; }
+    int bottom() const { return sites + 1; }
+    int elements() const { return sites + 2; }
+    int bonds() const { return dim * sites; } // Bond ids site * dim + axis, some off the lattice
+
+    int coord(int site, int axis) const { return site / stride[axis] % side; }
+
+    // Bond 'id' joins site id / dim to its + neighbour along axis id % dim, if it exists.
+    bool bond_exists(int id) const { return coord(id / dim, id % dim) < side - 1; }
+    int bond_other(int id) const { return id / dim + stride[id % dim]; }
+};
+
+// Counter-based uniform in [0, 1): the same realization for every thread count.
+static inline double uniform(std::uint64_t seed, std::uint64_t i)
+{
+    std::uint64_t x = seed ^ (i * 0x9e3779b97f4a7c15ULL);
+    x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+    x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+    x ^= x >> 31;
+    return static_cast<double>(x >> 11) * 0x1.0p-53;
+}
+
+// Reference thresholds (site/bond, square/simple cubic).
+static double known_threshold(bool site, int dim)
+{
+    if (dim == 2)
+    {
+        return site ? 0.592746 : 0.5;
+    }
+    return site ? 0.311608 : 0.248812;
+}
+
+// --- Monte Carlo trials (Newman-Ziff with the serial engine) ---
+
+// Fills one lattice in random order until it spans. Returns the spanning
+// occupation fraction and adds the number of unions performed to 'unions'.
+static double run_trial(const Lattice& lat, bool site, std::uint64_t seed, std::vector<int>& order,
+                        std::vector<char>& occupied, std::uint64_t& unions)
+{
+    UnionFind uf(lat.elements());
+    std::mt19937_64 rng(seed);
+    std::shuffle(order.begin(), order.end(), rng);
+
+    if (site)
+    {
+        std::fill(occupied.begin(), occupied.end(), 0);
+        for (size_t k = 0; k < order.size(); k++)
+        {
+            int s = order[k];
+            occupied[s] = 1;
+            int x = lat.coord(s, 0);
+            if (x == 0)
+            {
+                uf.unionSets(s, lat.top());
+            }
+            if (x == lat.side - 1)
+            {
+                uf.unionSets(s, lat.bottom());
+            }
+            for (int axis = 0; axis < lat.dim; axis++)
+            {
+                int c = lat.coord(s, axis);
+                if (c > 0 && occupied[s - lat.stride[axis]])
+                {
+                    uf.unionSets(s, s - lat.stride[axis]);
+                    unions++;
+                }
+                if (c < lat.side - 1 && occupied[s + lat.stride[axis]])
+                {
+                    uf.unionSets(s, s + lat.stride[axis]);
+                    unions++;
+                }
+            }
+            if (uf.sameSet(lat.top(), lat.bottom()))
+            {
+                return static_cast<double>(k + 1) / lat.sites;
+            }
+        }
+        return 1.0;
+    }
+
+    // Bond percolation: every site is present, bonds open in random order.
+    int layer = lat.stride[0];
+    for (int s = 0; s < layer; s++)
+    {
+        uf.unionSets(s, lat.top());
+        uf.unionSets(lat.sites - layer + s, lat.bottom());
+    }
+    for (size_t k = 0; k < order.size(); k++)
+    {
+        uf.unionSets(order[k] / lat.dim, lat.bond_other(order[k]));
+        unions++;
+        if (uf.sameSet(lat.top(), lat.bottom()))
+        {
+            return static_cast<double>(k + 1) / order.size();
+        }
+    }
+    return 1.0;
+}
+
+static void run_trials(const Lattice& lat, bool site, int trials, std::uint64_t seed)
+{
+    std::vector<double> thresholds(trials);
+    std::uint64_t unions = 0;
+
+    auto start = std::chrono::high_resolution_clock::now();
+    #pragma omp parallel reduction(+ : unions)
+    {
+        std::vector<int> order;
+        if (site)
+        {
+            order.resize(lat.sites);
+            std::iota(order.begin(), order.end(), 0);
+        }
+        else
+        {
+            for (int id = 0; id < lat.bonds(); id++)
+            {
+                if (lat.bond_exists(id))
+                {
+                    order.push_back(id);
+                }
+            }
+        }
+        std::vector<char> occupied(site ? lat.sites : 0);
+
+        #pragma omp for schedule(dynamic, 1)
+        for (int t = 0; t < trials; t++)
+        {
+            thresholds[t] = run_trial(lat, site, seed + static_cast<std::uint64_t>(t), order, occupied, unions);
+        }
+    }
+    auto end = std::chrono::high_resolution_clock::now();
+    double ms = std::chrono::duration<double, std::milli>(end - start).count();
+
+    double mean = std::accumulate(thresholds.begin(), thresholds.end(), 0.0) / trials;
+    double sq_sum = 0.0;
+    for (double p : thresholds)
+    {
+        sq_sum += (p - mean) * (p - mean);
+    }
+    double std_err = trials > 1 ? std::sqrt(sq_sum / (trials - 1) / trials) : 0.0;
+
+    std::cout << "\n--- Percolation Trials Summary ---" << std::endl;
+    std::cout << std::fixed << std::setprecision(4);
+    std::cout << "Lattice:        " << (site ? "site" : "bond") << ", " << lat.dim << "D, L = " << lat.side
+              << " (" << lat.sites << " sites)" << std::endl;
+    std::cout << "Trials:         " << trials << std::endl;
+    std::cout << "-------------------------" << std::endl;
+    std::cout << "Threshold:      " << std::setprecision(5) << mean << " +/- " << std_err
+              << " (reference " << known_threshold(site, lat.dim) << ")" << std::endl;
+    std::cout << std::setprecision(4);
+    std::cout << "Time:           " << ms << " ms (" << trials / (ms / 1000.0) << " trials/s, "
+              << unions / (ms / 1000.0) / 1e6 << " M unions/s)" << std::endl;
+    std::cout << "-------------------------" << std::endl;
+}
+
+// --- One large lattice, parallel unions ---
+
+// Union operations for occupation p: neighbour pairs of occupied sites (site) or
+// open bonds (bond), plus the joins to TOP and BOTTOM.
+static std::vector<CanonicalOperation> lattice_operations(const Lattice& lat, bool site, double p, std::uint64_t seed)
+{
+    auto occupied = [&](int s) { return !site || uniform(seed, static_cast<std::uint64_t>(s)) < p; };
+    auto open = [&](int id)
+    {
+        if (site)
+        {
+            return occupied(id / lat.dim) && occupied(lat.bond_other(id));
+        }
+        return uniform(seed, static_cast<std::uint64_t>(lat.sites) + id) < p;
+    };
+
+    const int layer = lat.stride[0];
+    const size_t bond_slots = static_cast<size_t>(lat.bonds());
+    std::vector<CanonicalOperation> ops(bond_slots + 2 * static_cast<size_t>(layer));
+    #pragma omp parallel for schedule(static)
+    for (size_t id = 0; id < bond_slots; id++)
+    {
+        int b = static_cast<int>(id);
+        bool use = lat.bond_exists(b) && open(b);
+        ops[id] = CanonicalOperation{use ? CanonicalOperationType::UNION_OP : CanonicalOperationType::FIND_OP,
+                                     b / lat.dim, use ? lat.bond_other(b) : 0};
+    }
+    #pragma omp parallel for schedule(static)
+    for (int s = 0; s < layer; s++)
+    {
+        int last = lat.sites - layer + s;
+        ops[bond_slots + 2 * s] = CanonicalOperation{occupied(s) ? CanonicalOperationType::UNION_OP : CanonicalOperationType::FIND_OP,
+                                                     s, lat.top()};
+        ops[bond_slots + 2 * s + 1] = CanonicalOperation{occupied(last) ? CanonicalOperationType::UNION_OP : CanonicalOperationType::FIND_OP,
+                                                         last, lat.bottom()};
+    }
+    ops.erase(std::remove_if(ops.begin(), ops.end(),
+                             [](const CanonicalOperation& op) { return op.type != CanonicalOperationType::UNION_OP; }),
+              ops.end());
+    return ops;
+}
+
+template <typename SpecificUF>
+static void run_lattice(const std::string& impl_type, const Lattice& lat, bool site, int bisect_steps, std::uint64_t seed)
+{
+    using SpecificOperation = typename SpecificUF::Operation;
+    double lo = 0.0, hi = 1.0;
+    double union_ms = 0.0;
+    std::uint64_t unions = 0;
+    double largest_fraction = 0.0;
+    std::vector<int> results;
+
+    for (int step = 0; step < bisect_steps; step++)
+    {
+        double p = (lo + hi) / 2;
+        std::vector<CanonicalOperation> canonical = lattice_operations(lat, site, p, seed);
+        std::vector<SpecificOperation> ops;
+        ops.reserve(canonical.size());
+        std::transform(canonical.begin(), canonical.end(), std::back_inserter(ops), [](const CanonicalOperation& op)
+        {
+            return SpecificOperation{static_cast<decltype(SpecificOperation::type)>(op.type), op.a, op.b};
+        });
+
+        auto uf = std::make_unique<SpecificUF>(lat.elements());
+        auto start = std::chrono::high_resolution_clock::now();
+        uf->processOperations(ops, results);
+        auto end = std::chrono::high_resolution_clock::now();
+        union_ms += std::chrono::duration<double, std::milli>(end - start).count();
+        unions += ops.size();
+
+        bool spans = uf->sameSet(lat.top(), lat.bottom());
+        std::cout << "p = " << std::fixed << std::setprecision(6) << p << ": " << (spans ? "spans" : "no spanning cluster")
+                  << " (" << ops.size() << " unions, " << std::setprecision(2)
+                  << std::chrono::duration<double, std::milli>(end - start).count() << " ms)" << std::endl;
+        if (spans)
+        {
+            hi = p;
+            largest_fraction = static_cast<double>(uf->introspect().largest_component) / lat.elements();
+        }
+        else
+        {
+            lo = p;
+        }
+    }
+
+    std::cout << "\n--- Percolation Lattice Summary ---" << std::endl;
+    std::cout << std::fixed << std::setprecision(4);
+    std::cout << "Implementation: " << impl_type << std::endl;
+    std::cout << "Threads:        " << omp_get_max_threads() << std::endl;
+    std::cout << "Lattice:        " << (site ? "site" : "bond") << ", " << lat.dim << "D, L = " << lat.side
+              << " (" << lat.sites << " sites)" << std::endl;
+    std::cout << "-------------------------" << std::endl;
+    std::cout << "Threshold:      " << std::setprecision(5) << (lo + hi) / 2 << " (bracket " << lo << " .. " << hi
+              << ", reference " << known_threshold(site, lat.dim) << ")" << std::endl;
+    std::cout << std::setprecision(4);
+    std::cout << "Spanning Share: " << 100.0 * largest_fraction << " % of elements in the largest cluster at p = " << hi << std::endl;
+    std::cout << "Union Time:     " << union_ms << " ms over " << bisect_steps << " batches ("
+              << unions / (union_ms / 1000.0) / 1e6 << " M unions/s)" << std::endl;
+    std::cout << "-------------------------" << std::endl;
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc < 4)
+    {
+        std::cerr << "Usage: " << argv[0] << " <site|bond> <2|3> <side_length> [num_threads] [options]" << std::endl;
+        std::cerr << "Options:" << std::endl;
+        std::cerr << "  --trials <T>: Run T independent lattices in parallel (serial engine, Newman-Ziff) and" << std::endl;
+        std::cerr << "                estimate the threshold from their spanning points (default mode, T = 100)." << std::endl;
+        std::cerr << "  --lattice <impl>: One lattice with parallel unions, bisecting the threshold" << std::endl;
+        std::cerr << "                    (impl: serial, lockfree, lockfree_plain, lockfree_ipc)." << std::endl;
+        std::cerr << "  --bisect <k>: Bisection steps for --lattice (default: 12)." << std::endl;
+        std::cerr << "  --seed <s>: Random seed (default: 1)." << std::endl;
+        return 1;
+    }
+
+    std::string kind = argv[1];
+    int dim = std::stoi(argv[2]);
+    int side = std::stoi(argv[3]);
+    if ((kind != "site" && kind != "bond") || (dim != 2 && dim != 3) || side < 2)
+    {
+        std::cerr << "Error: Expected site|bond, dimension 2 or 3 and side length >= 2." << std::endl;
+        return 1;
+    }
+    if (static_cast<double>(side) * side * (dim == 3 ? side : 1) * dim > 2e9)
+    {
+        std::cerr << "Error: Lattice too large for 32-bit element ids." << std::endl;
+        return 1;
+    }
+
+    int num_threads = omp_get_max_threads();
+    bool threads_given = argc > 4 && std::string(argv[4]).rfind("--", 0) != 0;
+    if (threads_given)
+    {
+        num_threads = std::max(1, std::stoi(argv[4]));
+    }
+
+    int trials = 0;
+    std::string lattice_impl;
+    int bisect_steps = 12;
+    std::uint64_t seed = 1;
+    for (int arg_idx = threads_given ? 5 : 4; arg_idx < argc; arg_idx++)
+    {
+        std::string flag = argv[arg_idx];
+        if (flag == "--trials" && arg_idx + 1 < argc)
+        {
+            trials = std::stoi(argv[++arg_idx]);
+        }
+        else if (flag == "--lattice" && arg_idx + 1 < argc)
+        {
+            lattice_impl = argv[++arg_idx];
+        }
+        else if (flag == "--bisect" && arg_idx + 1 < argc)
+        {
+            bisect_steps = std::max(1, std::stoi(argv[++arg_idx]));
+        }
+        else if (flag == "--seed" && arg_idx + 1 < argc)
+        {
+            seed = std::stoull(argv[++arg_idx]);
+        }
+        else
+        {
+            std::cerr << "Error: Unknown or incomplete option '" << flag << "'." << std::endl;
+            return 1;
+        }
+    }
+    if (trials == 0 && lattice_impl.empty())
+    {
+        trials = 100;
+    }
+
+    omp_set_num_threads(num_threads);
+    Lattice lat(dim, side);
+    bool site = kind == "site";
+
+    try
+    {
+        if (trials > 0)
+        {
+            run_trials(lat, site, trials, seed);
+        }
+        if (lattice_impl == "serial")
+        {
+            run_lattice<UnionFind>(lattice_impl, lat, site, bisect_steps, seed);
+        }
+        #ifdef UNIONFIND_LOCKFREE_ENABLED
+        else if (lattice_impl == "lockfree")
+        {
+            run_lattice<UnionFindParallelLockFree>(lattice_impl, lat, site, bisect_steps, seed);
+        }
+        #endif
+        #ifdef UNIONFIND_LOCKFREE_PLAIN_ENABLED
+        else if (lattice_impl == "lockfree_plain")
+        {
+            run_lattice<UnionFindParallelLockFreePlainWrite>(lattice_impl, lat, site, bisect_steps, seed);
+        }
+        #endif
+        #ifdef UNIONFIND_LOCKFREE_IPC_ENABLED
+        else if (lattice_impl == "lockfree_ipc")
+        {
+            run_lattice<UnionFindParallelLockFreeIPC>(lattice_impl, lat, site, bisect_steps, seed);
+        }
+        #endif
+        else if (!lattice_impl.empty())
+        {
+            std::cerr << "Error: Unknown or disabled implementation type '" << lattice_impl << "'." << std::endl;
+            return 1;
+        }
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,203 @@
+#include <iostream>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <stdexcept>
+#include <iomanip>     // For std::fixed, std::setprecision
+#include <omp.h>       // For omp_set_num_threads and omp_get_max_threads
+#include <random>      // For std::mt19937
+#include <algorithm>   // For std::min
+
+#include "union_find.hpp"
+#ifdef UNIONFIND_LOCKFREE_ENABLED
+#include "union_find_parallel_lockfree.hpp"
+#endif
+#ifdef UNIONFIND_PHASED_ENABLED
+#include "union_find_phased.hpp"
+#endif
+
+// A job that alternates single-threaded and parallel phases on one structure:
+// sequential phases call find/unionSets/sameSet one at a time from the main thread
+// (building or inspecting between parallel steps), parallel phases hand a batch to
+// all OpenMP threads. Compared: UnionFind (fast sequential phases, but parallel
+// phases must run on one thread too), UnionFindParallelLockFree (atomics in every
+// phase) and UnionFindPhased (plain kernels, atomic_ref kernels between
+// beginParallel() and endParallel(), same memory).
+
+struct PhaseTimes
+{
+    double sequential_ms = 0.0;
+    double parallel_ms = 0.0;
+    int components = 0;
+    long long positives = 0; // Sequential unions that merged plus sameSet calls that were true
+    long long root_sum = 0;  // Sum of the sequential find results (keeps them live)
+};
+
+// Sequential phase: the operations in order, one call each. The partition after a
+// parallel batch does not depend on its order, so 'positives' is the same for every engine.
+template <typename UF, typename Op>
+void run_sequential(UF& uf, const std::vector<Op>& ops, PhaseTimes& times)
+{
+    for (const Op& op : ops)
+    {
+        switch (op.type)
+        {
+            case UF::OperationType::UNION_OP: times.positives += uf.unionSets(op.a, op.b) ? 1 : 0; break;
+            case UF::OperationType::FIND_OP: times.root_sum += uf.find(op.a); break;
+            default: times.positives += uf.sameSet(op.a, op.b) ? 1 : 0; break;
+        }
+    }
+}
+
+// 'begin'/'end' run around each parallel phase (phase switches for UnionFindPhased).
+template <typename UF, typename Begin, typename End>
+PhaseTimes run_job(int n, const std::vector<std::vector<UnionFind::Operation>>& phases, Begin begin, End end)
+{
+    using Op = typename UF::Operation;
+    std::vector<std::vector<Op>> converted(phases.size());
+    for (size_t p = 0; p < phases.size(); p++)
+    {
+        for (const auto& op : phases[p])
+        {
+            converted[p].push_back(Op{static_cast<typename UF::OperationType>(op.type), op.a, op.b});
+        }
+    }
+
+    PhaseTimes times;
+    UF uf(n);
+    std::vector<int> results;
+    for (size_t p = 0; p < converted.size(); p++)
+    {
+        auto start_time = std::chrono::high_resolution_clock::now();
+        if (p % 2 == 0)
+        {
+            run_sequential(uf, converted[p], times);
+        }
+        else
+        {
+            begin(uf);
+            uf.processOperations(converted[p], results);
+            end(uf);
+        }
+        auto end_time = std::chrono::high_resolution_clock::now();
+        (p % 2 == 0 ? times.sequential_ms : times.parallel_ms) +=
+            std::chrono::duration<double, std::milli>(end_time - start_time).count();
+    }
+    times.components = uf.introspect().components;
+    return times;
+}
+
+void print_times(const std::string& name, const PhaseTimes& t, const PhaseTimes& baseline)
+{
+    double total = t.sequential_ms + t.parallel_ms;
+    std::cout << std::setw(12) << name << ": " << std::setw(9) << total << " ms total ("
+              << std::setw(8) << t.sequential_ms << " sequential, " << std::setw(8) << t.parallel_ms << " parallel), "
+              << (baseline.sequential_ms + baseline.parallel_ms) / total << "x vs UnionFind, "
+              << t.components << " components, " << t.positives << " positive sequential results" << std::endl;
+}
+
+int main(int argc, char* argv[])
+{
+    int n = 1 << 22;
+    int num_threads = omp_get_max_threads();
+    int num_phases = 8;
+    long long ops_per_phase = -1; // Default: n
+    int num_runs = 3;
+    int positional = 0;
+    for (int arg_idx = 1; arg_idx < argc; arg_idx++)
+    {
+        std::string arg = argv[arg_idx];
+        if (arg == "--phases" && arg_idx + 1 < argc)
+        {
+            num_phases = std::max(2, std::stoi(argv[++arg_idx]));
+        }
+        else if (arg == "--ops-per-phase" && arg_idx + 1 < argc)
+        {
+            ops_per_phase = std::stoll(argv[++arg_idx]);
+        }
+        else if (arg == "--runs" && arg_idx + 1 < argc)
+        {
+            num_runs = std::max(1, std::stoi(argv[++arg_idx]));
+        }
+        else if (arg.rfind("--", 0) != 0 && positional == 0)
+        {
+            n = std::stoi(arg);
+            positional++;
+        }
+        else if (arg.rfind("--", 0) != 0 && positional == 1)
+        {
+            num_threads = std::max(1, std::stoi(arg));
+            positional++;
+        }
+        else
+        {
+            std::cerr << "Usage: " << argv[0] << " [n_elements] [num_threads] [--phases <p>] [--ops-per-phase <m>] [--runs <r>]" << std::endl;
+            std::cerr << "  Alternates p phases (default 8) of m operations (default n), sequential first:" << std::endl;
+            std::cerr << "  40% unions, 30% finds, 30% sameSet on uniformly random elements." << std::endl;
+            return 1;
+        }
+    }
+    if (ops_per_phase < 0)
+    {
+        ops_per_phase = n;
+    }
+#ifndef UNIONFIND_PHASED_ENABLED
+    std::cerr << "Error: built without the phased engine (PHASED=1)." << std::endl;
+    return 1;
+#else
+    omp_set_num_threads(num_threads);
+
+    std::vector<std::vector<UnionFind::Operation>> phases(num_phases);
+    std::mt19937 rng(98);
+    std::uniform_int_distribution<int> pick(0, n - 1);
+    std::uniform_int_distribution<int> kind(0, 9);
+    for (auto& phase : phases)
+    {
+        for (long long i = 0; i < ops_per_phase; i++)
+        {
+            int k = kind(rng);
+            int type = k < 4 ? 0 : (k < 7 ? 1 : 2);
+            phase.push_back(UnionFind::Operation{static_cast<UnionFind::OperationType>(type), pick(rng), pick(rng)});
+        }
+    }
+
+    auto nothing = [](auto&) {};
+    PhaseTimes serial, lockfree, phased;
+    for (int run = 0; run < num_runs; run++)
+    {
+        // Keep the best run of each side, so page faults and frequency ramps of
+        // whichever runs first do not count.
+        auto keep_best = [](PhaseTimes& best, const PhaseTimes& t, int r)
+        {
+            if (r == 0 || t.sequential_ms + t.parallel_ms < best.sequential_ms + best.parallel_ms)
+            {
+                best = t;
+            }
+        };
+        keep_best(serial, run_job<UnionFind>(n, phases, nothing, nothing), run);
+#ifdef UNIONFIND_LOCKFREE_ENABLED
+        keep_best(lockfree, run_job<UnionFindParallelLockFree>(n, phases, nothing, nothing), run);
+#endif
+        keep_best(phased, run_job<UnionFindPhased>(n, phases, [](UnionFindPhased& uf) { uf.beginParallel(); },
+                                                   [](UnionFindPhased& uf) { uf.endParallel(); }), run);
+    }
+
+    std::cout << std::fixed << std::setprecision(2);
+    std::cout << "--- Mixed-Phase Benchmark (" << n << " elements, " << num_phases << " phases of " << ops_per_phase
+              << " ops, " << num_threads << " threads, best of " << num_runs << ") ---" << std::endl;
+    print_times("UnionFind", serial, serial);
+#ifdef UNIONFIND_LOCKFREE_ENABLED
+    print_times("LockFree", lockfree, serial);
+#endif
+    print_times("Phased", phased, serial);
+    bool match = phased.components == serial.components && phased.positives == serial.positives;
+#ifdef UNIONFIND_LOCKFREE_ENABLED
+    match = match && lockfree.components == serial.components && lockfree.positives == serial.positives;
+#endif
+    if (!match)
+    {
+        std::cout << "RESULTS DIFFER" << std::endl;
+    }
+    return match ? 0 : 1;
+#endif
+}
@@ -0,0 +1,175 @@
+#include <iostream>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <stdexcept>
+#include <memory>      // For std::unique_ptr
+#include <iomanip>     // For std::fixed, std::setprecision
+#include <omp.h>       // For omp_set_num_threads and omp_get_max_threads
+#include <random>      // For std::mt19937
+#include <numeric>     // For std::accumulate
+#include <cstdint>     // For std::uint64_t
+
+#include "union_find.hpp"
+#include "union_find_pool.hpp"
+
+// Many small independent jobs: a UnionFind allocated per job versus one
+// UnionFindPool whose instances are reset in O(touched) between rounds.
+// Each round runs the same batch of jobs; job sizes are uniform in [min_n, max_n].
+
+struct JobSpec
+{
+    int n;
+    std::vector<UnionFind::Operation> ops;
+    std::vector<UnionFindPool::Operation> pool_ops;
+};
+
+std::vector<JobSpec> generate_jobs(int num_jobs, int min_n, int max_n, double ops_per_element, unsigned seed)
+{
+    std::vector<JobSpec> jobs(num_jobs);
+    #pragma omp parallel for schedule(dynamic, 16)
+    for (int j = 0; j < num_jobs; j++)
+    {
+        std::mt19937 rng(seed + j);
+        int n = std::uniform_int_distribution<int>(min_n, max_n)(rng);
+        std::uniform_int_distribution<int> pick(0, n - 1);
+        std::uniform_int_distribution<int> kind(0, 9);
+        std::size_t m = static_cast<std::size_t>(ops_per_element * n);
+        jobs[j].n = n;
+        jobs[j].ops.reserve(m);
+        jobs[j].pool_ops.reserve(m);
+        for (std::size_t i = 0; i < m; i++)
+        {
+            int k = kind(rng); // 60% unions, 20% finds, 20% sameSet
+            int type = k < 6 ? 0 : (k < 8 ? 1 : 2);
+            int a = pick(rng);
+            int b = pick(rng);
+            jobs[j].ops.push_back(UnionFind::Operation{static_cast<UnionFind::OperationType>(type), a, b});
+            jobs[j].pool_ops.push_back(UnionFindPool::Operation{static_cast<UnionFindPool::OperationType>(type), a, b});
+        }
+    }
+    return jobs;
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc < 5)
+    {
+        std::cerr << "Usage: " << argv[0] << " <num_jobs> <min_n> <max_n> <rounds> [num_threads] [--ops-per-element <r>]" << std::endl;
+        std::cerr << "  Runs <rounds> rounds of <num_jobs> independent jobs, once allocating a UnionFind per job" << std::endl;
+        std::cerr << "  and once on a UnionFindPool (reset between rounds), and reports jobs per second." << std::endl;
+        return 1;
+    }
+
+    int num_jobs = std::stoi(argv[1]);
+    int min_n = std::stoi(argv[2]);
+    int max_n = std::stoi(argv[3]);
+    int rounds = std::stoi(argv[4]);
+    int num_threads = omp_get_max_threads();
+    bool threads_given = argc > 5 && std::string(argv[5]).rfind("--", 0) != 0;
+    if (threads_given)
+    {
+        num_threads = std::max(1, std::stoi(argv[5]));
+    }
+    double ops_per_element = 2.0;
+    for (int arg_idx = threads_given ? 6 : 5; arg_idx < argc; arg_idx++)
+    {
+        std::string flag = argv[arg_idx];
+        if (flag == "--ops-per-element" && arg_idx + 1 < argc)
+        {
+            ops_per_element = std::stod(argv[++arg_idx]);
+        }
+        else
+        {
+            std::cerr << "Error: Unknown or incomplete option '" << flag << "'." << std::endl;
+            return 1;
+        }
+    }
+    if (num_jobs <= 0 || min_n <= 0 || max_n < min_n || rounds <= 0)
+    {
+        std::cerr << "Error: Expected num_jobs > 0, 0 < min_n <= max_n and rounds > 0." << std::endl;
+        return 1;
+    }
+
+    omp_set_num_threads(num_threads);
+    std::cout << "Generating " << num_jobs << " jobs of " << min_n << " .. " << max_n << " elements..." << std::endl;
+    std::vector<JobSpec> specs = generate_jobs(num_jobs, min_n, max_n, ops_per_element, 418);
+    std::size_t total_elements = 0;
+    std::size_t total_ops = 0;
+    for (const auto& spec : specs)
+    {
+        total_elements += spec.n;
+        total_ops += spec.ops.size();
+    }
+    // Result buffers are allocated up front so neither side pays their first touch.
+    std::vector<std::vector<int>> results(num_jobs);
+    for (int j = 0; j < num_jobs; j++)
+    {
+        results[j].assign(specs[j].ops.size(), 0);
+    }
+
+    // --- One UnionFind per job ---
+    auto alloc_start = std::chrono::high_resolution_clock::now();
+    for (int r = 0; r < rounds; r++)
+    {
+        #pragma omp parallel for schedule(dynamic, 16)
+        for (int j = 0; j < num_jobs; j++)
+        {
+            UnionFind uf(specs[j].n);
+            uf.processOperations(specs[j].ops, results[j]);
+        }
+    }
+    auto alloc_end = std::chrono::high_resolution_clock::now();
+    std::vector<int> check(num_jobs);
+    for (int j = 0; j < num_jobs; j++)
+    {
+        check[j] = std::accumulate(results[j].begin(), results[j].end(), 0);
+    }
+
+    // --- Pool: instances carved once, reset between rounds ---
+    auto setup_start = std::chrono::high_resolution_clock::now();
+    UnionFindPool pool(total_elements);
+    std::vector<UnionFindPool::Job> jobs(num_jobs);
+    for (int j = 0; j < num_jobs; j++)
+    {
+        jobs[j] = UnionFindPool::Job{pool.createInstance(specs[j].n), &specs[j].pool_ops, &results[j]};
+    }
+    auto setup_end = std::chrono::high_resolution_clock::now();
+
+    std::uint64_t steals = 0;
+    auto pool_start = std::chrono::high_resolution_clock::now();
+    for (int r = 0; r < rounds; r++)
+    {
+        if (r > 0)
+        {
+            pool.resetAll();
+        }
+        pool.processJobs(jobs);
+        steals += pool.lastBatchSteals();
+    }
+    auto pool_end = std::chrono::high_resolution_clock::now();
+
+    bool match = true;
+    for (int j = 0; j < num_jobs; j++)
+    {
+        match = match && check[j] == std::accumulate(results[j].begin(), results[j].end(), 0);
+    }
+
+    double alloc_ms = std::chrono::duration<double, std::milli>(alloc_end - alloc_start).count();
+    double pool_ms = std::chrono::duration<double, std::milli>(pool_end - pool_start).count();
+    double setup_ms = std::chrono::duration<double, std::milli>(setup_end - setup_start).count();
+    double total_jobs = static_cast<double>(num_jobs) * rounds;
+
+    std::cout << "\n--- Pool Benchmark Summary ---" << std::endl;
+    std::cout << std::fixed << std::setprecision(4);
+    std::cout << "Threads:        " << num_threads << std::endl;
+    std::cout << "Jobs x Rounds:  " << num_jobs << " x " << rounds << " (" << total_elements << " elements, "
+              << total_ops << " ops per round)" << std::endl;
+    std::cout << "-------------------------" << std::endl;
+    std::cout << "UnionFind/job:  " << alloc_ms << " ms (" << total_jobs / (alloc_ms / 1000.0) << " jobs/s)" << std::endl;
+    std::cout << "Pool:           " << pool_ms << " ms (" << total_jobs / (pool_ms / 1000.0) << " jobs/s, "
+              << alloc_ms / pool_ms << "x), setup " << setup_ms << " ms, " << steals << " stolen jobs" << std::endl;
+    std::cout << "Results:        " << (match ? "identical" : "DIFFER") << std::endl;
+    std::cout << "-------------------------" << std::endl;
+    return match ? 0 : 1;
+}
@@ -0,0 +1,158 @@
+#include <iostream>
+#include <vector>
+#include <string>
+#include <chrono>
+#include <stdexcept>
+#include <iomanip>     // For std::fixed, std::setprecision
+#include <omp.h>       // For omp_set_num_threads and omp_get_max_threads
+#include <random>      // For std::mt19937
+#include <cstdint>     // For std::uint64_t
+#include <array>
+#include <algorithm>   // For std::fill, std::min
+
+#include "union_find.hpp"
+#include "small_union_find.hpp"
+
+// SmallUnionFind<N> against UnionFind(N) on many small jobs. Each job builds a
+// fresh structure, runs a random operation list and labels every element with a
+// dense component id (label() versus one find() per element and a root -> label map).
+// Jobs are spread over OpenMP threads; the same lists are used for both sides.
+
+constexpr int LISTS = 64; // Distinct operation lists per N, reused round-robin
+
+template <std::size_t N>
+bool run_size(std::size_t element_budget, double ops_per_element)
+{
+    using Small = SmallUnionFind<N>;
+    const int jobs = static_cast<int>(std::max<std::size_t>(1, element_budget / N));
+    const std::size_t m = static_cast<std::size_t>(ops_per_element * N);
+
+    std::vector<std::vector<UnionFind::Operation>> lists(LISTS);
+    std::vector<std::vector<typename Small::Operation>> small_lists(LISTS);
+    std::mt19937 rng(418 + N);
+    std::uniform_int_distribution<int> pick(0, static_cast<int>(N) - 1);
+    std::uniform_int_distribution<int> kind(0, 9);
+    for (int l = 0; l < LISTS; l++)
+    {
+        for (std::size_t i = 0; i < m; i++)
+        {
+            int k = kind(rng); // 60% unions, 20% finds, 20% sameSet
+            int type = k < 6 ? 0 : (k < 8 ? 1 : 2);
+            int a = pick(rng);
+            int b = pick(rng);
+            lists[l].push_back(UnionFind::Operation{static_cast<UnionFind::OperationType>(type), a, b});
+            small_lists[l].push_back(typename Small::Operation{static_cast<typename Small::OperationType>(type), a, b});
+        }
+    }
+
+    std::uint64_t components_uf = 0;
+    auto uf_start = std::chrono::high_resolution_clock::now();
+    #pragma omp parallel reduction(+ : components_uf)
+    {
+        std::vector<int> results;
+        std::vector<int> labels(N);
+        std::vector<int> label_of_root(N);
+        #pragma omp for schedule(dynamic, 16)
+        for (int j = 0; j < jobs; j++)
+        {
+            UnionFind uf(static_cast<int>(N));
+            uf.processOperations(lists[j % LISTS], results);
+            std::fill(label_of_root.begin(), label_of_root.end(), -1);
+            int next = 0;
+            for (std::size_t i = 0; i < N; i++)
+            {
+                int root = uf.find(static_cast<int>(i));
+                if (label_of_root[root] < 0)
+                {
+                    label_of_root[root] = next++;
+                }
+                labels[i] = label_of_root[root];
+            }
+            components_uf += static_cast<std::uint64_t>(next);
+        }
+    }
+    auto uf_end = std::chrono::high_resolution_clock::now();
+
+    std::uint64_t components_small = 0;
+    auto small_start = std::chrono::high_resolution_clock::now();
+    #pragma omp parallel reduction(+ : components_small)
+    {
+        std::vector<int> results;
+        std::array<typename Small::index_type, N> labels;
+        #pragma omp for schedule(dynamic, 16)
+        for (int j = 0; j < jobs; j++)
+        {
+            Small uf;
+            uf.processOperations(small_lists[j % LISTS], results);
+            int next = uf.label(labels);
+            components_small += static_cast<std::uint64_t>(next);
+        }
+    }
+    auto small_end = std::chrono::high_resolution_clock::now();
+
+    // Label numbering differs (first element vs. root order), so only the component
+    // counts are compared; the operation results must match exactly.
+    bool match = components_uf == components_small;
+    for (int l = 0; l < std::min(jobs, LISTS) && match; l++)
+    {
+        UnionFind uf(static_cast<int>(N));
+        Small small;
+        std::vector<int> expected;
+        std::vector<int> got;
+        uf.processOperations(lists[l], expected);
+        small.processOperations(small_lists[l], got);
+        match = expected == got;
+    }
+
+    double uf_ms = std::chrono::duration<double, std::milli>(uf_end - uf_start).count();
+    double small_ms = std::chrono::duration<double, std::milli>(small_end - small_start).count();
+    std::cout << "N = " << std::setw(5) << N << " (" << sizeof(typename Small::index_type) * 8 << "-bit, "
+              << sizeof(Small) << " bytes), " << jobs << " jobs x " << m << " ops: "
+              << "UnionFind " << jobs / (uf_ms / 1000.0) << " jobs/s, "
+              << "SmallUnionFind " << jobs / (small_ms / 1000.0) << " jobs/s ("
+              << uf_ms / small_ms << "x)" << (match ? "" : " RESULTS DIFFER") << std::endl;
+    return match;
+}
+
+int main(int argc, char* argv[])
+{
+    std::size_t element_budget = std::size_t{1} << 24;
+    int num_threads = omp_get_max_threads();
+    double ops_per_element = 2.0;
+    int positional = 0;
+    for (int arg_idx = 1; arg_idx < argc; arg_idx++)
+    {
+        std::string arg = argv[arg_idx];
+        if (arg == "--ops-per-element" && arg_idx + 1 < argc)
+        {
+            ops_per_element = std::stod(argv[++arg_idx]);
+        }
+        else if (arg.rfind("--", 0) != 0 && positional == 0)
+        {
+            element_budget = std::stoull(arg);
+            positional++;
+        }
+        else if (arg.rfind("--", 0) != 0 && positional == 1)
+        {
+            num_threads = std::max(1, std::stoi(arg));
+            positional++;
+        }
+        else
+        {
+            std::cerr << "Usage: " << argv[0] << " [elements_per_size] [num_threads] [--ops-per-element <r>]" << std::endl;
+            std::cerr << "  Runs elements_per_size / N jobs (default 2^24 elements) for N = 64, 256, 4096, 65536." << std::endl;
+            return 1;
+        }
+    }
+
+    omp_set_num_threads(num_threads);
+    std::cout << std::fixed << std::setprecision(1);
+    std::cout << "--- Small Union-Find Benchmark (" << num_threads << " threads, "
+              << ops_per_element << " ops per element) ---" << std::endl;
+    bool ok = true;
+    ok = run_size<64>(element_budget, ops_per_element) && ok;
+    ok = run_size<256>(element_budget, ops_per_element) && ok;
+    ok = run_size<4096>(element_budget, ops_per_element) && ok;
+    ok = run_size<65536>(element_budget, ops_per_element) && ok;
+    return ok ? 0 : 1;
+}
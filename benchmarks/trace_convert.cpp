@@ -0,0 +1,155 @@
+#include <iostream>
+#include <vector>
+#include <string>
+#include <fstream>
+#include <chrono>
+#include <stdexcept>
+#include <iomanip>     // For std::fixed, std::setprecision
+#include <omp.h>       // For omp_set_num_threads and omp_get_max_threads
+#include <cstdint>     // For std::uint64_t
+#include <cstdio>      // For std::fopen, std::fprintf
+#include <algorithm>   // For std::min
+#include <filesystem>  // For std::filesystem::file_size
+
+#include "union_find.hpp"
+#include "compressed_trace.hpp"
+
+// Converts operation traces between the text format read by the benchmark
+// (generate_ops.py output) and the block-compressed format of compressed_trace.hpp,
+// then reports the compression ratio and the parallel decode throughput of the
+// compressed file. The benchmark reads either format.
+
+// Streams the text trace into the writer without holding it in memory.
+std::uint64_t compress_text(const std::string& in_path, const std::string& out_path, std::uint32_t block_ops)
+{
+    std::ifstream in(in_path);
+    int n_elements = 0;
+    std::uint64_t n_ops = 0;
+    if (!(in >> n_elements >> n_ops) || n_elements <= 0)
+    {
+        throw std::runtime_error("Cannot read the header of " + in_path);
+    }
+    CompressedTraceWriter writer(out_path, n_elements, block_ops);
+    for (std::uint64_t i = 0; i < n_ops; i++)
+    {
+        int type, a, b;
+        if (!(in >> type >> a >> b))
+        {
+            throw std::runtime_error("Cannot read operation " + std::to_string(i + 1) + " of " + in_path);
+        }
+        if (type < 0 || type > 3 || a < 0 || a >= n_elements || (type != 1 && (b < 0 || b >= n_elements)))
+        {
+            throw std::runtime_error("Invalid operation " + std::to_string(i + 1) + " in " + in_path);
+        }
+        // FIND stores no b; the text traces write 0 there.
+        writer.append(UnionFind::Operation{static_cast<UnionFind::OperationType>(type), a, type == 1 ? 0 : b});
+    }
+    writer.close();
+    return n_ops;
+}
+
+void decompress_to_text(const std::string& in_path, const std::string& out_path)
+{
+    CompressedTraceReader reader(in_path);
+    std::FILE* out = std::fopen(out_path.c_str(), "w");
+    if (!out)
+    {
+        throw std::runtime_error("Cannot create " + out_path);
+    }
+    std::fprintf(out, "%d %llu\n", reader.elements(), static_cast<unsigned long long>(reader.operations()));
+    std::vector<UnionFind::Operation> ops;
+    for (std::size_t first = 0; first < reader.blocks(); first += 64)
+    {
+        reader.readBlocks(first, std::min<std::size_t>(64, reader.blocks() - first), ops);
+        for (const auto& op : ops)
+        {
+            std::fprintf(out, "%d %d %d\n", static_cast<int>(op.type), op.a, op.b);
+        }
+    }
+    if (std::fclose(out) != 0)
+    {
+        throw std::runtime_error("Cannot write " + out_path);
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    if (argc < 3)
+    {
+        std::cerr << "Usage: " << argv[0] << " <input> <output> [num_threads] [--block-ops <n>]" << std::endl;
+        std::cerr << "  Text input is compressed; compressed input is written back as text." << std::endl;
+        std::cerr << "  num_threads: Threads for the decode measurement (default: max available)." << std::endl;
+        std::cerr << "  --block-ops <n>: Operations per compressed block (default: 65536)." << std::endl;
+        return 1;
+    }
+    std::string in_path = argv[1];
+    std::string out_path = argv[2];
+    int num_threads = omp_get_max_threads();
+    std::uint32_t block_ops = 65536;
+    for (int arg_idx = 3; arg_idx < argc; arg_idx++)
+    {
+        std::string arg = argv[arg_idx];
+        if (arg == "--block-ops" && arg_idx + 1 < argc)
+        {
+            block_ops = static_cast<std::uint32_t>(std::stoul(argv[++arg_idx]));
+        }
+        else if (arg.rfind("--", 0) != 0)
+        {
+            num_threads = std::max(1, std::stoi(arg));
+        }
+        else
+        {
+            std::cerr << "Error: Unknown or incomplete option '" << arg << "'." << std::endl;
+            return 1;
+        }
+    }
+    omp_set_num_threads(num_threads);
+
+    try
+    {
+        std::string compressed_path = out_path;
+        if (CompressedTraceReader::isCompressedTrace(in_path))
+        {
+            decompress_to_text(in_path, out_path);
+            compressed_path = in_path;
+            std::cout << "Decompressed " << in_path << " -> " << out_path << std::endl;
+        }
+        else
+        {
+            compress_text(in_path, out_path, block_ops);
+            std::cout << "Compressed " << in_path << " -> " << out_path << std::endl;
+        }
+
+        // Ratio against the text file, and best-of-3 decode of the whole trace
+        CompressedTraceReader reader(compressed_path);
+        const std::string text_path = compressed_path == out_path ? in_path : out_path;
+        const double text_bytes = static_cast<double>(std::filesystem::file_size(text_path));
+        const double ops = static_cast<double>(std::max<std::uint64_t>(reader.operations(), 1));
+        std::vector<UnionFind::Operation> decoded;
+        double best_ms = 0.0;
+        for (int run = 0; run < 3; run++)
+        {
+            auto start_time = std::chrono::high_resolution_clock::now();
+            reader.readAll(decoded);
+            auto end_time = std::chrono::high_resolution_clock::now();
+            double ms = std::chrono::duration<double, std::milli>(end_time - start_time).count();
+            best_ms = run == 0 ? ms : std::min(best_ms, ms);
+        }
+
+        std::cout << std::fixed << std::setprecision(2);
+        std::cout << "Operations:     " << reader.operations() << " (" << reader.elements() << " elements, "
+                  << reader.blocks() << " blocks" << (reader.hasContext() ? ", with thread/time context" : "") << ")" << std::endl;
+        std::cout << "Text:           " << text_bytes << " bytes (" << text_bytes / ops << " bytes/op)" << std::endl;
+        std::cout << "Compressed:     " << static_cast<double>(reader.fileBytes()) << " bytes ("
+                  << reader.fileBytes() / ops << " bytes/op, " << text_bytes / reader.fileBytes() << "x vs text, "
+                  << sizeof(UnionFind::Operation) * ops / reader.fileBytes() << "x vs raw Operation)" << std::endl;
+        std::cout << "Decode:         " << best_ms << " ms (" << ops / best_ms / 1000.0 << " Mops/s, "
+                  << num_threads << " threads, best of 3)" << std::endl;
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << "Error: " << e.what() << std::endl;
+        return 1;
+    }
+    return 0;
+}
@@ -0,0 +1,142 @@
+#ifndef BACKGROUND_COMPACTOR_HPP
+#define BACKGROUND_COMPACTOR_HPP
+
+#include <atomic>
+#include <chrono>
+#include <thread>
+#include <algorithm>    // For std::min
+#include <cstdint>
+#include <stdexcept>
+#include <sys/resource.h> // For setpriority
+#include <sys/syscall.h>
+#include <unistd.h>
+
+// --- Background Compactor ---
+
+// Optional helper that flattens the trees of a lock-free Union-Find while it is
+// idle, so the first queries after a bulk union phase do not pay for path
+// compression on the critical path.
+//
+// A single low-priority thread walks the element array in chunks and calls
+// UF::compactRange() on each one. Compression re-points words with CAS (see
+// compact_range.hpp), so it is safe alongside foreground operations. The thread
+// yields to foreground work: it sleeps while UF::isBusy() reports a
+// processOperations batch in flight, and it backs off after a sweep that found
+// nothing left to compact.
+//
+// UF must provide: int size() const, int compactRange(int, int), bool isBusy() const.
+template <typename UF>
+class BackgroundCompactor
+{
+public:
+    // chunk_size: elements compacted between load checks.
+    // busy_backoff: sleep while a foreground batch is running.
+    // idle_backoff: sleep after a sweep that compacted nothing; doubles on each further
+    //               empty sweep (up to 64x) and resets once there is work again.
+    explicit BackgroundCompactor(UF& uf,
+                                 int chunk_size = 4096,
+                                 std::chrono::microseconds busy_backoff = std::chrono::microseconds(200),
+                                 std::chrono::microseconds idle_backoff = std::chrono::microseconds(10000))
+        : uf(uf), chunk_size(chunk_size), busy_backoff(busy_backoff), idle_backoff(idle_backoff)
+    {
+        if (chunk_size <= 0)
+        {
+            throw std::invalid_argument("Chunk size must be positive.");
+        }
+    }
+
+    ~BackgroundCompactor()
+    {
+        stop();
+    }
+
+    BackgroundCompactor(const BackgroundCompactor&) = delete;
+    BackgroundCompactor& operator=(const BackgroundCompactor&) = delete;
+
+    // Starts the background thread (no-op if already running).
+    void start()
+    {
+        if (worker.joinable())
+        {
+            return;
+        }
+        running.store(true, std::memory_order_relaxed);
+        worker = std::thread([this] { run(); });
+    }
+
+    // Stops and joins the background thread (no-op if not running).
+    void stop()
+    {
+        running.store(false, std::memory_order_relaxed);
+        if (worker.joinable())
+        {
+            worker.join();
+        }
+    }
+
+    // Number of full passes over the array completed so far.
+    std::uint64_t sweepsCompleted() const
+    {
+        return sweeps.load(std::memory_order_relaxed);
+    }
+
+    // Total number of elements whose path was compressed by the compactor.
+    std::uint64_t elementsCompacted() const
+    {
+        return compacted.load(std::memory_order_relaxed);
+    }
+
+private:
+    void run()
+    {
+        // Lower the OS priority of this thread only (Linux applies nice per thread).
+        setpriority(PRIO_PROCESS, static_cast<id_t>(syscall(SYS_gettid)), 19);
+
+        const int n = uf.size();
+        int pos = 0;
+        std::uint64_t compacted_this_sweep = 0;
+        std::chrono::microseconds current_idle = idle_backoff;
+
+        while (running.load(std::memory_order_relaxed))
+        {
+            if (uf.isBusy())
+            {
+                std::this_thread::sleep_for(busy_backoff);
+                continue;
+            }
+
+            int end = std::min(n, pos + chunk_size);
+            int c = uf.compactRange(pos, end);
+            compacted_this_sweep += c;
+            compacted.fetch_add(c, std::memory_order_relaxed);
+            pos = end;
+
+            if (pos >= n)
+            {
+                pos = 0;
+                sweeps.fetch_add(1, std::memory_order_relaxed);
+                if (compacted_this_sweep == 0)
+                {
+                    std::this_thread::sleep_for(current_idle); // Nothing left to flatten.
+                    current_idle = std::min(current_idle * 2, idle_backoff * 64);
+                }
+                else
+                {
+                    current_idle = idle_backoff;
+                }
+                compacted_this_sweep = 0;
+            }
+        }
+    }
+
+    UF& uf;
+    int chunk_size;
+    std::chrono::microseconds busy_backoff;
+    std::chrono::microseconds idle_backoff;
+    std::atomic<bool> running{false};
+    std::atomic<std::uint64_t> sweeps{0};
+    std::atomic<std::uint64_t> compacted{0};
+    std::thread worker;
+};
+
+#endif // BACKGROUND_COMPACTOR_HPP
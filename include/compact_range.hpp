@@ -0,0 +1,58 @@
+#ifndef COMPACT_RANGE_HPP
+#define COMPACT_RANGE_HPP
+
+#include <atomic>
+#include "union_find_probes.hpp"
+
+// --- Range Compaction (shared by the lock-free engines) ---
+
+// Body of compactRange() for engines whose packed words use the common encoding
+// (w >= 0: root of rank w; w < 0: ~w is the parent). 'word(i)' returns element
+// i's std::atomic<int>.
+//
+// Every element in [begin, end) that does not point at a root has its whole path
+// re-pointed at the root. The re-pointing uses a strong CAS, so a word is left
+// unchanged only if a concurrent operation really rewrote it, never by a spurious
+// failure: on a quiescent structure one pass flattens the range completely.
+// Returns the number of elements that were not already pointing at a root.
+template <typename Word>
+int compact_word_range(int begin, int end, Word word)
+{
+    int compacted = 0;
+    for (int i = begin; i < end; i++)
+    {
+        int val = word(i).load(std::memory_order_relaxed);
+        if (val >= 0 || word(~val).load(std::memory_order_relaxed) >= 0)
+        {
+            continue; // Already a root or pointing directly at one.
+        }
+
+        int root = ~val;
+        int root_val = word(root).load(std::memory_order_acquire);
+        while (root_val < 0)
+        {
+            root = ~root_val;
+            root_val = word(root).load(std::memory_order_acquire);
+        }
+
+        // Second walk: re-point each element of the path. A failed CAS means a
+        // concurrent writer moved that element (to a root or a shorter path); stop there.
+        int u = i;
+        int u_val = word(u).load(std::memory_order_acquire);
+        while (u_val < 0 && ~u_val != root)
+        {
+            int parent = ~u_val;
+            if (!word(u).compare_exchange_strong(u_val, ~root, std::memory_order_release, std::memory_order_relaxed))
+            {
+                break;
+            }
+            UF_PROBE3(compress, u, root, parent);
+            u = parent;
+            u_val = word(u).load(std::memory_order_acquire);
+        }
+        compacted++;
+    }
+    return compacted;
+}
+
+#endif // COMPACT_RANGE_HPP
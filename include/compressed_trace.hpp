@@ -0,0 +1,582 @@
+#ifndef COMPRESSED_TRACE_HPP
+#define COMPRESSED_TRACE_HPP
+
+#include <vector>
+#include <string>
+#include <cerrno>
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <stdexcept>
+#include <omp.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include "union_find.hpp"
+
+// --- Compressed Trace Format ---
+
+// Block-compressed binary encoding of operation traces (UnionFind::Operation),
+// about 2-6x smaller than the text format, with blocks that decode independently
+// so a reader can decode many at once.
+//
+// File layout (little-endian, native struct layout of the records below):
+//   FileHeader  magic "UFTC", version, flags, n_elements, block_ops
+//   blocks      back to back; a block of k operations holds
+//                 ceil(k / 4) bytes of 2-bit operation types (op i in bits
+//                 2 * (i % 4) of byte i / 4), then for every operation
+//                 varint(zigzag(a - previous a)) and, unless it is a FIND,
+//                 varint(zigzag(b - a)),
+//                 then, if the file has the CONTEXT flag, for every operation
+//                 varint(thread) and varint(zigzag(time - previous time)).
+//               'previous a' and 'previous time' start at 0 in each block. FIND
+//               operations store no b and decode with b = 0, which is what the
+//               text traces hold.
+//   BlockIndex  one entry per block: file offset, first operation, ops, bytes
+//   FileFooter  index offset, total operations, number of blocks, magic "UFTI"
+// The index and footer are written last, so a trace is written in one streaming
+// pass. Deltas keep locality-ordered traces (grids, ranges, relabeled graphs) to
+// one or two bytes per id; uniformly random ids still need about log2(n) bits.
+//
+// Errors (I/O, bad magic, corrupt blocks, ids outside [0, n_elements)) throw
+// std::runtime_error.
+
+// Where and when a recorded operation was issued (files with the CONTEXT flag,
+// written by TraceRecorder). Readers that only replay operations ignore it.
+struct TraceContext
+{
+    std::uint32_t thread;   // Dense id of the issuing thread
+    std::uint64_t time_ns;  // Nanoseconds since recording started
+};
+
+class CompressedTraceWriter
+{
+public:
+    // Creates (truncates) 'path'. Precondition: n_elements > 0, block_ops > 0.
+    // with_context: also store a TraceContext per operation (append(op, context)).
+    CompressedTraceWriter(const std::string& path, int n_elements, std::uint32_t block_ops = 65536,
+                          bool with_context = false)
+        : path(path), n_elements(n_elements), block_ops(block_ops), with_context(with_context)
+    {
+        if (n_elements <= 0 || block_ops == 0)
+        {
+            throw std::invalid_argument("CompressedTraceWriter: n_elements and block_ops must be positive.");
+        }
+        fd = ::open(path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0)
+        {
+            throw_io_error("create", path);
+        }
+        FileHeader header{{'U', 'F', 'T', 'C'}, VERSION, static_cast<std::uint16_t>(with_context ? FLAG_CONTEXT : 0),
+                          static_cast<std::uint32_t>(n_elements), block_ops};
+        write_or_throw(&header, sizeof(header));
+        pending.reserve(block_ops);
+        if (with_context)
+        {
+            pending_context.reserve(block_ops);
+        }
+    }
+
+    // Writes the last block, the index and the footer if close() was not called.
+    ~CompressedTraceWriter()
+    {
+        try
+        {
+            close();
+        }
+        catch (const std::exception&)
+        {
+            // Destructors must not throw; call close() to see the error.
+        }
+    }
+
+    CompressedTraceWriter(const CompressedTraceWriter&) = delete;
+    CompressedTraceWriter& operator=(const CompressedTraceWriter&) = delete;
+
+    // Appends one operation. Precondition: 0 <= op.a < n_elements, and op.b too
+    // unless op is a FIND.
+    void append(const UnionFind::Operation& op)
+    {
+        append(op, TraceContext{0, 0});
+    }
+
+    // Same, with the operation's context (dropped unless the file has contexts).
+    void append(const UnionFind::Operation& op, const TraceContext& context)
+    {
+        pending.push_back(op);
+        if (with_context)
+        {
+            pending_context.push_back(context);
+        }
+        if (pending.size() == block_ops)
+        {
+            flush_block();
+        }
+    }
+
+    void append(const std::vector<UnionFind::Operation>& ops)
+    {
+        for (const auto& op : ops)
+        {
+            append(op);
+        }
+    }
+
+    // Finishes the file. Idempotent.
+    void close()
+    {
+        if (fd < 0)
+        {
+            return;
+        }
+        if (!pending.empty())
+        {
+            flush_block();
+        }
+        FileFooter footer{offset, total_ops, static_cast<std::uint32_t>(index.size()), {'U', 'F', 'T', 'I'}};
+        write_or_throw(index.data(), index.size() * sizeof(BlockIndex));
+        write_or_throw(&footer, sizeof(footer));
+        int closing = fd;
+        fd = -1;
+        if (::close(closing) != 0)
+        {
+            throw_io_error("close", path);
+        }
+    }
+
+    // Bytes written so far (header and blocks; the index comes on close()).
+    std::uint64_t bytesWritten() const
+    {
+        return offset;
+    }
+
+    std::uint64_t operationsWritten() const
+    {
+        return total_ops + pending.size();
+    }
+
+    // Encodes ops (and contexts, if not null) into 'out' (cleared first) in the block format above.
+    static void encodeBlock(const UnionFind::Operation* ops, const TraceContext* contexts, std::size_t count,
+                            std::vector<std::uint8_t>& out)
+    {
+        out.assign((count + 3) / 4, 0);
+        out.reserve(out.size() + count * 10);
+        int previous_a = 0;
+        for (std::size_t i = 0; i < count; i++)
+        {
+            const UnionFind::Operation& op = ops[i];
+            const unsigned type = static_cast<unsigned>(op.type) & 3u;
+            out[i / 4] |= static_cast<std::uint8_t>(type << (2 * (i % 4)));
+            put_varint(out, zigzag(op.a - previous_a));
+            if (op.type != UnionFind::OperationType::FIND_OP)
+            {
+                put_varint(out, zigzag(op.b - op.a));
+            }
+            previous_a = op.a;
+        }
+        std::uint64_t previous_time = 0;
+        for (std::size_t i = 0; contexts != nullptr && i < count; i++)
+        {
+            put_varint(out, contexts[i].thread);
+            put_varint(out, zigzag64(contexts[i].time_ns - previous_time));
+            previous_time = contexts[i].time_ns;
+        }
+    }
+
+private:
+    friend class CompressedTraceReader;
+
+    static constexpr std::uint16_t VERSION = 1;
+    static constexpr std::uint16_t FLAG_CONTEXT = 1; // Blocks carry a TraceContext per operation
+
+    struct FileHeader
+    {
+        char magic[4];
+        std::uint16_t version;
+        std::uint16_t flags;
+        std::uint32_t n_elements;
+        std::uint32_t block_ops;
+    };
+
+    struct BlockIndex
+    {
+        std::uint64_t offset;   // File offset of the block
+        std::uint64_t first_op; // Index of its first operation in the trace
+        std::uint32_t ops;
+        std::uint32_t bytes;
+    };
+
+    struct FileFooter
+    {
+        std::uint64_t index_offset;
+        std::uint64_t total_ops;
+        std::uint32_t blocks;
+        char magic[4];
+    };
+
+    static std::uint32_t zigzag(int v)
+    {
+        return (static_cast<std::uint32_t>(v) << 1) ^ static_cast<std::uint32_t>(v >> 31);
+    }
+
+    // Difference of two unsigned times, read as signed and zigzagged.
+    static std::uint64_t zigzag64(std::uint64_t difference)
+    {
+        return (difference << 1) ^ (0 - (difference >> 63));
+    }
+
+    static void put_varint(std::vector<std::uint8_t>& out, std::uint64_t v)
+    {
+        while (v >= 0x80)
+        {
+            out.push_back(static_cast<std::uint8_t>(v | 0x80));
+            v >>= 7;
+        }
+        out.push_back(static_cast<std::uint8_t>(v));
+    }
+
+    void flush_block()
+    {
+        encodeBlock(pending.data(), with_context ? pending_context.data() : nullptr, pending.size(), encoded);
+        index.push_back(BlockIndex{offset, total_ops, static_cast<std::uint32_t>(pending.size()),
+                                   static_cast<std::uint32_t>(encoded.size())});
+        write_or_throw(encoded.data(), encoded.size());
+        total_ops += pending.size();
+        pending.clear();
+        pending_context.clear();
+    }
+
+    void write_or_throw(const void* data, std::size_t len)
+    {
+        const char* p = static_cast<const char*>(data);
+        offset += len;
+        while (len > 0)
+        {
+            ssize_t w = ::write(fd, p, len);
+            if (w < 0 && errno == EINTR)
+            {
+                continue;
+            }
+            if (w <= 0)
+            {
+                throw_io_error("write", path);
+            }
+            p += w;
+            len -= static_cast<std::size_t>(w);
+        }
+    }
+
+    [[noreturn]] static void throw_io_error(const char* what, const std::string& path)
+    {
+        throw std::runtime_error(std::string("Compressed trace: cannot ") + what + " " + path + ": " + std::strerror(errno));
+    }
+
+    std::string path;
+    int n_elements;
+    std::uint32_t block_ops;
+    bool with_context;
+    int fd = -1;
+    std::uint64_t offset = 0;
+    std::uint64_t total_ops = 0;
+    std::vector<UnionFind::Operation> pending;
+    std::vector<TraceContext> pending_context;
+    std::vector<std::uint8_t> encoded;
+    std::vector<BlockIndex> index;
+};
+
+class CompressedTraceReader
+{
+public:
+    // Opens 'path' and loads its block index.
+    explicit CompressedTraceReader(const std::string& path)
+        : path(path)
+    {
+        fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+        {
+            throw_io_error("open", path);
+        }
+        struct stat st;
+        if (::fstat(fd, &st) != 0)
+        {
+            ::close(fd);
+            throw_io_error("stat", path);
+        }
+        file_bytes = static_cast<std::uint64_t>(st.st_size);
+        try
+        {
+            Header header;
+            Footer footer;
+            if (file_bytes < sizeof(Header) + sizeof(Footer))
+            {
+                throw std::runtime_error("Compressed trace: " + path + " is too short.");
+            }
+            read_at(&header, sizeof(header), 0);
+            read_at(&footer, sizeof(footer), file_bytes - sizeof(footer));
+            if (std::memcmp(header.magic, "UFTC", 4) != 0 || std::memcmp(footer.magic, "UFTI", 4) != 0 ||
+                header.version != CompressedTraceWriter::VERSION ||
+                (header.flags & ~CompressedTraceWriter::FLAG_CONTEXT) != 0 || header.n_elements == 0 ||
+                header.n_elements > static_cast<std::uint32_t>(INT32_MAX) ||
+                footer.index_offset + std::uint64_t{footer.blocks} * sizeof(Index) + sizeof(Footer) != file_bytes)
+            {
+                throw std::runtime_error("Compressed trace: " + path + " has a bad header or footer.");
+            }
+            n_elements = static_cast<int>(header.n_elements);
+            with_context = (header.flags & CompressedTraceWriter::FLAG_CONTEXT) != 0;
+            total_ops = footer.total_ops;
+            index.resize(footer.blocks);
+            read_at(index.data(), index.size() * sizeof(Index), footer.index_offset);
+            std::uint64_t expected_op = 0;
+            for (const Index& block : index)
+            {
+                if (block.first_op != expected_op || block.offset + block.bytes > footer.index_offset)
+                {
+                    throw std::runtime_error("Compressed trace: " + path + " has a corrupt block index.");
+                }
+                expected_op += block.ops;
+            }
+            if (expected_op != total_ops)
+            {
+                throw std::runtime_error("Compressed trace: " + path + " has a corrupt block index.");
+            }
+        }
+        catch (...)
+        {
+            ::close(fd);
+            throw;
+        }
+    }
+
+    ~CompressedTraceReader()
+    {
+        ::close(fd);
+    }
+
+    CompressedTraceReader(const CompressedTraceReader&) = delete;
+    CompressedTraceReader& operator=(const CompressedTraceReader&) = delete;
+
+    // True if 'path' starts with the compressed trace magic.
+    static bool isCompressedTrace(const std::string& path)
+    {
+        int probe = ::open(path.c_str(), O_RDONLY);
+        if (probe < 0)
+        {
+            return false;
+        }
+        char magic[4] = {};
+        bool match = ::pread(probe, magic, sizeof(magic), 0) == static_cast<ssize_t>(sizeof(magic)) &&
+                     std::memcmp(magic, "UFTC", 4) == 0;
+        ::close(probe);
+        return match;
+    }
+
+    int elements() const
+    {
+        return n_elements;
+    }
+
+    std::uint64_t operations() const
+    {
+        return total_ops;
+    }
+
+    std::size_t blocks() const
+    {
+        return index.size();
+    }
+
+    // True if the file stores a TraceContext per operation.
+    bool hasContext() const
+    {
+        return with_context;
+    }
+
+    // Size of the whole file.
+    std::uint64_t fileBytes() const
+    {
+        return file_bytes;
+    }
+
+    // Reads blocks [first, first + count) with one pread and decodes them in
+    // parallel (one block per task) into 'ops', which is resized to their total.
+    // If 'contexts' is given it receives the operations' contexts (all zero when
+    // the file has none).
+    void readBlocks(std::size_t first, std::size_t count, std::vector<UnionFind::Operation>& ops,
+                    std::vector<TraceContext>* contexts = nullptr)
+    {
+        if (first > index.size() || count > index.size() - first)
+        {
+            throw std::out_of_range("Compressed trace: block range past the end of " + path);
+        }
+        ops.clear();
+        if (contexts != nullptr)
+        {
+            contexts->clear();
+        }
+        if (count == 0)
+        {
+            return;
+        }
+        const Index& begin_block = index[first];
+        const Index& last_block = index[first + count - 1];
+        const std::uint64_t base_offset = begin_block.offset;
+        const std::uint64_t base_op = begin_block.first_op;
+        buffer.resize(last_block.offset + last_block.bytes - base_offset);
+        read_at(buffer.data(), buffer.size(), base_offset);
+        ops.resize(last_block.first_op + last_block.ops - base_op);
+        if (contexts != nullptr)
+        {
+            contexts->assign(ops.size(), TraceContext{0, 0});
+        }
+        TraceContext* context_data = contexts != nullptr && with_context ? contexts->data() : nullptr;
+
+        bool corrupt = false;
+        #pragma omp parallel for schedule(dynamic, 1) reduction(|| : corrupt)
+        for (std::size_t b = first; b < first + count; b++)
+        {
+            const Index& block = index[b];
+            const std::size_t out = block.first_op - base_op;
+            corrupt = corrupt || !decodeBlock(buffer.data() + (block.offset - base_offset), block.bytes, block.ops,
+                                              n_elements, ops.data() + out, with_context,
+                                              context_data != nullptr ? context_data + out : nullptr);
+        }
+        if (corrupt)
+        {
+            throw std::runtime_error("Compressed trace: corrupt block in " + path);
+        }
+    }
+
+    void readAll(std::vector<UnionFind::Operation>& ops, std::vector<TraceContext>* contexts = nullptr)
+    {
+        readBlocks(0, index.size(), ops, contexts);
+    }
+
+    // Decodes one block of 'count' operations from bytes [data, data + bytes) into
+    // 'out'; with has_context the block's contexts follow and are decoded into
+    // 'contexts' (skipped if it is null). Returns false if the block is truncated,
+    // has trailing bytes, or yields an id outside [0, n_elements).
+    static bool decodeBlock(const std::uint8_t* data, std::size_t bytes, std::size_t count, int n_elements,
+                            UnionFind::Operation* out, bool has_context = false, TraceContext* contexts = nullptr)
+    {
+        const std::size_t type_bytes = (count + 3) / 4;
+        if (bytes < type_bytes)
+        {
+            return false;
+        }
+        const std::uint8_t* p = data + type_bytes;
+        const std::uint8_t* end = data + bytes;
+        const std::uint32_t n = static_cast<std::uint32_t>(n_elements);
+        std::uint32_t a = 0;
+        bool in_range = true;
+        for (std::size_t i = 0; i < count; i++)
+        {
+            const unsigned type = (data[i / 4] >> (2 * (i % 4))) & 3u;
+            std::uint64_t v;
+            if (!get_varint(p, end, v))
+            {
+                return false;
+            }
+            a += unzigzag(static_cast<std::uint32_t>(v)); // Wraps like the int difference it undoes.
+            std::uint32_t b = 0;
+            if (type != static_cast<unsigned>(UnionFind::OperationType::FIND_OP))
+            {
+                if (!get_varint(p, end, v))
+                {
+                    return false;
+                }
+                b = a + unzigzag(static_cast<std::uint32_t>(v));
+            }
+            in_range = in_range && a < n && b < n;
+            out[i].type = static_cast<UnionFind::OperationType>(type);
+            out[i].a = static_cast<int>(a);
+            out[i].b = static_cast<int>(b);
+        }
+        std::uint64_t time = 0;
+        for (std::size_t i = 0; has_context && i < count; i++)
+        {
+            std::uint64_t thread, v;
+            if (!get_varint(p, end, thread) || !get_varint(p, end, v) || thread > UINT32_MAX)
+            {
+                return false;
+            }
+            time += (v >> 1) ^ (0 - (v & 1));
+            if (contexts != nullptr)
+            {
+                contexts[i] = TraceContext{static_cast<std::uint32_t>(thread), time};
+            }
+        }
+        return in_range && p == end;
+    }
+
+private:
+    using Header = CompressedTraceWriter::FileHeader;
+    using Index = CompressedTraceWriter::BlockIndex;
+    using Footer = CompressedTraceWriter::FileFooter;
+
+    static std::uint32_t unzigzag(std::uint32_t v)
+    {
+        return (v >> 1) ^ (0u - (v & 1u));
+    }
+
+    // LEB128, at most 10 bytes for 64 bits. Ids (32 bits) that decode wider are
+    // truncated and caught by the range check.
+    static bool get_varint(const std::uint8_t*& p, const std::uint8_t* end, std::uint64_t& v)
+    {
+        if (p < end && *p < 0x80)
+        {
+            v = *p++; // One-byte fast path (small deltas)
+            return true;
+        }
+        v = 0;
+        for (int shift = 0; shift < 70 && p < end; shift += 7)
+        {
+            const std::uint8_t byte = *p++;
+            v |= static_cast<std::uint64_t>(byte & 0x7F) << shift;
+            if (byte < 0x80)
+            {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    void read_at(void* data, std::size_t len, std::uint64_t offset) const
+    {
+        char* p = static_cast<char*>(data);
+        while (len > 0)
+        {
+            ssize_t r = ::pread(fd, p, len, static_cast<off_t>(offset));
+            if (r < 0 && errno == EINTR)
+            {
+                continue;
+            }
+            if (r <= 0)
+            {
+                if (r == 0)
+                {
+                    errno = EIO; // Unexpected end of file
+                }
+                throw_io_error("read", path);
+            }
+            p += r;
+            len -= static_cast<std::size_t>(r);
+            offset += static_cast<std::uint64_t>(r);
+        }
+    }
+
+    [[noreturn]] static void throw_io_error(const char* what, const std::string& path)
+    {
+        throw std::runtime_error(std::string("Compressed trace: cannot ") + what + " " + path + ": " + std::strerror(errno));
+    }
+
+    std::string path;
+    int fd = -1;
+    std::uint64_t file_bytes = 0;
+    int n_elements = 0;
+    bool with_context = false;
+    std::uint64_t total_ops = 0;
+    std::vector<Index> index;
+    std::vector<std::uint8_t> buffer; // Raw bytes of the last readBlocks() range
+};
+
+#endif // COMPRESSED_TRACE_HPP
@@ -0,0 +1,214 @@
+#ifndef DENDROGRAM_HPP
+#define DENDROGRAM_HPP
+
+#include <vector>
+#include <cstdint>
+#include <cstddef>
+#include <ostream>
+#include <stdexcept>
+#include <algorithm> // For std::sort, std::upper_bound
+#include "union_find_parallel_lockfree.hpp"
+
+#if __has_include(<parallel/algorithm>)
+#include <parallel/algorithm> // libstdc++ parallel mode (OpenMP multiway mergesort)
+#define UNIONFIND_HAS_PARALLEL_SORT 1
+#endif
+
+// --- Single-Linkage Dendrogram ---
+
+// Weighted edge of a similarity / distance graph.
+struct WeightedEdge
+{
+    int u;
+    int v;
+    double weight;
+};
+
+// Single-linkage hierarchical clustering on top of a Union-Find engine (Kruskal order).
+// build() sorts the edges in parallel, then walks them from the closest pair to the
+// farthest and records every merge with its height in a linkage matrix using the
+// SciPy convention: leaves are clusters 0..n-1, merge k creates cluster n+k, and a
+// row is (cluster a, cluster b, height, size of the new cluster).
+//
+// Merges have to be applied in weight order, but most edges of a large graph join
+// elements that are already connected. Each block of BLOCK_EDGES sorted edges is
+// therefore filtered first with parallel sameSet() calls (for engines that declare
+// static constexpr bool thread_safe_queries = true), and only the surviving edges
+// go through the sequential merge loop.
+//
+// With similarity = true, larger weights are closer: edges are taken in descending
+// order and cut(t) joins everything merged at height >= t.
+template <typename UF = UnionFindParallelLockFree>
+class Dendrogram
+{
+public:
+    struct Merge
+    {
+        int a;         // Cluster id of one side
+        int b;         // Cluster id of the other side
+        double height; // Weight of the edge that caused the merge
+        int size;      // Leaves in the new cluster n + row
+    };
+
+    static constexpr std::size_t BLOCK_EDGES = 1 << 16;
+
+    // Precondition: n >= 0
+    explicit Dendrogram(int n, bool similarity = false)
+        : n_leaves(n), similarity(similarity), uf(n > 0 ? n : 0),
+          cluster_of_root(n > 0 ? n : 0), cluster_size(n > 0 ? n : 0, 1), tree_parent(n > 0 ? n : 0, -1)
+    {
+        if (n < 0)
+        {
+            throw std::invalid_argument("Number of elements cannot be negative.");
+        }
+        for (int i = 0; i < n; i++)
+        {
+            cluster_of_root[i] = i;
+        }
+        // At most n - 1 merges, so the per-cluster arrays never reallocate.
+        cluster_size.reserve(2 * static_cast<std::size_t>(n));
+        tree_parent.reserve(2 * static_cast<std::size_t>(n));
+        merges.reserve(n > 0 ? n - 1 : 0);
+    }
+
+    Dendrogram(const Dendrogram&) = delete;
+    Dendrogram& operator=(const Dendrogram&) = delete;
+
+    // Sorts 'edges' in place and merges along them. Call once.
+    // Throws std::out_of_range on an endpoint outside [0, n).
+    void build(std::vector<WeightedEdge>& edges)
+    {
+        if (built)
+        {
+            throw std::logic_error("Dendrogram::build() called twice.");
+        }
+        built = true;
+        for (const WeightedEdge& e : edges)
+        {
+            if (e.u < 0 || e.u >= n_leaves || e.v < 0 || e.v >= n_leaves)
+            {
+                throw std::out_of_range("Edge endpoint out of range in Dendrogram::build().");
+            }
+        }
+        sort_edges(edges);
+
+        std::vector<unsigned char> crosses(std::min(BLOCK_EDGES, edges.size()));
+        for (std::size_t first = 0; first < edges.size() && components() > 1; first += BLOCK_EDGES)
+        {
+            const std::size_t count = std::min(BLOCK_EDGES, edges.size() - first);
+            // Merges inside this block only ever turn "crossing" into "internal",
+            // so an edge filtered out here can never be a merge.
+            #pragma omp parallel for schedule(static) if (concurrent_finds)
+            for (std::size_t i = 0; i < count; i++)
+            {
+                const WeightedEdge& e = edges[first + i];
+                crosses[i] = uf.sameSet(e.u, e.v) ? 0 : 1;
+            }
+            for (std::size_t i = 0; i < count; i++)
+            {
+                if (crosses[i])
+                {
+                    link(edges[first + i]);
+                }
+            }
+        }
+    }
+
+    // One row per merge, in merge order (heights are monotone).
+    const std::vector<Merge>& linkage() const
+    {
+        return merges;
+    }
+
+    // Number of clusters left after build() (n minus the number of merges).
+    int components() const
+    {
+        return n_leaves - static_cast<int>(merges.size());
+    }
+
+    // Flat cluster labels 0..c-1 for every leaf, joining all merges at height <= threshold
+    // (>= threshold for similarities). O(n) after an O(log n) search for the cut row.
+    std::vector<int> cut(double threshold) const
+    {
+        auto below = [this](double t, const Merge& m) { return similarity ? m.height < t : t < m.height; };
+        const int kept = static_cast<int>(std::upper_bound(merges.begin(), merges.end(), threshold, below) - merges.begin());
+        const int limit = n_leaves + kept; // Cluster ids below this exist at the cut
+
+        // Parents always have larger ids, so one descending pass labels every node
+        // with the label of its highest ancestor below the cut.
+        std::vector<int> node_label(limit);
+        int next_label = 0;
+        for (int id = limit - 1; id >= 0; id--)
+        {
+            int p = tree_parent[id];
+            node_label[id] = (p >= 0 && p < limit) ? node_label[p] : next_label++;
+        }
+        node_label.resize(n_leaves);
+        return node_label;
+    }
+
+    // Writes the linkage matrix, one "a b height size" row per line.
+    void writeLinkage(std::ostream& out) const
+    {
+        for (const Merge& m : merges)
+        {
+            out << m.a << ' ' << m.b << ' ' << m.height << ' ' << m.size << '\n';
+        }
+    }
+
+    // The underlying engine (final partition after build()).
+    UF& engine()
+    {
+        return uf;
+    }
+
+private:
+    // Engines opt in to concurrent finds explicitly; without the member the filter runs on one thread.
+    static constexpr bool concurrent_finds = requires { requires UF::thread_safe_queries; };
+
+    void sort_edges(std::vector<WeightedEdge>& edges) const
+    {
+        auto closer = [this](const WeightedEdge& l, const WeightedEdge& r)
+        {
+            return similarity ? l.weight > r.weight : l.weight < r.weight;
+        };
+#ifdef UNIONFIND_HAS_PARALLEL_SORT
+        __gnu_parallel::sort(edges.begin(), edges.end(), closer);
+#else
+        std::sort(edges.begin(), edges.end(), closer);
+#endif
+    }
+
+    // Merges the clusters of e.u and e.v if they differ and records the row.
+    void link(const WeightedEdge& e)
+    {
+        int root_u = uf.find(e.u);
+        int root_v = uf.find(e.v);
+        if (root_u == root_v)
+        {
+            return; // Joined by an earlier edge of the same block.
+        }
+        int a = cluster_of_root[root_u];
+        int b = cluster_of_root[root_v];
+        uf.unionSets(root_u, root_v);
+        int id = n_leaves + static_cast<int>(merges.size());
+        int size = cluster_size[a] + cluster_size[b];
+        merges.push_back(Merge{a, b, e.weight, size});
+        cluster_of_root[uf.find(root_u)] = id;
+        cluster_size.push_back(size);
+        tree_parent[a] = id;
+        tree_parent[b] = id;
+        tree_parent.push_back(-1);
+    }
+
+    int n_leaves;
+    bool similarity;
+    bool built = false;
+    UF uf;
+    std::vector<int> cluster_of_root;    // Engine root -> current cluster id
+    std::vector<int> cluster_size;       // Cluster id -> leaves
+    std::vector<int> tree_parent;        // Cluster id -> id of the merge that absorbed it, -1 for tops
+    std::vector<Merge> merges;
+};
+
+#endif // DENDROGRAM_HPP
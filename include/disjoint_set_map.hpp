@@ -0,0 +1,261 @@
+#ifndef DISJOINT_SET_MAP_HPP
+#define DISJOINT_SET_MAP_HPP
+
+#include <vector>
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+#include <stdexcept>
+#include <type_traits>
+#include "zeroed_buffer.hpp"
+#include "union_find_parallel_lockfree.hpp"
+
+// --- Disjoint Set Map (sparse keys) ---
+
+// Union-Find over sparse integral keys (64-bit hashes, account ids, ...).
+// A lock-free open-addressing table assigns each key a dense index 0..size()-1
+// the first time it is seen, and the dense indices drive a
+// UnionFindParallelLockFree engine. All operations are thread-safe.
+//
+// Table slots go through three states kept in Slot::state:
+//   0        -> empty
+//   CLAIMED  -> a thread won the slot and is publishing its key/id
+//   id + 1   -> published: Slot::key holds the key, 'id' its dense index
+// A slot is claimed with one CAS; the key is written before the id is published
+// with release ordering, so readers that see a published state also see the key.
+template <typename Key>
+class DisjointSetMap
+{
+    static_assert(std::is_integral_v<Key> && sizeof(Key) <= sizeof(std::uint64_t),
+                  "DisjointSetMap keys must be integral and at most 64 bits wide.");
+
+public:
+    // find() and sameSet() may be called from several threads at once.
+    static constexpr bool thread_safe_queries = true;
+
+    enum class OperationType
+    {
+        UNION_OP,
+        FIND_OP,
+        SAMESET_OP
+    };
+
+    // Operation on keys (same result convention as the dense engines).
+    struct Operation
+    {
+        OperationType type;
+        Key a;
+        Key b; // Ignored for FIND_OP
+    };
+
+    // Constructs a map able to hold up to 'capacity' distinct keys.
+    // Precondition: capacity >= 0
+    explicit DisjointSetMap(int capacity)
+        : max_keys(capacity),
+          table_size(table_size_for(capacity)),
+          slots(table_size),
+          keys_by_id(capacity > 0 ? capacity : 0),
+          uf(capacity > 0 ? capacity : 0)
+    {
+        if (capacity < 0)
+        {
+            throw std::invalid_argument("Capacity cannot be negative.");
+        }
+    }
+
+    // Returns the dense index of 'key', assigning the next free one on first sight.
+    // Throws std::length_error once more than capacity() distinct keys are seen.
+    int idOf(Key key)
+    {
+        const std::uint64_t k = static_cast<std::uint64_t>(key);
+        std::size_t slot = hash(k) & (table_size - 1);
+
+        while (true)
+        {
+            int state = slots[slot].state.load(std::memory_order_acquire);
+            if (state == 0)
+            {
+                if (slots[slot].state.compare_exchange_strong(state, CLAIMED, std::memory_order_acquire,
+                                                             std::memory_order_acquire))
+                {
+                    int id = next_id.fetch_add(1, std::memory_order_relaxed);
+                    if (id >= max_keys)
+                    {
+                        // Release the slot so threads waiting on it do not spin forever.
+                        slots[slot].state.store(0, std::memory_order_release);
+                        throw std::length_error("DisjointSetMap capacity exceeded.");
+                    }
+                    slots[slot].key = k;
+                    keys_by_id[id] = key;
+                    slots[slot].state.store(id + 1, std::memory_order_release);
+                    return id;
+                }
+                // Lost the race: 'state' now holds the winner's value; examine it below.
+            }
+            while (state == CLAIMED)
+            {
+                state = slots[slot].state.load(std::memory_order_acquire); // Winner is publishing.
+            }
+            if (state != 0 && slots[slot].key == k)
+            {
+                return state - 1;
+            }
+            if (state != 0)
+            {
+                slot = (slot + 1) & (table_size - 1); // Occupied by another key: linear probe.
+            }
+        }
+    }
+
+    // Returns the key that was assigned dense index 'id'.
+    // Precondition: 0 <= id < size()
+    Key keyOf(int id) const
+    {
+        return keys_by_id[id];
+    }
+
+    // Returns the representative key of the set containing 'key'.
+    Key find(Key key)
+    {
+        return keys_by_id[uf.find(idOf(key))];
+    }
+
+    // Merges the sets containing 'a' and 'b'. Returns true if a merge occurred.
+    bool unionSets(Key a, Key b)
+    {
+        return uf.unionSets(idOf(a), idOf(b));
+    }
+
+    // Checks if 'a' and 'b' are in the same set.
+    bool sameSet(Key a, Key b)
+    {
+        return uf.sameSet(idOf(a), idOf(b));
+    }
+
+    // Translates the keys of all operations to dense indices in parallel, then runs
+    // the batch on the lock-free engine. Results follow the engine's convention;
+    // for FIND_OP the result is the dense index of the root (see keyOf()).
+    // Throws std::length_error (before running any operation) if the batch brings
+    // more than capacity() distinct keys.
+    void processOperations(const std::vector<Operation>& ops, std::vector<int>& results)
+    {
+        std::vector<DenseOperation> dense_ops(ops.size());
+        std::atomic<bool> overflowed{false};
+
+        #pragma omp parallel for schedule(static)
+        for (std::size_t i = 0; i < ops.size(); i++)
+        {
+            const auto& op = ops[i];
+            try
+            {
+                dense_ops[i].type = static_cast<DenseOperationType>(op.type);
+                dense_ops[i].a = idOf(op.a);
+                dense_ops[i].b = op.type == OperationType::FIND_OP ? 0 : idOf(op.b);
+            }
+            catch (const std::length_error&)
+            {
+                overflowed.store(true, std::memory_order_relaxed); // Exceptions must not escape the parallel region.
+            }
+        }
+        if (overflowed.load(std::memory_order_relaxed))
+        {
+            throw std::length_error("DisjointSetMap capacity exceeded.");
+        }
+
+        uf.processOperations(dense_ops, results);
+    }
+
+    // Number of distinct keys assigned so far.
+    int size() const
+    {
+        int assigned = next_id.load(std::memory_order_relaxed);
+        return assigned < max_keys ? assigned : max_keys;
+    }
+
+    // Maximum number of distinct keys.
+    int capacity() const
+    {
+        return max_keys;
+    }
+
+    // Engine statistics restricted to the assigned ids; bytes include the key table.
+    // Unassigned ids are always rank-0 singleton roots, so they are subtracted exactly.
+    UnionFindStats introspect() const
+    {
+        UnionFindStats stats = uf.introspect();
+        std::uint64_t unused = static_cast<std::uint64_t>(stats.elements - size());
+        stats.elements = size();
+        if (unused > 0)
+        {
+            stats.components -= static_cast<int>(unused);
+            stats.depth_histogram[0] -= unused;
+            stats.rank_histogram[0] -= unused;
+            stats.size_histogram[0] -= unused;
+            double depth_sum = stats.mean_depth * (stats.elements + unused);
+            stats.mean_depth = stats.elements == 0 ? 0.0 : depth_sum / stats.elements;
+            if (stats.components == 0)
+            {
+                stats.largest_component = 0;
+            }
+        }
+        stats.bytes += sizeof(*this) - sizeof(uf) + slots.allocatedBytes() + keys_by_id.allocatedBytes();
+        return stats;
+    }
+
+    // The dense engine (indices are the ids returned by idOf()).
+    UnionFindParallelLockFree& engine()
+    {
+        return uf;
+    }
+
+    ~DisjointSetMap() = default;
+
+    DisjointSetMap(const DisjointSetMap&) = delete;
+    DisjointSetMap& operator=(const DisjointSetMap&) = delete;
+    DisjointSetMap(DisjointSetMap&&) = delete;
+    DisjointSetMap& operator=(DisjointSetMap&&) = delete;
+
+private:
+    using DenseOperation = UnionFindParallelLockFree::Operation;
+    using DenseOperationType = UnionFindParallelLockFree::OperationType;
+
+    static constexpr int CLAIMED = -1;
+
+    // State and key side by side, so a probe touches one cache line.
+    struct Slot
+    {
+        std::atomic<int> state;
+        std::uint64_t key;
+    };
+
+    // Power of two with load factor <= 0.5.
+    static std::size_t table_size_for(int capacity)
+    {
+        std::size_t size = 16;
+        while (capacity > 0 && size < 2 * static_cast<std::size_t>(capacity))
+        {
+            size <<= 1;
+        }
+        return size;
+    }
+
+    // splitmix64 finalizer: sequential ids and raw hashes both spread evenly.
+    static inline std::uint64_t hash(std::uint64_t x)
+    {
+        x ^= x >> 30;
+        x *= 0xbf58476d1ce4e5b9ULL;
+        x ^= x >> 27;
+        x *= 0x94d049bb133111ebULL;
+        x ^= x >> 31;
+        return x;
+    }
+
+    int max_keys;
+    std::size_t table_size;
+    ZeroedBuffer<Slot> slots;
+    ZeroedBuffer<Key> keys_by_id;
+    std::atomic<int> next_id{0};
+    UnionFindParallelLockFree uf;
+};
+
+#endif // DISJOINT_SET_MAP_HPP
@@ -0,0 +1,579 @@
+#ifndef DURABLE_UNION_FIND_HPP
+#define DURABLE_UNION_FIND_HPP
+
+#include <vector>
+#include <string>
+#include <atomic>
+#include <chrono>
+#include <mutex>
+#include <condition_variable>
+#include <thread>
+#include <memory>
+#include <cerrno>
+#include <cstdint>
+#include <cstddef>
+#include <cstring>
+#include <stdexcept>
+#include <omp.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <sys/stat.h>
+#include <sys/uio.h>
+#include <climits>    // For IOV_MAX
+#include <algorithm>  // For std::min
+
+// --- Durable Union-Find (write-ahead log + snapshot) ---
+
+// Optional durability layer around any Union-Find engine. Two files live in 'dir':
+//   snapshot -> header + the root of every element at the last checkpoint()
+//   wal      -> header + one (a, b) record per successful union since then
+// Successful unions are appended to per-thread in-memory buffers (no shared
+// cursor on the hot path). A flusher thread wakes every 'commit_interval',
+// gathers all buffers into one sequential write and issues a single fdatasync
+// (group commit), so a union is durable at most one interval after it returns.
+// sync() forces the same commit on the calling thread.
+//
+// Union is commutative and idempotent, so replaying the records in any order,
+// or more than once, gives the same partition. That is why the buffers need no
+// global order, and why a crash between installing the snapshot and truncating
+// the log is harmless. checkpoint() fsyncs the directory after the rename and
+// before the truncate, so the truncate can never be durable without the rename.
+//
+// On construction the snapshot and then the log are replayed into a fresh
+// engine; a torn record at the end of the log is dropped.
+//
+// UF must provide: UF(int), int find(int), bool unionSets(int, int),
+// processOperations(ops, results) with result 1 for a union that merged.
+template <typename UF>
+class DurableUnionFind
+{
+public:
+    using Operation = typename UF::Operation;
+    using OperationType = typename UF::OperationType;
+
+    // Opens (or creates) the log in 'dir' and recovers the state it records.
+    // Throws std::runtime_error on I/O errors or if the files were written for another n.
+    DurableUnionFind(int n, const std::string& dir,
+                     std::chrono::milliseconds commit_interval = std::chrono::milliseconds(5))
+        : uf(n),
+          num_elements(n),
+          dir_path(dir),
+          snapshot_path(dir + "/snapshot"),
+          wal_path(dir + "/wal"),
+          commit_interval(commit_interval),
+          buffers(omp_get_max_threads() > 0 ? omp_get_max_threads() : 1),
+          pending(buffers.size())
+    {
+        for (auto& b : buffers)
+        {
+            b = std::make_unique<LogBuffer>();
+        }
+        recover_snapshot();
+        open_and_replay_wal();
+        flusher = std::thread([this] { run_flusher(); });
+    }
+
+    // Commits any buffered unions, stops the flusher and closes the log.
+    ~DurableUnionFind()
+    {
+        {
+            std::lock_guard<std::mutex> lock(wake_mutex);
+            running = false;
+        }
+        wake.notify_one();
+        flusher.join();
+        try
+        {
+            commit();
+        }
+        catch (...)
+        {
+            // Nothing can be reported from a destructor; call sync() first to see errors.
+        }
+        ::close(wal_fd);
+    }
+
+    DurableUnionFind(const DurableUnionFind&) = delete;
+    DurableUnionFind& operator=(const DurableUnionFind&) = delete;
+    DurableUnionFind(DurableUnionFind&&) = delete;
+    DurableUnionFind& operator=(DurableUnionFind&&) = delete;
+
+    int find(int x)
+    {
+        return uf.find(x);
+    }
+
+    bool sameSet(int a, int b)
+    {
+        return uf.sameSet(a, b);
+    }
+
+    // Merges the sets of 'a' and 'b'; a merge is logged and becomes durable with the next commit.
+    bool unionSets(int a, int b)
+    {
+        bool merged = uf.unionSets(a, b);
+        if (merged)
+        {
+            log_union(a, b);
+        }
+        return merged;
+    }
+
+    // Runs the batch on the engine, then logs every union that merged.
+    void processOperations(const std::vector<Operation>& ops, std::vector<int>& results)
+    {
+        uf.processOperations(ops, results);
+
+        #pragma omp parallel
+        {
+            // Collect locally, then take the buffer lock once per thread.
+            std::vector<Record> local;
+            #pragma omp for schedule(static) nowait
+            for (std::size_t i = 0; i < ops.size(); i++)
+            {
+                if (ops[i].type == OperationType::UNION_OP && results[i] == 1)
+                {
+                    local.push_back(Record{ops[i].a, ops[i].b});
+                }
+                else if constexpr (requires { OperationType::RANGE_UNION_OP; })
+                {
+                    // The log only holds pairs: a range becomes its chain of neighbours
+                    // (replay is idempotent, so pairs another range covered are harmless).
+                    if (ops[i].type == OperationType::RANGE_UNION_OP && results[i] == 1)
+                    {
+                        int l = std::min(ops[i].a, ops[i].b);
+                        int r = std::max(ops[i].a, ops[i].b);
+                        for (int k = l; k < r; k++)
+                        {
+                            local.push_back(Record{k, k + 1});
+                        }
+                    }
+                }
+            }
+            LogBuffer& buf = local_buffer();
+            std::lock_guard<std::mutex> lock(buf.mutex);
+            if (buf.records.empty())
+            {
+                buf.records.swap(local);
+            }
+            else
+            {
+                buf.records.insert(buf.records.end(), local.begin(), local.end());
+            }
+        }
+    }
+
+    // Blocks until every union logged so far is on stable storage.
+    // Throws std::runtime_error if the commit fails. Records of an earlier failed
+    // background commit are retried by this one, so once sync() returns they are durable too.
+    void sync()
+    {
+        std::lock_guard<std::mutex> lock(commit_mutex);
+        if (!commit_locked())
+        {
+            throw_commit_error();
+        }
+    }
+
+    // Writes a snapshot of the current partition and truncates the log.
+    // Buffered unions are committed to the log first, so if writing the snapshot
+    // fails they are still recovered from the log. Throws std::runtime_error on I/O errors.
+    // Precondition: no operation is in flight on this instance.
+    void checkpoint()
+    {
+        std::lock_guard<std::mutex> lock(commit_mutex);
+        if (!commit_locked())
+        {
+            throw_commit_error();
+        }
+
+        std::vector<std::int32_t> image(2 + static_cast<std::size_t>(num_elements));
+        image[0] = SNAPSHOT_MAGIC;
+        image[1] = num_elements;
+        for (int i = 0; i < num_elements; i++)
+        {
+            image[2 + i] = uf.find(i);
+        }
+
+        // Write-then-rename keeps the old snapshot valid until the new one is complete.
+        const std::string tmp_path = snapshot_path + ".tmp";
+        int fd = ::open(tmp_path.c_str(), O_WRONLY | O_CREAT | O_TRUNC, 0644);
+        if (fd < 0)
+        {
+            throw_io_error("open", tmp_path);
+        }
+        bool ok = write_all(fd, image.data(), image.size() * sizeof(std::int32_t)) && ::fsync(fd) == 0;
+        ::close(fd);
+        if (!ok || ::rename(tmp_path.c_str(), snapshot_path.c_str()) != 0)
+        {
+            throw_io_error("write", snapshot_path);
+        }
+
+        // The rename lives in the directory: make it durable before the log loses
+        // the records, or a crash could keep the empty log and the old snapshot.
+        int dir_fd = ::open(dir_path.c_str(), O_RDONLY | O_DIRECTORY);
+        if (dir_fd < 0)
+        {
+            throw_io_error("open", dir_path);
+        }
+        ok = ::fsync(dir_fd) == 0;
+        ::close(dir_fd);
+        if (!ok)
+        {
+            throw_io_error("sync", dir_path);
+        }
+
+        if (::ftruncate(wal_fd, WAL_HEADER_BYTES) != 0 || ::fdatasync(wal_fd) != 0)
+        {
+            throw_io_error("truncate", wal_path);
+        }
+    }
+
+    int size() const
+    {
+        return num_elements;
+    }
+
+    // The wrapped engine (reads only; unions made directly on it are not logged).
+    UF& engine()
+    {
+        return uf;
+    }
+
+    // Number of group commits (fdatasync calls) so far.
+    std::uint64_t commitCount() const
+    {
+        return commits.load(std::memory_order_relaxed);
+    }
+
+    // Number of union records written to the log so far.
+    std::uint64_t recordsLogged() const
+    {
+        return logged.load(std::memory_order_relaxed);
+    }
+
+private:
+    static constexpr std::int32_t WAL_MAGIC = 0x4c575546;      // "FUWL"
+    static constexpr std::int32_t SNAPSHOT_MAGIC = 0x53575546; // "FUWS"
+    static constexpr off_t WAL_HEADER_BYTES = 2 * sizeof(std::int32_t);
+
+    struct Record
+    {
+        std::int32_t a;
+        std::int32_t b;
+    };
+
+    // One buffer per OpenMP thread; the mutex is only contended during a commit
+    // or when threads outside an OpenMP team share buffer 0.
+    struct alignas(64) LogBuffer
+    {
+        std::mutex mutex;
+        std::vector<Record> records;
+    };
+
+    LogBuffer& local_buffer()
+    {
+        return *buffers[static_cast<std::size_t>(omp_get_thread_num()) % buffers.size()];
+    }
+
+    void log_union(int a, int b)
+    {
+        LogBuffer& buf = local_buffer();
+        std::lock_guard<std::mutex> lock(buf.mutex);
+        buf.records.push_back(Record{a, b});
+    }
+
+    void commit()
+    {
+        std::lock_guard<std::mutex> lock(commit_mutex);
+        commit_locked();
+    }
+
+    // Gathers every buffer into one gathered write (writev) followed by one fdatasync.
+    // Buffers are swapped out, not copied, so threads keep appending while the write runs
+    // and get the drained vectors (with their capacity) back on the next commit.
+    // On failure the log is cut back to its size before the write, so a partly
+    // written record cannot shift the records of the retry off their boundaries,
+    // and the records go back to the front of their buffers for the next commit.
+    // If the cut fails too, the log is marked unusable and no later commit writes
+    // to it. Returns false on failure. Caller holds commit_mutex.
+    bool commit_locked()
+    {
+        if (wal_unusable)
+        {
+            return false;
+        }
+        std::vector<struct iovec> iov;
+        std::size_t count = 0;
+        for (std::size_t i = 0; i < buffers.size(); i++)
+        {
+            {
+                std::lock_guard<std::mutex> buffer_lock(buffers[i]->mutex);
+                pending[i].swap(buffers[i]->records);
+            }
+            if (!pending[i].empty())
+            {
+                iov.push_back({pending[i].data(), pending[i].size() * sizeof(Record)});
+                count += pending[i].size();
+            }
+        }
+        if (count == 0)
+        {
+            return true;
+        }
+        struct stat st;
+        if (::fstat(wal_fd, &st) != 0)
+        {
+            st.st_size = -1;
+        }
+        bool ok = st.st_size >= 0 && writev_all(wal_fd, iov) && ::fdatasync(wal_fd) == 0;
+        if (!ok && st.st_size >= 0 && ::ftruncate(wal_fd, st.st_size) != 0)
+        {
+            wal_unusable = true;
+        }
+        for (std::size_t i = 0; i < buffers.size(); i++)
+        {
+            if (!ok && !pending[i].empty())
+            {
+                std::lock_guard<std::mutex> buffer_lock(buffers[i]->mutex);
+                buffers[i]->records.insert(buffers[i]->records.begin(), pending[i].begin(), pending[i].end());
+            }
+            pending[i].clear();
+        }
+        if (!ok)
+        {
+            return false;
+        }
+        logged.fetch_add(count, std::memory_order_relaxed);
+        commits.fetch_add(1, std::memory_order_relaxed);
+        return true;
+    }
+
+    void run_flusher()
+    {
+        std::unique_lock<std::mutex> lock(wake_mutex);
+        while (running)
+        {
+            wake.wait_for(lock, commit_interval);
+            lock.unlock();
+            commit();
+            lock.lock();
+        }
+    }
+
+    void recover_snapshot()
+    {
+        std::vector<char> bytes;
+        if (!read_file(snapshot_path, bytes))
+        {
+            return; // No checkpoint yet.
+        }
+        std::size_t expected = (2 + static_cast<std::size_t>(num_elements)) * sizeof(std::int32_t);
+        std::int32_t header[2] = {0, 0};
+        if (bytes.size() >= sizeof(header))
+        {
+            std::memcpy(header, bytes.data(), sizeof(header));
+        }
+        if (bytes.size() != expected || header[0] != SNAPSHOT_MAGIC || header[1] != num_elements)
+        {
+            throw std::runtime_error("DurableUnionFind: " + snapshot_path + " is corrupt or was written for another size.");
+        }
+        for (int i = 0; i < num_elements; i++)
+        {
+            std::int32_t root;
+            std::memcpy(&root, bytes.data() + (2 + static_cast<std::size_t>(i)) * sizeof(std::int32_t), sizeof(root));
+            if (root < 0 || root >= num_elements)
+            {
+                throw std::runtime_error("DurableUnionFind: " + snapshot_path + " holds an out-of-range root.");
+            }
+            if (root != i)
+            {
+                uf.unionSets(i, root);
+            }
+        }
+    }
+
+    void open_and_replay_wal()
+    {
+        std::vector<char> bytes;
+        bool existed = read_file(wal_path, bytes);
+        // A log torn inside its header holds no records: start over with a fresh header.
+        bool fresh = !existed || bytes.size() < static_cast<std::size_t>(WAL_HEADER_BYTES);
+
+        std::size_t count = 0;
+        if (!fresh)
+        {
+            std::int32_t header[2];
+            std::memcpy(header, bytes.data(), sizeof(header));
+            if (header[0] != WAL_MAGIC || header[1] != num_elements)
+            {
+                throw std::runtime_error("DurableUnionFind: " + wal_path + " is corrupt or was written for another size.");
+            }
+
+            count = (bytes.size() - WAL_HEADER_BYTES) / sizeof(Record);
+            for (std::size_t r = 0; r < count; r++)
+            {
+                Record rec;
+                std::memcpy(&rec, bytes.data() + WAL_HEADER_BYTES + r * sizeof(Record), sizeof(rec));
+                if (rec.a < 0 || rec.a >= num_elements || rec.b < 0 || rec.b >= num_elements)
+                {
+                    throw std::runtime_error("DurableUnionFind: " + wal_path + " holds an out-of-range record.");
+                }
+                uf.unionSets(rec.a, rec.b);
+            }
+        }
+
+        wal_fd = ::open(wal_path.c_str(), O_WRONLY | O_CREAT | O_APPEND, 0644);
+        if (wal_fd < 0)
+        {
+            throw_io_error("open", wal_path);
+        }
+
+        bool ok;
+        if (fresh)
+        {
+            const std::int32_t header[2] = {WAL_MAGIC, num_elements};
+            ok = ::ftruncate(wal_fd, 0) == 0 && write_all(wal_fd, header, sizeof(header)) && ::fdatasync(wal_fd) == 0;
+        }
+        else
+        {
+            // Drop a torn tail so new records start on a record boundary.
+            std::size_t valid = WAL_HEADER_BYTES + count * sizeof(Record);
+            ok = valid == bytes.size() || ::ftruncate(wal_fd, static_cast<off_t>(valid)) == 0;
+        }
+        if (!ok)
+        {
+            int saved = errno;
+            ::close(wal_fd);
+            errno = saved;
+            throw_io_error("initialize", wal_path);
+        }
+    }
+
+    // Reads a whole file; returns false if it does not exist.
+    static bool read_file(const std::string& path, std::vector<char>& bytes)
+    {
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0)
+        {
+            if (errno == ENOENT)
+            {
+                return false;
+            }
+            throw_io_error("open", path);
+        }
+        struct stat st;
+        if (::fstat(fd, &st) != 0)
+        {
+            ::close(fd);
+            throw_io_error("stat", path);
+        }
+        bytes.resize(static_cast<std::size_t>(st.st_size));
+        std::size_t done = 0;
+        while (done < bytes.size())
+        {
+            ssize_t r = ::read(fd, bytes.data() + done, bytes.size() - done);
+            if (r < 0 && errno == EINTR)
+            {
+                continue;
+            }
+            if (r <= 0)
+            {
+                ::close(fd);
+                throw_io_error("read", path);
+            }
+            done += static_cast<std::size_t>(r);
+        }
+        ::close(fd);
+        return true;
+    }
+
+    static bool writev_all(int fd, std::vector<struct iovec>& iov)
+    {
+        std::size_t first = 0;
+        while (first < iov.size())
+        {
+            int n = static_cast<int>(std::min<std::size_t>(iov.size() - first, IOV_MAX));
+            ssize_t w = ::writev(fd, iov.data() + first, n);
+            if (w < 0 && errno == EINTR)
+            {
+                continue;
+            }
+            if (w <= 0)
+            {
+                return false;
+            }
+            // Skip what was written; a short write resumes mid-vector.
+            std::size_t done = static_cast<std::size_t>(w);
+            while (first < iov.size() && done >= iov[first].iov_len)
+            {
+                done -= iov[first].iov_len;
+                first++;
+            }
+            if (done > 0)
+            {
+                iov[first].iov_base = static_cast<char*>(iov[first].iov_base) + done;
+                iov[first].iov_len -= done;
+            }
+        }
+        return true;
+    }
+
+    static bool write_all(int fd, const void* data, std::size_t len)
+    {
+        const char* p = static_cast<const char*>(data);
+        while (len > 0)
+        {
+            ssize_t w = ::write(fd, p, len);
+            if (w < 0 && errno == EINTR)
+            {
+                continue;
+            }
+            if (w <= 0)
+            {
+                return false;
+            }
+            p += w;
+            len -= static_cast<std::size_t>(w);
+        }
+        return true;
+    }
+
+    // Caller holds commit_mutex and commit_locked() just failed.
+    [[noreturn]] void throw_commit_error() const
+    {
+        if (wal_unusable)
+        {
+            throw std::runtime_error("DurableUnionFind: " + wal_path + " is unusable: a failed write could not be cut back.");
+        }
+        throw_io_error("write", wal_path);
+    }
+
+    [[noreturn]] static void throw_io_error(const char* what, const std::string& path)
+    {
+        throw std::runtime_error(std::string("DurableUnionFind: cannot ") + what + " " + path + ": " + std::strerror(errno));
+    }
+
+    UF uf;
+    int num_elements;
+    std::string dir_path;
+    std::string snapshot_path;
+    std::string wal_path;
+    std::chrono::milliseconds commit_interval;
+    int wal_fd = -1;
+    bool wal_unusable = false;    // A failed write could not be cut back; guarded by commit_mutex
+
+    std::vector<std::unique_ptr<LogBuffer>> buffers;
+    std::vector<std::vector<Record>> pending; // Drained buffers during commit(), guarded by commit_mutex
+    std::mutex commit_mutex;      // Serializes commits and checkpoints
+
+    std::mutex wake_mutex;
+    std::condition_variable wake;
+    bool running = true;          // Guarded by wake_mutex
+    std::thread flusher;
+
+    std::atomic<std::uint64_t> commits{0};
+    std::atomic<std::uint64_t> logged{0};
+};
+
+#endif // DURABLE_UNION_FIND_HPP
@@ -0,0 +1,338 @@
+#ifndef HOT_ELEMENT_PROFILER_HPP
+#define HOT_ELEMENT_PROFILER_HPP
+
+#include <vector>
+#include <string>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <thread>
+#include <unordered_map>
+#include <algorithm>
+#include <cstdint>
+#include <cstddef>
+#include <ostream>
+#include <iomanip>
+#include <stdexcept>
+
+// --- Hot Element / Hot Root Profiler ---
+
+// Optional sampling profiler for the lock-free engines (setProfiler(&profiler)).
+// It answers "which elements and roots are hot, and how much of the CAS
+// contention do they cause" for a real trace, to back decisions such as
+// relocating, combining or sharding hot sets.
+//
+// Each thread keeps its own count-min sketches (no shared writes on the hot path):
+//   element accesses   operands of find/union/sameSet      (sampled, 1 in sample_period)
+//   root accesses      roots those operations resolved to  (sampled, same counter)
+//   CAS failures       roots of a union whose link CAS lost (every failure; already the slow path)
+// plus a small list of heavy-hitter candidates per sketch. report() merges the
+// sketches cell by cell, re-estimates every candidate against the merged sketch
+// and returns the top k. Sampled counts are scaled by sample_period, so all
+// counts are estimates; count-min only ever over-estimates.
+class HotElementProfiler
+{
+public:
+    struct HotEntry
+    {
+        int id;
+        std::uint64_t accesses;      // Estimated accesses (scaled by the sample period)
+        std::uint64_t cas_failures;  // Estimated link-CAS failures involving this root (at most the total)
+        double failure_share;        // cas_failures / total CAS failures
+    };
+
+    struct Report
+    {
+        std::vector<HotEntry> roots;     // Top-k roots by accesses
+        std::vector<HotEntry> elements;  // Top-k elements by accesses
+        std::uint64_t total_accesses;    // Estimated operand accesses
+        std::uint64_t total_cas_failures;
+        double top_roots_failure_share;  // Share of CAS failures involving a top-k root
+        int sample_period;
+    };
+
+    // sample_period: one access in sample_period is recorded (>= 1).
+    // width/depth: count-min dimensions (width rounded up to a power of two).
+    explicit HotElementProfiler(int sample_period = 64, int width = 1 << 12, int depth = 4)
+        : period(sample_period), depth(depth), id(next_id().fetch_add(1, std::memory_order_relaxed))
+    {
+        if (sample_period < 1 || width < 1 || depth < 1 || depth > MAX_DEPTH)
+        {
+            throw std::invalid_argument("Invalid profiler parameters.");
+        }
+        this->width = 1;
+        while (this->width < width)
+        {
+            this->width <<= 1;
+        }
+    }
+
+    HotElementProfiler(const HotElementProfiler&) = delete;
+    HotElementProfiler& operator=(const HotElementProfiler&) = delete;
+
+    // An operation touched 'element', whose root was 'root'.
+    inline void noteAccess(int element, int root)
+    {
+        Local& l = local();
+        if (++l.tick < static_cast<std::uint32_t>(period))
+        {
+            return;
+        }
+        l.tick = 0;
+        l.accesses++;
+        update(l.elements, l.element_candidates, element);
+        update(l.roots, l.root_candidates, root);
+    }
+
+    // A union's link CAS between 'root_a' and 'root_b' failed.
+    inline void noteCasFailure(int root_a, int root_b)
+    {
+        Local& l = local();
+        l.failures++;
+        add(l.cas, root_a);
+        if (root_b != root_a)
+        {
+            add(l.cas, root_b);
+        }
+    }
+
+    // Merges all threads and returns the k hottest roots and elements.
+    // Precondition: no profiled operation is running.
+    Report report(std::size_t k) const
+    {
+        std::lock_guard<std::mutex> lock(registry_mutex);
+        Sketch elements(width, depth), roots(width, depth), cas(width, depth);
+        std::vector<int> element_ids, root_ids;
+        std::uint64_t accesses = 0, failures = 0;
+        for (const auto& l : locals)
+        {
+            elements.merge(l->elements);
+            roots.merge(l->roots);
+            cas.merge(l->cas);
+            accesses += l->accesses;
+            failures += l->failures;
+            for (const auto& c : l->element_candidates)
+            {
+                element_ids.push_back(c.first);
+            }
+            for (const auto& c : l->root_candidates)
+            {
+                root_ids.push_back(c.first);
+            }
+        }
+
+        Report r;
+        r.total_accesses = accesses * period;
+        r.total_cas_failures = failures;
+        r.sample_period = period;
+        r.roots = top_k(root_ids, roots, cas, failures, k);
+        r.elements = top_k(element_ids, elements, cas, failures, k);
+        std::uint64_t top_failures = 0;
+        for (const auto& e : r.roots)
+        {
+            top_failures += e.cas_failures;
+        }
+        // Failures are counted on both roots of a pair, so clamp the share of the set.
+        r.top_roots_failure_share = failures == 0 ? 0.0 : std::min(1.0, static_cast<double>(top_failures) / failures);
+        return r;
+    }
+
+    // Prints the report as two fixed-width tables.
+    static void printTable(std::ostream& out, const Report& r)
+    {
+        out << "Hot roots (top " << r.roots.size() << ", sampled 1/" << r.sample_period << ", ~"
+            << r.total_accesses << " accesses, " << r.total_cas_failures << " CAS failures):" << std::endl;
+        print_rows(out, r.roots);
+        out << "Top roots involved in " << std::fixed << std::setprecision(1) << 100.0 * r.top_roots_failure_share
+            << " % of CAS failures" << std::endl;
+        out << "Hot elements (top " << r.elements.size() << "):" << std::endl;
+        print_rows(out, r.elements);
+    }
+
+    // Writes the report as one JSON object.
+    static void writeJson(std::ostream& out, const Report& r)
+    {
+        out << "{\"sample_period\":" << r.sample_period << ",\"total_accesses\":" << r.total_accesses
+            << ",\"total_cas_failures\":" << r.total_cas_failures
+            << ",\"top_roots_failure_share\":" << r.top_roots_failure_share
+            << ",\"roots\":";
+        write_entries(out, r.roots);
+        out << ",\"elements\":";
+        write_entries(out, r.elements);
+        out << "}" << std::endl;
+    }
+
+private:
+    static constexpr int MAX_DEPTH = 8;
+    static constexpr std::size_t CANDIDATES = 64; // Heavy-hitter candidates per thread and sketch
+
+    struct Sketch
+    {
+        Sketch(int width, int depth) : width(width), depth(depth), cells(static_cast<std::size_t>(width) * depth, 0) {}
+
+        void merge(const Sketch& other)
+        {
+            for (std::size_t i = 0; i < cells.size(); i++)
+            {
+                cells[i] += other.cells[i];
+            }
+        }
+
+        int width;
+        int depth;
+        std::vector<std::uint64_t> cells; // depth rows of width counters
+    };
+
+    struct Local
+    {
+        Local(int width, int depth) : elements(width, depth), roots(width, depth), cas(width, depth) {}
+
+        Sketch elements;
+        Sketch roots;
+        Sketch cas;
+        std::unordered_map<int, std::uint64_t> element_candidates; // id -> estimate when last seen
+        std::unordered_map<int, std::uint64_t> root_candidates;
+        std::uint32_t tick = 0;
+        std::uint64_t accesses = 0; // Sampled accesses
+        std::uint64_t failures = 0;
+    };
+
+    static std::atomic<std::uint64_t>& next_id()
+    {
+        static std::atomic<std::uint64_t> id{1};
+        return id;
+    }
+
+    // Row-specific multiplicative hash (odd multipliers, top bits).
+    static inline std::size_t cell(const Sketch& s, int row, int x)
+    {
+        static constexpr std::uint64_t MULT[MAX_DEPTH] = {
+            0x9e3779b97f4a7c15ULL, 0xbf58476d1ce4e5b9ULL, 0x94d049bb133111ebULL, 0xd6e8feb86659fd93ULL,
+            0xa0761d6478bd642fULL, 0xe7037ed1a0b428dbULL, 0x8ebc6af09c88c6e3ULL, 0x589965cc75374cc3ULL};
+        std::uint64_t h = (static_cast<std::uint64_t>(static_cast<std::uint32_t>(x)) + 1) * MULT[row];
+        return static_cast<std::size_t>(row) * s.width + static_cast<std::size_t>(h >> 32) % s.width;
+    }
+
+    static inline void add(Sketch& s, int x)
+    {
+        for (int row = 0; row < s.depth; row++)
+        {
+            s.cells[cell(s, row, x)]++;
+        }
+    }
+
+    static inline std::uint64_t estimate(const Sketch& s, int x)
+    {
+        std::uint64_t est = UINT64_MAX;
+        for (int row = 0; row < s.depth; row++)
+        {
+            est = std::min(est, s.cells[cell(s, row, x)]);
+        }
+        return est;
+    }
+
+    // Adds x and keeps it as a candidate if it is among the thread's hottest.
+    static void update(Sketch& s, std::unordered_map<int, std::uint64_t>& candidates, int x)
+    {
+        add(s, x);
+        std::uint64_t est = estimate(s, x);
+        auto it = candidates.find(x);
+        if (it != candidates.end())
+        {
+            it->second = est;
+            return;
+        }
+        if (candidates.size() < CANDIDATES)
+        {
+            candidates.emplace(x, est);
+            return;
+        }
+        auto coldest = std::min_element(candidates.begin(), candidates.end(),
+                                        [](const auto& l, const auto& r) { return l.second < r.second; });
+        if (est > coldest->second)
+        {
+            candidates.erase(coldest);
+            candidates.emplace(x, est);
+        }
+    }
+
+    std::vector<HotEntry> top_k(std::vector<int>& ids, const Sketch& accesses, const Sketch& cas,
+                                std::uint64_t failures, std::size_t k) const
+    {
+        std::sort(ids.begin(), ids.end());
+        ids.erase(std::unique(ids.begin(), ids.end()), ids.end());
+        std::vector<HotEntry> entries;
+        entries.reserve(ids.size());
+        for (int x : ids)
+        {
+            // A root is in at most every failure once, so clamp the sketch's over-estimate.
+            std::uint64_t fails = std::min(estimate(cas, x), failures);
+            entries.push_back(HotEntry{x, estimate(accesses, x) * period, fails,
+                                       failures == 0 ? 0.0 : static_cast<double>(fails) / failures});
+        }
+        std::sort(entries.begin(), entries.end(),
+                  [](const HotEntry& l, const HotEntry& r) { return l.accesses > r.accesses || (l.accesses == r.accesses && l.id < r.id); });
+        if (entries.size() > k)
+        {
+            entries.resize(k);
+        }
+        return entries;
+    }
+
+    static void print_rows(std::ostream& out, const std::vector<HotEntry>& entries)
+    {
+        out << "  " << std::setw(4) << "#" << std::setw(12) << "id" << std::setw(14) << "accesses"
+            << std::setw(14) << "CAS fails" << std::setw(10) << "share" << std::endl;
+        for (std::size_t i = 0; i < entries.size(); i++)
+        {
+            const HotEntry& e = entries[i];
+            out << "  " << std::setw(4) << i + 1 << std::setw(12) << e.id << std::setw(14) << e.accesses
+                << std::setw(14) << e.cas_failures << std::setw(9) << std::fixed << std::setprecision(1)
+                << 100.0 * e.failure_share << "%" << std::endl;
+        }
+    }
+
+    static void write_entries(std::ostream& out, const std::vector<HotEntry>& entries)
+    {
+        out << "[";
+        for (std::size_t i = 0; i < entries.size(); i++)
+        {
+            const HotEntry& e = entries[i];
+            out << (i ? "," : "") << "{\"id\":" << e.id << ",\"accesses\":" << e.accesses
+                << ",\"cas_failures\":" << e.cas_failures << ",\"failure_share\":" << e.failure_share << "}";
+        }
+        out << "]";
+    }
+
+    // The calling thread's state, created on first use. A one-entry thread-local
+    // cache keyed by profiler id keeps the registry lock off the hot path.
+    Local& local()
+    {
+        thread_local std::uint64_t cached_id = 0;
+        thread_local Local* cached = nullptr;
+        if (cached_id == id)
+        {
+            return *cached;
+        }
+        std::lock_guard<std::mutex> lock(registry_mutex);
+        auto& slot = by_thread[std::this_thread::get_id()];
+        if (slot == nullptr)
+        {
+            locals.push_back(std::make_unique<Local>(width, depth));
+            slot = locals.back().get();
+        }
+        cached_id = id;
+        cached = slot;
+        return *slot;
+    }
+
+    int period;
+    int width;
+    int depth;
+    std::uint64_t id; // Unique per profiler, so thread-local caches never see a stale instance
+    mutable std::mutex registry_mutex;
+    std::vector<std::unique_ptr<Local>> locals;
+    std::unordered_map<std::thread::id, Local*> by_thread;
+};
+
+#endif // HOT_ELEMENT_PROFILER_HPP
@@ -0,0 +1,287 @@
+#ifndef MERGE_EVENT_STREAM_HPP
+#define MERGE_EVENT_STREAM_HPP
+
+#include <vector>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <thread>
+#include <unordered_map>
+#include <cstdint>
+#include <cstddef>
+#include <stdexcept>
+#include <utility>   // For std::swap
+
+// --- Merge Event Stream (change data capture) ---
+
+// One successful link: 'child' was a root and now points at root 'root'.
+// Both were roots of their components just before the link (the old roots), and
+// 'root' is the root of the merged component (the new root).
+//
+// Events carry no component sizes. The engine keeps ranks, not sizes, and a size
+// read at link time would race with links still landing in either component
+// (another thread's child may join 'child' just before this link and add to its
+// size after it). Sizes that are exact once the events are applied come from a
+// consumer instead: MergeIndex keeps them for every component.
+struct MergeEvent
+{
+    int root;
+    int child;
+};
+
+// Opt-in stream of merge events from UnionFindParallelLockFree
+// (setMergeEvents(&stream)). Every successful link appends one MergeEvent to
+// the calling thread's single-producer/single-consumer ring, so emission is a
+// store plus a release increment on a thread-owned line. When a ring is full the
+// event goes to a shared mutex-protected overflow list instead; no event is ever
+// dropped, but overflow means the consumer is not keeping up.
+//
+// Events from different threads are not ordered with respect to each other;
+// MergeIndex shows how to consume them regardless of order.
+class MergeEventStream
+{
+public:
+    // ring_capacity: events per producer thread before spilling (rounded up to a power of two).
+    explicit MergeEventStream(std::size_t ring_capacity = 1 << 16)
+        : id(next_id().fetch_add(1, std::memory_order_relaxed))
+    {
+        if (ring_capacity == 0)
+        {
+            throw std::invalid_argument("Ring capacity must be positive.");
+        }
+        capacity = 1;
+        while (capacity < ring_capacity)
+        {
+            capacity <<= 1;
+        }
+    }
+
+    MergeEventStream(const MergeEventStream&) = delete;
+    MergeEventStream& operator=(const MergeEventStream&) = delete;
+
+    // Producer side: called by the engine after a link CAS succeeded.
+    inline void emit(int root, int child)
+    {
+        Ring& ring = local();
+        std::uint64_t head = ring.head.load(std::memory_order_relaxed);
+        if (head - ring.cached_tail >= capacity)
+        {
+            ring.cached_tail = ring.tail.load(std::memory_order_acquire);
+            if (head - ring.cached_tail >= capacity)
+            {
+                std::lock_guard<std::mutex> lock(overflow_mutex);
+                overflow.push_back(MergeEvent{root, child});
+                overflowed.fetch_add(1, std::memory_order_relaxed);
+                return;
+            }
+        }
+        ring.events[head & (capacity - 1)] = MergeEvent{root, child};
+        ring.head.store(head + 1, std::memory_order_release);
+    }
+
+    // Consumer side: passes every event published so far to on_event(const MergeEvent&),
+    // ring by ring, then the overflow list. Returns the number of events delivered.
+    // One drain runs at a time (concurrent calls serialize); safe while producers run.
+    template <typename OnEvent>
+    std::size_t drain(OnEvent&& on_event)
+    {
+        std::lock_guard<std::mutex> consumer(consumer_mutex);
+        std::vector<Ring*> snapshot;
+        {
+            std::lock_guard<std::mutex> lock(registry_mutex);
+            snapshot.reserve(rings.size());
+            for (const auto& ring : rings)
+            {
+                snapshot.push_back(ring.get());
+            }
+        }
+
+        std::size_t delivered = 0;
+        for (Ring* ring : snapshot)
+        {
+            std::uint64_t tail = ring->tail.load(std::memory_order_relaxed);
+            std::uint64_t head = ring->head.load(std::memory_order_acquire);
+            for (std::uint64_t k = tail; k < head; k++)
+            {
+                on_event(ring->events[k & (capacity - 1)]);
+            }
+            ring->tail.store(head, std::memory_order_release); // Frees the slots for the producer
+            delivered += head - tail;
+        }
+
+        std::vector<MergeEvent> spilled;
+        {
+            std::lock_guard<std::mutex> lock(overflow_mutex);
+            std::swap(spilled, overflow);
+        }
+        for (const MergeEvent& e : spilled)
+        {
+            on_event(e);
+        }
+        delivered += spilled.size();
+        drained.fetch_add(delivered, std::memory_order_relaxed);
+        return delivered;
+    }
+
+    // Events that went to the overflow list because a ring was full.
+    std::uint64_t overflowCount() const
+    {
+        return overflowed.load(std::memory_order_relaxed);
+    }
+
+    // Events delivered by drain() so far.
+    std::uint64_t drainedCount() const
+    {
+        return drained.load(std::memory_order_relaxed);
+    }
+
+private:
+    // One per producer thread. Producer and consumer cursors sit on separate lines.
+    struct Ring
+    {
+        explicit Ring(std::size_t capacity) : events(capacity) {}
+
+        std::vector<MergeEvent> events;
+        alignas(64) std::atomic<std::uint64_t> head{0}; // Written by the producer only
+        std::uint64_t cached_tail = 0;                  // Producer's last view of 'tail'
+        alignas(64) std::atomic<std::uint64_t> tail{0}; // Written by the consumer only
+    };
+
+    static std::atomic<std::uint64_t>& next_id()
+    {
+        static std::atomic<std::uint64_t> id{1};
+        return id;
+    }
+
+    // The calling thread's ring, created on first use (same caching scheme as HotElementProfiler).
+    Ring& local()
+    {
+        thread_local std::uint64_t cached_id = 0;
+        thread_local Ring* cached = nullptr;
+        if (cached_id == id)
+        {
+            return *cached;
+        }
+        std::lock_guard<std::mutex> lock(registry_mutex);
+        auto& slot = by_thread[std::this_thread::get_id()];
+        if (slot == nullptr)
+        {
+            rings.push_back(std::make_unique<Ring>(capacity));
+            slot = rings.back().get();
+        }
+        cached_id = id;
+        cached = slot;
+        return *slot;
+    }
+
+    std::size_t capacity;
+    std::uint64_t id; // Unique per stream, so thread-local caches never see a stale instance
+    std::mutex registry_mutex;
+    std::vector<std::unique_ptr<Ring>> rings;
+    std::unordered_map<std::thread::id, Ring*> by_thread;
+    std::mutex overflow_mutex;
+    std::vector<MergeEvent> overflow;
+    std::atomic<std::uint64_t> overflowed{0};
+    std::mutex consumer_mutex;
+    std::atomic<std::uint64_t> drained{0};
+};
+
+// --- Merge Index (example consumer) ---
+
+// Incrementally maintained view of the engine's partition built only from merge
+// events: component sizes, component count and each component's current engine
+// root. It keeps its own serial union-find (union by size, path halving), so events
+// can be applied in any order: every element is a link's child at most once, so
+// the one element of a set not yet seen as a child is the engine root it
+// currently has.
+class MergeIndex
+{
+public:
+    explicit MergeIndex(int n)
+        : parent(n > 0 ? n : 0), sizes(n > 0 ? n : 0, 1), labels(n > 0 ? n : 0), num_components(n > 0 ? n : 0)
+    {
+        if (n < 0)
+        {
+            throw std::invalid_argument("Number of elements cannot be negative.");
+        }
+        for (int i = 0; i < n; i++)
+        {
+            parent[i] = i;
+            labels[i] = i;
+        }
+    }
+
+    // Applies one event and returns the size of the merged component.
+    int apply(const MergeEvent& e)
+    {
+        int r = find_set(e.root);
+        int c = find_set(e.child);
+        if (r == c)
+        {
+            return sizes[r]; // Not produced by the engine; ignore duplicates.
+        }
+        int label = labels[r];
+        if (sizes[r] < sizes[c])
+        {
+            std::swap(r, c);
+        }
+        parent[c] = r;
+        sizes[r] += sizes[c];
+        labels[r] = label;
+        num_components--;
+        return sizes[r];
+    }
+
+    // Drains 'stream' into the index; returns the number of events applied.
+    std::size_t update(MergeEventStream& stream)
+    {
+        return stream.drain([this](const MergeEvent& e) { apply(e); });
+    }
+
+    // Engine root of x's component, as of the events applied so far.
+    int find(int x)
+    {
+        return labels[find_set(x)];
+    }
+
+    int componentSize(int x)
+    {
+        return sizes[find_set(x)];
+    }
+
+    int components() const
+    {
+        return num_components;
+    }
+
+    // Calls f(root, size) once per component, with its engine root as in find().
+    template <typename F>
+    void forEachComponent(F&& f) const
+    {
+        for (int x = 0; x < static_cast<int>(parent.size()); x++)
+        {
+            if (parent[x] == x)
+            {
+                f(labels[x], sizes[x]);
+            }
+        }
+    }
+
+private:
+    int find_set(int x)
+    {
+        while (parent[x] != x)
+        {
+            parent[x] = parent[parent[x]];
+            x = parent[x];
+        }
+        return x;
+    }
+
+    std::vector<int> parent;
+    std::vector<int> sizes;
+    std::vector<int> labels; // Valid at set representatives
+    int num_components;
+};
+
+#endif // MERGE_EVENT_STREAM_HPP
@@ -0,0 +1,336 @@
+#ifndef QUERY_DEDUPLICATOR_HPP
+#define QUERY_DEDUPLICATOR_HPP
+
+#include <vector>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <climits>
+#include <algorithm>   // For std::min, std::max
+#include <type_traits>
+#include <omp.h>
+
+// --- Query Deduplicator ---
+
+// Batch front end that answers each distinct query of a query-only batch once.
+// Read-heavy batches often repeat the same find(a) / sameSet(a, b) many times,
+// and every copy walks the same path again.
+//
+// Every query is normalized to a 64-bit key (sameSet pairs are ordered, so
+// sameSet(a, b) and sameSet(b, a) share one answer). A query-only batch (FIND_OP
+// and SAMESET_OP only) then goes through four parallel phases:
+//   1. Partition: keys are scattered into 2^k buckets by the top bits of their hash
+//      (per-thread histograms, then offsets, as in one radix-sort pass). Buckets
+//      hold about BUCKET_TARGET queries, so their tables stay in L2.
+//   2. Dedup: each bucket is deduplicated by one thread with a private linear-probing
+//      table, which assigns every query the bucket-local index of its distinct key.
+//   3. Gather: after a prefix sum over the per-bucket counts, the distinct queries
+//      are rebuilt from their keys into one batch for UF::processOperations().
+//   4. Scatter: every position gets the result of its distinct query.
+// A single shared table would be simpler, but it has to be sized for the whole batch
+// and every insert misses the cache; the partition pass keeps the random accesses of
+// the dedup phase inside one bucket.
+//
+// The overhead is a few sequential passes per query, so deduplication pays off when
+// queries are expensive (large or uncompressed forests) and duplicates are common;
+// a cache-resident forest answers queries faster than the phases above cost.
+// No query modifies the partition, so the results are exactly those of running the
+// whole batch on the engine. Batches containing any other operation, or an element
+// index outside [0, size()), go to the engine unchanged (unions have to stay in
+// order, and the engine reports the bad indices).
+//
+// UF must provide: int size() const, the nested Operation/OperationType types with
+// FIND_OP and SAMESET_OP, and processOperations(ops, results).
+template <typename UF>
+class QueryDeduplicator
+{
+public:
+    using Operation = typename UF::Operation;
+    using OperationType = typename UF::OperationType;
+    static_assert(std::is_same_v<decltype(Operation::a), int>, "QueryDeduplicator needs dense int element ids.");
+
+    // Queries per bucket the partition pass aims for.
+    static constexpr std::size_t BUCKET_TARGET = 8192;
+
+    explicit QueryDeduplicator(UF& uf)
+        : uf(uf)
+    {
+    }
+
+    QueryDeduplicator(const QueryDeduplicator&) = delete;
+    QueryDeduplicator& operator=(const QueryDeduplicator&) = delete;
+
+    // Same contract and results as uf.processOperations(ops, results).
+    void processOperations(const std::vector<Operation>& ops, std::vector<int>& results)
+    {
+        const std::size_t m = ops.size();
+        if (!is_query_batch(ops))
+        {
+            last_unique = m;
+            last_deduplicated = false;
+            uf.processOperations(ops, results);
+            return;
+        }
+        reserve(m);
+
+        int bucket_bits = 0;
+        while (bucket_bits < 16 && (m >> bucket_bits) > BUCKET_TARGET)
+        {
+            bucket_bits++;
+        }
+        const std::size_t buckets = std::size_t{1} << bucket_bits;
+        bucket_begin.assign(buckets + 1, 0);
+        bucket_unique.assign(buckets + 1, 0);
+        scratch.resize(static_cast<std::size_t>(omp_get_max_threads()));
+
+        // Phase 1: partition by the top hash bits, stable within each thread's range.
+        #pragma omp parallel
+        {
+            const std::size_t threads = static_cast<std::size_t>(omp_get_num_threads());
+            const std::size_t tid = static_cast<std::size_t>(omp_get_thread_num());
+            const std::size_t begin = m * tid / threads;
+            const std::size_t end = m * (tid + 1) / threads;
+            #pragma omp single
+            bucket_counts.assign(threads * buckets, 0);
+            std::size_t* counts = &bucket_counts[tid * buckets];
+            for (std::size_t i = begin; i < end; i++)
+            {
+                const std::uint64_t h = hash(make_key(ops[i]));
+                hashes[i] = h;
+                counts[bucket_of(h, bucket_bits)]++;
+            }
+            #pragma omp barrier
+            #pragma omp single
+            {
+                std::size_t offset = 0;
+                for (std::size_t b = 0; b < buckets; b++)
+                {
+                    bucket_begin[b] = offset;
+                    for (std::size_t t = 0; t < threads; t++)
+                    {
+                        std::size_t count = bucket_counts[t * buckets + b];
+                        bucket_counts[t * buckets + b] = offset;
+                        offset += count;
+                    }
+                }
+                bucket_begin[buckets] = offset;
+            }
+            for (std::size_t i = begin; i < end; i++)
+            {
+                const std::uint64_t h = hashes[i];
+                entries[counts[bucket_of(h, bucket_bits)]++] =
+                    Entry{make_key(ops[i]), static_cast<std::uint32_t>(h), static_cast<std::uint32_t>(i)};
+            }
+        }
+
+        // Phase 2: deduplicate each bucket.
+        #pragma omp parallel for schedule(dynamic, 1)
+        for (std::size_t b = 0; b < buckets; b++)
+        {
+            bucket_unique[b + 1] = dedup_bucket(bucket_begin[b], bucket_begin[b + 1],
+                                                scratch[static_cast<std::size_t>(omp_get_thread_num())]);
+        }
+        for (std::size_t b = 0; b < buckets; b++)
+        {
+            bucket_unique[b + 1] += bucket_unique[b];
+        }
+        const std::size_t unique = bucket_unique[buckets];
+
+        // Phase 3: the first entry of each distinct key becomes its query.
+        unique_ops.resize(unique);
+        #pragma omp parallel for schedule(dynamic, 1)
+        for (std::size_t b = 0; b < buckets; b++)
+        {
+            const std::size_t base = bucket_unique[b];
+            for (std::size_t e = bucket_begin[b]; e < bucket_begin[b + 1]; e++)
+            {
+                const std::size_t local = static_cast<std::size_t>(entry_local[e]);
+                unique_of[entries[e].position] = static_cast<int>(base + local);
+                if (first_entry[bucket_begin[b] + local] == e)
+                {
+                    unique_ops[base + local] = query_of(entries[e].key);
+                }
+            }
+        }
+
+        uf.processOperations(unique_ops, unique_results);
+
+        // Phase 4: scatter the distinct results back to every position.
+        results.resize(m);
+        #pragma omp parallel for schedule(static)
+        for (std::size_t i = 0; i < m; i++)
+        {
+            results[i] = unique_results[unique_of[i]];
+        }
+        last_unique = unique;
+        last_deduplicated = true;
+    }
+
+    // Sizes the per-query buffers for batches of up to 'max_batch' queries, so the
+    // first such batch does not pay for allocating and faulting them in.
+    void reserve(std::size_t max_batch)
+    {
+        if (entries.size() < max_batch)
+        {
+            hashes.resize(max_batch);
+            entries.resize(max_batch);
+            entry_local.resize(max_batch);
+            first_entry.resize(max_batch);
+            unique_of.resize(max_batch);
+            unique_ops.reserve(max_batch);
+            unique_results.reserve(max_batch);
+        }
+    }
+
+    // Operations the engine ran for the last batch (its size if it was passed through).
+    std::size_t lastUniqueQueries() const
+    {
+        return last_unique;
+    }
+
+    // True if the last batch was query-only and went through the deduplication.
+    bool lastDeduplicated() const
+    {
+        return last_deduplicated;
+    }
+
+private:
+    struct Entry
+    {
+        std::uint64_t key;      // make_key(op); never 0
+        std::uint32_t probe;    // Low hash bits, the table start slot
+        std::uint32_t position; // Index of the query in the batch
+    };
+
+    // Per-thread bucket table, reused across buckets and batches. Only the slots a
+    // bucket claimed are cleared afterwards.
+    struct Scratch
+    {
+        std::vector<std::uint64_t> keys; // 0: empty slot
+        std::vector<int> local;          // Slot -> distinct key index within the bucket
+    };
+
+    // Fills entry_local for the bucket's entries and first_entry[begin + k] with the
+    // first entry of its k-th distinct key; returns the number of distinct keys.
+    std::size_t dedup_bucket(std::size_t begin, std::size_t end, Scratch& s)
+    {
+        std::size_t capacity = 16;
+        while (capacity < 2 * (end - begin))
+        {
+            capacity <<= 1;
+        }
+        if (s.keys.size() < capacity)
+        {
+            s.keys.resize(capacity, 0);
+            s.local.resize(capacity);
+        }
+        const std::size_t mask = capacity - 1;
+
+        int distinct = 0;
+        for (std::size_t e = begin; e < end; e++)
+        {
+            const std::uint64_t key = entries[e].key;
+            std::size_t slot = entries[e].probe & mask;
+            while (s.keys[slot] != 0 && s.keys[slot] != key)
+            {
+                slot = (slot + 1) & mask;
+            }
+            if (s.keys[slot] == 0)
+            {
+                s.keys[slot] = key;
+                s.local[slot] = distinct;
+                first_entry[begin + distinct] = e;
+                distinct++;
+            }
+            entry_local[e] = s.local[slot];
+        }
+        for (int k = 0; k < distinct; k++)
+        {
+            const Entry& first = entries[first_entry[begin + k]];
+            std::size_t slot = first.probe & mask;
+            while (s.keys[slot] != first.key)
+            {
+                slot = (slot + 1) & mask;
+            }
+            s.keys[slot] = 0;
+        }
+        return static_cast<std::size_t>(distinct);
+    }
+
+    // Query-only and in range; anything else is passed through.
+    bool is_query_batch(const std::vector<Operation>& ops) const
+    {
+        const int n = uf.size();
+        bool ok = ops.size() <= UINT32_MAX;
+        #pragma omp parallel for schedule(static) reduction(&& : ok)
+        for (std::size_t i = 0; i < ops.size(); i++)
+        {
+            const Operation& op = ops[i];
+            const bool find = op.type == OperationType::FIND_OP;
+            ok = ok && (find || op.type == OperationType::SAMESET_OP) &&
+                 op.a >= 0 && op.a < n && (find || (op.b >= 0 && op.b < n));
+        }
+        return ok;
+    }
+
+    // (a, 0xFFFFFFFF) for find(a); (min, max) + 1 for sameSet, which cannot carry
+    // into the upper half or reach 0 because ids are below 2^31.
+    static std::uint64_t make_key(const Operation& op)
+    {
+        if (op.type == OperationType::FIND_OP)
+        {
+            return (static_cast<std::uint64_t>(op.a) << 32) | 0xFFFFFFFFULL;
+        }
+        const std::uint64_t lo = static_cast<std::uint64_t>(std::min(op.a, op.b));
+        const std::uint64_t hi = static_cast<std::uint64_t>(std::max(op.a, op.b));
+        return ((lo << 32) | hi) + 1;
+    }
+
+    // Inverse of make_key().
+    static Operation query_of(std::uint64_t key)
+    {
+        Operation op{};
+        op.a = static_cast<int>(key >> 32);
+        if ((key & 0xFFFFFFFFULL) == 0xFFFFFFFFULL)
+        {
+            op.type = OperationType::FIND_OP;
+        }
+        else
+        {
+            op.type = OperationType::SAMESET_OP;
+            op.b = static_cast<int>((key - 1) & 0xFFFFFFFFULL);
+        }
+        return op;
+    }
+
+    // splitmix64 finalizer.
+    static std::uint64_t hash(std::uint64_t x)
+    {
+        x = (x ^ (x >> 30)) * 0xbf58476d1ce4e5b9ULL;
+        x = (x ^ (x >> 27)) * 0x94d049bb133111ebULL;
+        return x ^ (x >> 31);
+    }
+
+    // Top bits pick the bucket; the bucket tables probe from the low bits.
+    static std::size_t bucket_of(std::uint64_t h, int bucket_bits)
+    {
+        return bucket_bits == 0 ? 0 : static_cast<std::size_t>(h >> (64 - bucket_bits));
+    }
+
+    UF& uf;
+    std::vector<std::uint64_t> hashes;      // Per query, phase 1 only
+    std::vector<Entry> entries;             // Queries grouped by bucket
+    std::vector<int> entry_local;           // Per entry: distinct key index within its bucket
+    std::vector<std::size_t> first_entry;   // Per bucket, from its begin: first entry of each distinct key
+    std::vector<std::size_t> bucket_counts; // Per thread and bucket: count, then write offset
+    std::vector<std::size_t> bucket_begin;
+    std::vector<std::size_t> bucket_unique; // Prefix sums of the distinct keys per bucket
+    std::vector<int> unique_of;             // Per query: index of its distinct query
+    std::vector<Operation> unique_ops;
+    std::vector<int> unique_results;
+    std::vector<Scratch> scratch;
+    std::size_t last_unique = 0;
+    bool last_deduplicated = false;
+};
+
+#endif // QUERY_DEDUPLICATOR_HPP
@@ -0,0 +1,486 @@
+#ifndef REPLICATED_UNION_FIND_HPP
+#define REPLICATED_UNION_FIND_HPP
+
+#include <vector>
+#include <string>
+#include <memory>
+#include <atomic>
+#include <thread>
+#include <fstream>
+#include <sstream>
+#include <algorithm>
+#include <cstdint>
+#include <cstddef>
+#include <stdexcept>
+#include <omp.h>
+#include <sched.h>     // For sched_getcpu, cpu_set_t
+#include <pthread.h>   // For pthread_setaffinity_np
+#include "zeroed_buffer.hpp"
+
+// --- Replicated Union-Find (per-socket read copies) ---
+
+// Engine mode for query-dominated workloads on multi-socket hosts. Unions go to
+// one primary engine; every NUMA node also holds a replica of the flattened label
+// array (label[i] = the primary root of i at the replica's epoch), whose pages are
+// first touched by a thread pinned to that node. Queries read the replica of the
+// node they run on: one local load per operand instead of a path walk through
+// memory that is remote for half of the threads.
+//
+// Epochs: every union batch that merged something (and every successful single
+// unionSets()) advances the primary epoch. A replica is 'lag' epochs behind.
+//   - sameSet() answers true from the replica whenever the labels match: sets only
+//     merge, so equal labels at any epoch mean the same set now.
+//   - A false answer, and find(), come from the replica only if lag <= max_lag;
+//     otherwise from the primary. max_lag = 0 gives exactly the primary's answers.
+// processOperations() runs the batch's unions on the primary first, then its
+// queries (the engines already leave the order within a batch unspecified), and
+// refreshes the replicas in between whenever the lag would exceed max_lag, so a
+// batch's queries see replicas at most max_lag union batches old.
+//
+// Refresh is incremental: unions mark the labels they touch in a bitmap, and a
+// parallel scan re-resolves only elements whose label is marked. Refresh and
+// unions must not overlap (processOperations() guarantees this; call
+// refreshReplicas() only while no unions run). Queries may run during a refresh.
+//
+// The replica count defaults to the NUMA node count from sysfs (1 if unknown).
+// Batches with an element id outside [0, n) go to the engine unchanged (it reports
+// the bad ids); their merges still reach the replicas. find() and sameSet() with a
+// bad id go to the engine as well.
+//
+// The primary is read from several threads (refresh scan, stale-replica fallback)
+// only if UF declares thread_safe_queries; otherwise those reads run on one thread.
+//
+// UF must provide: UF(int), int find(int), bool sameSet(int, int), bool unionSets(int, int),
+// processOperations(ops, results) with result 1 for a union that merged.
+template <typename UF>
+class ReplicatedUnionFind
+{
+public:
+    using Operation = typename UF::Operation;
+    using OperationType = typename UF::OperationType;
+
+    // replicas: number of read copies (0 = one per NUMA node).
+    // max_lag: union batches a false sameSet() or a find() may lag behind the primary.
+    explicit ReplicatedUnionFind(int n, int replicas = 0, std::uint64_t max_lag = 0)
+        : uf(n), num_elements(n), lag_bound(max_lag), node_of_cpu(read_cpu_nodes()),
+          num_nodes(1 + *std::max_element(node_of_cpu.begin(), node_of_cpu.end())),
+          marked(static_cast<std::size_t>(n > 0 ? (n + 63) / 64 : 1))
+    {
+        if (n < 0 || replicas < 0)
+        {
+            throw std::invalid_argument("ReplicatedUnionFind: n and replicas cannot be negative.");
+        }
+        int count = replicas > 0 ? replicas : num_nodes;
+        for (int r = 0; r < count; r++)
+        {
+            copies.push_back(std::make_unique<Replica>(static_cast<std::size_t>(n)));
+            place_replica(r);
+        }
+    }
+
+    ReplicatedUnionFind(const ReplicatedUnionFind&) = delete;
+    ReplicatedUnionFind& operator=(const ReplicatedUnionFind&) = delete;
+
+    int find(int a)
+    {
+        if (!in_range(a))
+        {
+            return uf.find(a);
+        }
+        Replica& replica = local_replica();
+        if (lag(replica) <= lag_bound)
+        {
+            replica_answers.fetch_add(1, std::memory_order_relaxed);
+            return replica.labels[a].load(std::memory_order_relaxed);
+        }
+        return uf.find(a);
+    }
+
+    bool sameSet(int a, int b)
+    {
+        if (!in_range(a) || !in_range(b))
+        {
+            return uf.sameSet(a, b);
+        }
+        Replica& replica = local_replica();
+        const bool same = replica.labels[a].load(std::memory_order_relaxed) ==
+                          replica.labels[b].load(std::memory_order_relaxed);
+        if (same || lag(replica) <= lag_bound)
+        {
+            replica_answers.fetch_add(1, std::memory_order_relaxed);
+            return same;
+        }
+        return uf.sameSet(a, b);
+    }
+
+    // Merges on the primary and marks both labels for the next refresh.
+    bool unionSets(int a, int b)
+    {
+        bool merged = uf.unionSets(a, b);
+        if (merged)
+        {
+            mark(a);
+            mark(b);
+            epoch.fetch_add(1, std::memory_order_release);
+        }
+        return merged;
+    }
+
+    // Unions (and range unions) on the primary, a refresh if that left the replicas
+    // more than max_lag epochs behind, then the queries on the replicas.
+    void processOperations(const std::vector<Operation>& ops, std::vector<int>& results)
+    {
+        if (!batch_in_range(ops))
+        {
+            uf.processOperations(ops, results);
+            note_merges(ops, results);
+            return;
+        }
+        results.resize(ops.size());
+        union_index.clear();
+        union_ops.clear();
+        for (std::size_t i = 0; i < ops.size(); i++)
+        {
+            if (ops[i].type != OperationType::FIND_OP && ops[i].type != OperationType::SAMESET_OP)
+            {
+                union_index.push_back(i);
+                union_ops.push_back(ops[i]);
+            }
+        }
+
+        if (!union_ops.empty())
+        {
+            uf.processOperations(union_ops, union_results);
+            #pragma omp parallel for schedule(static)
+            for (std::size_t k = 0; k < union_ops.size(); k++)
+            {
+                results[union_index[k]] = union_results[k];
+            }
+            note_merges(union_ops, union_results);
+        }
+
+        if (union_ops.size() < ops.size())
+        {
+            std::uint64_t local_answers = 0;
+            fallback.clear();
+            #pragma omp parallel reduction(+ : local_answers)
+            {
+                Replica& replica = local_replica();
+                const bool fresh = lag(replica) <= lag_bound;
+                std::vector<std::size_t> local_fallback; // Primary reads deferred to one thread
+                #pragma omp for schedule(static) nowait
+                for (std::size_t i = 0; i < ops.size(); i++)
+                {
+                    const Operation& op = ops[i];
+                    if (op.type == OperationType::SAMESET_OP)
+                    {
+                        bool same = replica.labels[op.a].load(std::memory_order_relaxed) ==
+                                    replica.labels[op.b].load(std::memory_order_relaxed);
+                        if (same || fresh)
+                        {
+                            results[i] = same ? 1 : 0;
+                            local_answers++;
+                        }
+                        else if (concurrent_queries)
+                        {
+                            results[i] = uf.sameSet(op.a, op.b) ? 1 : 0;
+                        }
+                        else
+                        {
+                            local_fallback.push_back(i);
+                        }
+                    }
+                    else if (op.type == OperationType::FIND_OP)
+                    {
+                        if (fresh)
+                        {
+                            results[i] = replica.labels[op.a].load(std::memory_order_relaxed);
+                            local_answers++;
+                        }
+                        else if (concurrent_queries)
+                        {
+                            results[i] = uf.find(op.a);
+                        }
+                        else
+                        {
+                            local_fallback.push_back(i);
+                        }
+                    }
+                }
+                if (!local_fallback.empty())
+                {
+                    #pragma omp critical(replicated_fallback)
+                    fallback.insert(fallback.end(), local_fallback.begin(), local_fallback.end());
+                }
+            }
+            replica_answers.fetch_add(local_answers, std::memory_order_relaxed);
+            for (std::size_t i : fallback)
+            {
+                const Operation& op = ops[i];
+                results[i] = op.type == OperationType::FIND_OP ? uf.find(op.a) : (uf.sameSet(op.a, op.b) ? 1 : 0);
+            }
+        }
+    }
+
+    // Brings every replica up to the current epoch. Precondition: no unions in flight.
+    void refreshReplicas()
+    {
+        const std::uint64_t target = epoch.load(std::memory_order_acquire);
+        const std::size_t words = marked.size();
+        Replica& first = *copies[0];
+        std::uint64_t updated = 0;
+        #pragma omp parallel for schedule(static) reduction(+ : updated) if (concurrent_queries)
+        for (int i = 0; i < num_elements; i++)
+        {
+            const int old_label = first.labels[i].load(std::memory_order_relaxed);
+            if ((marked[old_label / 64].load(std::memory_order_relaxed) >> (old_label % 64) & 1) == 0)
+            {
+                continue;
+            }
+            const int root = uf.find(i);
+            if (root != old_label)
+            {
+                for (auto& replica : copies)
+                {
+                    replica->labels[i].store(root, std::memory_order_relaxed);
+                }
+                updated++;
+            }
+        }
+        #pragma omp parallel for schedule(static)
+        for (std::size_t w = 0; w < words; w++)
+        {
+            marked[w].store(0, std::memory_order_relaxed);
+        }
+        for (auto& replica : copies)
+        {
+            replica->epoch.store(target, std::memory_order_release);
+        }
+        replica_epoch = target;
+        refreshes++;
+        labels_updated += updated;
+    }
+
+    int size() const
+    {
+        return num_elements;
+    }
+
+    int replicaCount() const
+    {
+        return static_cast<int>(copies.size());
+    }
+
+    // Union batches (or successful single unions) applied to the primary so far.
+    std::uint64_t primaryEpoch() const
+    {
+        return epoch.load(std::memory_order_acquire);
+    }
+
+    // Epoch the replicas were last refreshed to.
+    std::uint64_t replicaEpoch() const
+    {
+        return replica_epoch;
+    }
+
+    // Queries answered from a replica (the rest went to the primary).
+    std::uint64_t replicaAnswers() const
+    {
+        return replica_answers.load(std::memory_order_relaxed);
+    }
+
+    std::uint64_t refreshCount() const
+    {
+        return refreshes;
+    }
+
+    // Labels rewritten by refreshes so far (per replica).
+    std::uint64_t labelsUpdated() const
+    {
+        return labels_updated;
+    }
+
+    // The primary engine (unions made directly on it do not reach the replicas).
+    UF& engine()
+    {
+        return uf;
+    }
+
+private:
+    // Whether the primary may be read from several threads at once.
+    static constexpr bool concurrent_queries = requires { requires UF::thread_safe_queries; };
+
+    bool in_range(int x) const
+    {
+        return x >= 0 && x < num_elements;
+    }
+
+    // Every id of the batch in [0, n) (b ignored for finds).
+    bool batch_in_range(const std::vector<Operation>& ops) const
+    {
+        bool ok = true;
+        #pragma omp parallel for schedule(static) reduction(&& : ok)
+        for (std::size_t i = 0; i < ops.size(); i++)
+        {
+            ok = ok && in_range(ops[i].a) && (ops[i].type == OperationType::FIND_OP || in_range(ops[i].b));
+        }
+        return ok;
+    }
+
+    // After the engine ran 'ops': marks the labels of every union that merged,
+    // advances the epoch if any did, and refreshes if the lag now exceeds max_lag.
+    void note_merges(const std::vector<Operation>& ops, const std::vector<int>& op_results)
+    {
+        bool merged = false;
+        #pragma omp parallel for schedule(static) reduction(|| : merged)
+        for (std::size_t k = 0; k < ops.size(); k++)
+        {
+            if (ops[k].type != OperationType::FIND_OP && ops[k].type != OperationType::SAMESET_OP && op_results[k] == 1)
+            {
+                merged = true;
+                mark_operation(ops[k]);
+            }
+        }
+        if (merged)
+        {
+            epoch.fetch_add(1, std::memory_order_release);
+        }
+        if (epoch.load(std::memory_order_acquire) - replica_epoch > lag_bound)
+        {
+            refreshReplicas();
+        }
+    }
+
+    struct Replica
+    {
+        explicit Replica(std::size_t n) : labels(n) {}
+
+        ZeroedBuffer<std::atomic<int>> labels;  // Untouched until placed
+        alignas(64) std::atomic<std::uint64_t> epoch{0};
+    };
+
+    std::uint64_t lag(const Replica& replica) const
+    {
+        return epoch.load(std::memory_order_acquire) - replica.epoch.load(std::memory_order_acquire);
+    }
+
+    // Marks the current label of 'x' as stale; called after the union that merged it.
+    void mark(int x)
+    {
+        const int label = copies[0]->labels[x].load(std::memory_order_relaxed);
+        marked[label / 64].fetch_or(std::uint64_t{1} << (label % 64), std::memory_order_relaxed);
+    }
+
+    void mark_operation(const Operation& op)
+    {
+        if (op.type == OperationType::UNION_OP)
+        {
+            mark(op.a);
+            mark(op.b);
+            return;
+        }
+        for (int k = std::min(op.a, op.b); k <= std::max(op.a, op.b); k++)
+        {
+            mark(k); // Range union: every element of [a, b] may have changed label
+        }
+    }
+
+    // The replica of the node the calling thread runs on. With more replicas than
+    // nodes (testing), threads are spread over them by OpenMP thread number.
+    Replica& local_replica()
+    {
+        if (static_cast<int>(copies.size()) != num_nodes)
+        {
+            return *copies[static_cast<std::size_t>(omp_get_thread_num()) % copies.size()];
+        }
+        const int cpu = sched_getcpu();
+        const int node = cpu >= 0 && cpu < static_cast<int>(node_of_cpu.size()) ? node_of_cpu[cpu] : 0;
+        return *copies[static_cast<std::size_t>(node)];
+    }
+
+    // Writes the identity labels from a thread pinned to the replica's node, so the
+    // first-touch policy puts its pages there.
+    void place_replica(int r)
+    {
+        Replica& replica = *copies[static_cast<std::size_t>(r)];
+        auto fill = [&replica, this]()
+        {
+            for (int i = 0; i < num_elements; i++)
+            {
+                replica.labels[i].store(i, std::memory_order_relaxed);
+            }
+        };
+        if (num_nodes == 1 || r >= num_nodes)
+        {
+            fill();
+            return;
+        }
+        std::thread placer([&, r]()
+        {
+            cpu_set_t cpus;
+            CPU_ZERO(&cpus);
+            for (std::size_t cpu = 0; cpu < node_of_cpu.size(); cpu++)
+            {
+                if (node_of_cpu[cpu] == r)
+                {
+                    CPU_SET(cpu, &cpus);
+                }
+            }
+            pthread_setaffinity_np(pthread_self(), sizeof(cpus), &cpus);
+            fill();
+        });
+        placer.join();
+    }
+
+    // cpu -> node from /sys/devices/system/node/node*/cpulist ("0-3,8-11"); all 0 if absent.
+    static std::vector<int> read_cpu_nodes()
+    {
+        std::vector<int> nodes(std::max(1u, std::thread::hardware_concurrency()), 0);
+        for (int node = 0; node < 1024; node++)
+        {
+            std::ifstream in("/sys/devices/system/node/node" + std::to_string(node) + "/cpulist");
+            if (!in)
+            {
+                break;
+            }
+            std::string list;
+            std::getline(in, list);
+            std::stringstream ranges(list);
+            std::string range;
+            while (std::getline(ranges, range, ','))
+            {
+                std::size_t dash = range.find('-');
+                int lo = std::stoi(range.substr(0, dash));
+                int hi = dash == std::string::npos ? lo : std::stoi(range.substr(dash + 1));
+                for (int cpu = lo; cpu <= hi; cpu++)
+                {
+                    if (cpu >= static_cast<int>(nodes.size()))
+                    {
+                        nodes.resize(cpu + 1, 0);
+                    }
+                    nodes[cpu] = node;
+                }
+            }
+        }
+        return nodes;
+    }
+
+    UF uf;
+    int num_elements;
+    std::uint64_t lag_bound;
+    std::vector<int> node_of_cpu;
+    int num_nodes;
+    std::vector<std::unique_ptr<Replica>> copies;
+    std::vector<std::atomic<std::uint64_t>> marked; // One bit per label changed since the last refresh
+    alignas(64) std::atomic<std::uint64_t> epoch{0};
+    alignas(64) std::atomic<std::uint64_t> replica_answers{0};
+    std::uint64_t replica_epoch = 0;
+    std::uint64_t refreshes = 0;
+    std::uint64_t labels_updated = 0;
+    std::vector<std::size_t> union_index;   // Batch positions of the current batch's unions
+    std::vector<Operation> union_ops;
+    std::vector<int> union_results;
+    std::vector<std::size_t> fallback;      // Queries of the current batch answered by the primary on one thread
+};
+
+#endif // REPLICATED_UNION_FIND_HPP
@@ -0,0 +1,76 @@
+#ifndef ROOT_HINT_CACHE_HPP
+#define ROOT_HINT_CACHE_HPP
+
+#include <atomic>
+#include <cstdint>
+
+// --- Thread-Local Root Hint Cache ---
+
+// Per-thread direct-mapped cache from element to its last known root, shared by
+// all lock-free engines. A hit is only trusted after checking that the cached
+// root is still a root: non-roots never become roots again, so if the cached
+// root has not been linked under another root, it is still the element's root.
+// That check is one load of a (usually hot) root word instead of a full walk.
+//
+// Entries are tagged with an owner id unique to each Union-Find instance, so
+// stale entries from other or destroyed instances never match.
+struct RootHintCache
+{
+    static constexpr int SLOTS = 4096; // Power of two; 48 KiB per thread
+
+    struct Entry
+    {
+        std::uint32_t owner; // 0 = empty
+        int element;
+        int root;
+    };
+
+    Entry entries[SLOTS];
+    std::uint64_t hits;
+    std::uint64_t misses;
+
+    // The calling thread's cache (zero-initialized on first use).
+    static RootHintCache& local()
+    {
+        thread_local RootHintCache cache{};
+        return cache;
+    }
+
+    // Returns a fresh owner id for a new Union-Find instance (never 0).
+    static std::uint32_t nextOwnerId()
+    {
+        static std::atomic<std::uint32_t> next_id{1};
+        return next_id.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    static inline int slot_of(int element)
+    {
+        // Fibonacci hashing spreads nearby ids over the table.
+        return static_cast<int>((static_cast<std::uint32_t>(element) * 2654435769u) >> 20) & (SLOTS - 1);
+    }
+
+    // Returns true and sets 'root' if the slot holds an entry for (owner, element).
+    inline bool lookup(std::uint32_t owner, int element, int& root) const
+    {
+        const Entry& e = entries[slot_of(element)];
+        if (e.owner == owner && e.element == element)
+        {
+            root = e.root;
+            return true;
+        }
+        return false;
+    }
+
+    inline void store(std::uint32_t owner, int element, int root)
+    {
+        entries[slot_of(element)] = Entry{owner, element, root};
+    }
+
+    inline void resetStats()
+    {
+        hits = 0;
+        misses = 0;
+    }
+};
+
+#endif // ROOT_HINT_CACHE_HPP
@@ -0,0 +1,228 @@
+#ifndef SMALL_UNION_FIND_HPP
+#define SMALL_UNION_FIND_HPP
+
+#include <array>
+#include <vector>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <type_traits> // For std::conditional_t
+
+// --- Small Union-Find ---
+
+// Fixed-capacity serial Union-Find for tiny universes (image tiles, per-request
+// jobs), with the storage inline in the object instead of on the heap.
+//
+// Parents are stored as N narrow indices (8-bit up to 256 elements, 16-bit up to
+// 65536) with roots pointing at themselves, plus one byte of rank per element
+// (ranks never exceed log2(N) <= 16). N = 256 is 512 bytes in total, against
+// 1 KiB and an allocation for UnionFind(256).
+//
+// Every operation is constexpr, so a partition can be built at compile time.
+// Finds use path halving; union by rank uses the same tie rule as UnionFind, so
+// processOperations() gives the same results. flatten() and label() sweep the
+// whole array with SIMD loops instead of one find() per element: pointer jumping,
+// a scan over the root flags, and a gather of the root labels. The jump and
+// gather passes vectorize with the default flags; the scan needs e.g. -mavx2.
+template <std::size_t N>
+class SmallUnionFind
+{
+    static_assert(N >= 1 && N <= 65536, "SmallUnionFind supports 1 to 65536 elements.");
+
+public:
+    using index_type = std::conditional_t<(N <= 256), std::uint8_t, std::uint16_t>;
+
+    // Same operation types and result convention as UnionFind.
+    enum class OperationType { UNION_OP, FIND_OP, SAMESET_OP };
+
+    struct Operation
+    {
+        OperationType type;
+        int a;
+        int b; // Used for UNION_OP and SAMESET_OP, ignored for FIND_OP
+    };
+
+    // N singletons.
+    constexpr SmallUnionFind()
+        : parent{}, rank{}
+    {
+        reset();
+    }
+
+    // Back to N singletons.
+    constexpr void reset()
+    {
+        for (std::size_t i = 0; i < N; i++)
+        {
+            parent[i] = static_cast<index_type>(i);
+            rank[i] = 0;
+        }
+    }
+
+    // Precondition: 0 <= a < N
+    constexpr int find(int a)
+    {
+        assert(a >= 0 && a < static_cast<int>(N) && "Element index out of bounds in find().");
+        while (parent[a] != a)
+        {
+            parent[a] = parent[parent[a]];
+            a = parent[a];
+        }
+        return a;
+    }
+
+    // Returns true if a merge occurred. Precondition: 0 <= a, b < N
+    constexpr bool unionSets(int a, int b)
+    {
+        int root_a = find(a);
+        int root_b = find(b);
+        if (root_a == root_b)
+        {
+            return false;
+        }
+        if (rank[root_a] < rank[root_b])
+        {
+            parent[root_a] = static_cast<index_type>(root_b);
+        }
+        else
+        {
+            parent[root_b] = static_cast<index_type>(root_a);
+            if (rank[root_a] == rank[root_b])
+            {
+                rank[root_a]++;
+            }
+        }
+        return true;
+    }
+
+    constexpr bool sameSet(int a, int b)
+    {
+        return find(a) == find(b);
+    }
+
+    // Same contract as UnionFind::processOperations.
+    void processOperations(const std::vector<Operation>& ops, std::vector<int>& results)
+    {
+        results.resize(ops.size());
+        for (std::size_t i = 0; i < ops.size(); i++)
+        {
+            const Operation& op = ops[i];
+            switch (op.type)
+            {
+                case OperationType::UNION_OP:
+                    results[i] = unionSets(op.a, op.b) ? 1 : 0;
+                    break;
+                case OperationType::FIND_OP:
+                    results[i] = find(op.a);
+                    break;
+                case OperationType::SAMESET_OP:
+                    results[i] = sameSet(op.a, op.b) ? 1 : 0;
+                    break;
+                default:
+                    assert(false && "Unknown operation type encountered.");
+                    results[i] = -2;
+                    break;
+            }
+        }
+    }
+
+    static constexpr int size()
+    {
+        return static_cast<int>(N);
+    }
+
+    constexpr int components() const
+    {
+        int roots = 0;
+        for (std::size_t i = 0; i < N; i++)
+        {
+            roots += parent[i] == i ? 1 : 0;
+        }
+        return roots;
+    }
+
+    // Points every element directly at its root.
+    constexpr void flatten()
+    {
+        if (std::is_constant_evaluated())
+        {
+            for (std::size_t i = 0; i < N; i++)
+            {
+                parent[i] = static_cast<index_type>(find(static_cast<int>(i)));
+            }
+            return;
+        }
+        while (jump_round() != 0)
+        {
+        }
+    }
+
+    // Flattens, then writes dense component labels 0..c-1 (in order of the smallest
+    // root index) to 'labels' and returns c.
+    constexpr int label(std::array<index_type, N>& labels)
+    {
+        flatten();
+        // Roots get their rank in the exclusive scan of the root flags; the other
+        // slots are overwritten below and never read in between.
+        int next = 0;
+        if (std::is_constant_evaluated())
+        {
+            for (std::size_t i = 0; i < N; i++)
+            {
+                labels[i] = static_cast<index_type>(next);
+                next += parent[i] == i ? 1 : 0;
+            }
+        }
+        else
+        {
+            next = scan_roots(labels);
+        }
+        #pragma GCC ivdep
+        for (std::size_t i = 0; i < N; i++)
+        {
+            labels[i] = labels[parent[i]];
+        }
+        return next;
+    }
+
+private:
+    // OpenMP directives cannot appear in constant evaluation, so the SIMD passes
+    // live in these runtime-only helpers.
+
+    // One pointer-jumping round: every parent becomes its grandparent. Any value
+    // read is an ancestor, so lanes may see each other's writes in any order.
+    // Union by rank bounds the depth by log2(N), so flatten() takes at most four
+    // rounds plus the one that sees no change. Returns nonzero if anything moved.
+    unsigned jump_round()
+    {
+        unsigned changed = 0;
+        #pragma omp simd reduction(| : changed)
+        for (std::size_t i = 0; i < N; i++)
+        {
+            index_type p = parent[i];
+            index_type gp = parent[p];
+            parent[i] = gp;
+            changed |= static_cast<unsigned>(gp ^ p);
+        }
+        return changed;
+    }
+
+    // Exclusive scan of the root flags into 'labels'; returns the number of roots.
+    int scan_roots(std::array<index_type, N>& labels) const
+    {
+        int next = 0;
+        #pragma omp simd reduction(inscan, + : next)
+        for (std::size_t i = 0; i < N; i++)
+        {
+            labels[i] = static_cast<index_type>(next);
+            #pragma omp scan exclusive(next)
+            next += parent[i] == i ? 1 : 0;
+        }
+        return next;
+    }
+
+    std::array<index_type, N> parent;  // parent[i] == i for roots
+    std::array<std::uint8_t, N> rank;  // Meaningful for roots only
+};
+
+#endif // SMALL_UNION_FIND_HPP
@@ -0,0 +1,268 @@
+#ifndef TIMELINE_TRACE_HPP
+#define TIMELINE_TRACE_HPP
+
+#include <vector>
+#include <string>
+#include <memory>
+#include <chrono>
+#include <cstdint>
+#include <cstddef>
+#include <fstream>
+#include <ostream>
+#include <ios>        // For std::fixed
+#include <algorithm>  // For std::min
+#include <omp.h>
+
+// --- Per-Thread Timeline Trace ---
+
+// Optional recorder for the timeline of processOperations batches, exported as
+// Chrome trace-event JSON (chrome://tracing, ui.perfetto.dev). Attach one to a
+// lock-free engine with setTimeline(&trace); each traced batch records:
+//   batch         the whole batch on the calling thread
+//   chunk         one CHUNK_OPS slice of the operation list on the thread that ran it
+//                 (args: first op, op count, union retries inside the chunk)
+//   barrier wait  time a thread spent at the end-of-batch barrier after its last chunk
+//   retry storm   instant event when one union needs storm_threshold retries
+// Load imbalance shows up as uneven barrier waits, a straggler as one long chunk
+// row, and contention bursts as retry storms and high per-chunk retry counts.
+//
+// Every thread writes only its own ring buffer (no shared cursor). A full ring
+// overwrites its oldest events and counts them as dropped.
+class TimelineTrace
+{
+public:
+    static constexpr std::size_t CHUNK_OPS = 4096; // Operations per traced chunk
+
+    // events_per_thread: ring capacity per thread.
+    // storm_threshold: retries of a single union that count as a retry storm.
+    explicit TimelineTrace(std::size_t events_per_thread = 1 << 16, int storm_threshold = 8)
+        : capacity(events_per_thread > 0 ? events_per_thread : 1),
+          storm_threshold(storm_threshold),
+          origin(std::chrono::steady_clock::now())
+    {
+    }
+
+    TimelineTrace(const TimelineTrace&) = delete;
+    TimelineTrace& operator=(const TimelineTrace&) = delete;
+
+    // Runs process_op(i) for every i in [0, num_ops) in parallel, with the same static
+    // block distribution as the untraced loops, recording chunk/barrier/batch events.
+    template <typename ProcessOp>
+    void runBatch(std::size_t num_ops, ProcessOp&& process_op)
+    {
+        ensure_rings(omp_get_max_threads());
+        std::uint64_t batch_start = now();
+        const std::size_t num_chunks = (num_ops + CHUNK_OPS - 1) / CHUNK_OPS;
+
+        #pragma omp parallel
+        {
+            Ring& ring = *rings[omp_get_thread_num()];
+            active_ring() = &ring;
+            std::uint64_t last_end = now();
+
+            #pragma omp for schedule(static) nowait
+            for (std::size_t c = 0; c < num_chunks; c++)
+            {
+                std::size_t first = c * CHUNK_OPS;
+                std::size_t last = std::min(num_ops, first + CHUNK_OPS);
+                ring.chunk_retries = 0;
+                std::uint64_t start = now();
+                for (std::size_t i = first; i < last; i++)
+                {
+                    process_op(i);
+                }
+                last_end = now();
+                ring.push(Event{"chunk", 'X', start, last_end - start,
+                                static_cast<std::int64_t>(first), static_cast<std::int64_t>(last - first),
+                                ring.chunk_retries});
+            }
+
+            #pragma omp barrier
+            std::uint64_t released = now();
+            ring.push(Event{"barrier wait", 'X', last_end, released - last_end, 0, 0, 0});
+            active_ring() = nullptr;
+        }
+
+        rings[omp_get_thread_num()]->push(Event{"batch", 'X', batch_start, now() - batch_start,
+                                                static_cast<std::int64_t>(num_ops), 0, 0});
+    }
+
+    // Called from an engine's union retry loop; counts towards the current chunk and
+    // records a retry storm once a union reaches storm_threshold retries.
+    // No-op outside runBatch.
+    static void noteRetry(int a, int b, int retries)
+    {
+        Ring* ring = active_ring();
+        if (ring == nullptr)
+        {
+            return;
+        }
+        ring->chunk_retries++;
+        if (retries == ring->owner->storm_threshold)
+        {
+            ring->push(Event{"retry storm", 'i', ring->owner->now(), 0, a, b, retries});
+        }
+    }
+
+    // Writes all recorded events as Chrome trace-event JSON ("traceEvents" array).
+    // Times are microseconds with three decimals, so every nanosecond survives.
+    void writeChromeTrace(std::ostream& out) const
+    {
+        std::ios_base::fmtflags flags = out.flags();
+        std::streamsize precision = out.precision();
+        out << std::fixed;
+        out.precision(3);
+        out << "{\"displayTimeUnit\":\"ms\",\"traceEvents\":[";
+        bool first = true;
+        for (std::size_t t = 0; t < rings.size(); t++)
+        {
+            const Ring& ring = *rings[t];
+            if (ring.head == 0)
+            {
+                continue;
+            }
+            out << (first ? "" : ",") << "\n{\"name\":\"thread_name\",\"ph\":\"M\",\"pid\":1,\"tid\":" << t
+                << ",\"args\":{\"name\":\"omp thread " << t << "\"}}";
+            first = false;
+
+            std::size_t count = std::min<std::uint64_t>(ring.head, capacity);
+            for (std::uint64_t k = ring.head - count; k < ring.head; k++)
+            {
+                const Event& e = ring.events[k % capacity];
+                out << ",\n{\"name\":\"" << e.name << "\",\"ph\":\"" << e.phase << "\",\"pid\":1,\"tid\":" << t
+                    << ",\"ts\":" << e.ts_ns / 1000.0;
+                if (e.phase == 'X')
+                {
+                    out << ",\"dur\":" << e.dur_ns / 1000.0;
+                }
+                else
+                {
+                    out << ",\"s\":\"t\"";
+                }
+                out << ",\"args\":" << args_json(e) << "}";
+            }
+        }
+        out << "\n]}\n";
+        out.flags(flags);
+        out.precision(precision);
+    }
+
+    // Writes the trace to 'path'; returns false if the file cannot be written.
+    bool writeChromeTrace(const std::string& path) const
+    {
+        std::ofstream out(path);
+        if (!out)
+        {
+            return false;
+        }
+        writeChromeTrace(out);
+        return static_cast<bool>(out);
+    }
+
+    // Number of events currently held (after ring overwrites).
+    std::size_t eventCount() const
+    {
+        std::size_t total = 0;
+        for (const auto& ring : rings)
+        {
+            total += std::min<std::uint64_t>(ring->head, capacity);
+        }
+        return total;
+    }
+
+    // Number of events overwritten because a ring was full.
+    std::uint64_t droppedCount() const
+    {
+        std::uint64_t total = 0;
+        for (const auto& ring : rings)
+        {
+            total += ring->head > capacity ? ring->head - capacity : 0;
+        }
+        return total;
+    }
+
+    // Discards all events. Precondition: no traced batch is running.
+    void clear()
+    {
+        for (auto& ring : rings)
+        {
+            ring->head = 0;
+        }
+    }
+
+private:
+    struct Event
+    {
+        const char* name; // Static string
+        char phase;       // 'X' = complete event, 'i' = instant event
+        std::uint64_t ts_ns;
+        std::uint64_t dur_ns;
+        std::int64_t arg0;
+        std::int64_t arg1;
+        std::int64_t arg2;
+    };
+
+    // One per OpenMP thread; padded so neighbouring threads' cursors do not share a line.
+    struct alignas(64) Ring
+    {
+        explicit Ring(TimelineTrace* owner) : owner(owner), events(owner->capacity) {}
+
+        void push(const Event& e)
+        {
+            events[head % owner->capacity] = e;
+            head++;
+        }
+
+        TimelineTrace* owner;
+        std::vector<Event> events;
+        std::uint64_t head = 0;        // Total events pushed
+        std::int64_t chunk_retries = 0;
+    };
+
+    static Ring*& active_ring()
+    {
+        thread_local Ring* ring = nullptr;
+        return ring;
+    }
+
+    std::uint64_t now() const
+    {
+        return static_cast<std::uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now() - origin).count());
+    }
+
+    void ensure_rings(int threads)
+    {
+        while (static_cast<int>(rings.size()) < threads)
+        {
+            rings.push_back(std::make_unique<Ring>(this));
+        }
+    }
+
+    static std::string args_json(const Event& e)
+    {
+        std::string name = e.name;
+        if (name == "chunk")
+        {
+            return "{\"first_op\":" + std::to_string(e.arg0) + ",\"ops\":" + std::to_string(e.arg1) +
+                   ",\"retries\":" + std::to_string(e.arg2) + "}";
+        }
+        if (name == "retry storm")
+        {
+            return "{\"a\":" + std::to_string(e.arg0) + ",\"b\":" + std::to_string(e.arg1) +
+                   ",\"retries\":" + std::to_string(e.arg2) + "}";
+        }
+        if (name == "batch")
+        {
+            return "{\"ops\":" + std::to_string(e.arg0) + "}";
+        }
+        return "{}";
+    }
+
+    std::size_t capacity;
+    int storm_threshold;
+    std::chrono::steady_clock::time_point origin;
+    std::vector<std::unique_ptr<Ring>> rings;
+};
+
+#endif // TIMELINE_TRACE_HPP
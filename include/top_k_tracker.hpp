@@ -0,0 +1,298 @@
+#ifndef TOP_K_TRACKER_HPP
+#define TOP_K_TRACKER_HPP
+
+#include <vector>
+#include <mutex>
+#include <atomic>
+#include <thread>
+#include <chrono>
+#include <condition_variable>
+#include <algorithm>
+#include <cstdint>
+#include <cstddef>
+#include <stdexcept>
+#include "merge_event_stream.hpp"
+
+// --- Top-k Largest Components Tracker ---
+
+// One component of a topK() answer: its engine root and element count.
+struct ComponentSize
+{
+    int root;
+    int size;
+};
+
+// Keeps the k largest components of a lock-free engine current without O(n) scans.
+// Attach with uf.setMergeEvents(&tracker.stream()): each successful link then
+// costs the union one ring append, and a background thread applies the events
+// every 'refresh_interval' to a MergeIndex (component sizes and roots, in any
+// event order) and to a bounded candidate list of 2k components.
+//
+// Candidate list invariant: every component outside it has at most 'floor'
+// elements. A merge no larger than the smallest candidate only raises floor (the
+// common case: one comparison). Otherwise the merged parts leave the list (roots
+// disappear on merge) and the merged component enters, evicting the smallest
+// candidate if the list is full; the evicted size raises floor. The list is a
+// min-heap on size with each listed root's heap slot kept in a per-element array,
+// so dropping the parts and evicting the smallest cost O(log k) per merge.
+// The list's top k is exact while its k-th size is >= floor. When merges inside
+// the list shrink it below that, the list is rebuilt from the index (O(n), rare:
+// it takes about k merges among the largest components).
+//
+// topK() returns the snapshot published by the last refresh: it reflects every
+// link that completed before that refresh started, so it is at most
+// refresh_interval plus one drain behind. refresh() applies the pending events
+// at once (after a batch, the answer is then exact). Components of one element
+// are not listed.
+class TopKTracker
+{
+public:
+    TopKTracker(int n, std::size_t k, std::chrono::milliseconds refresh_interval = std::chrono::milliseconds(10),
+                std::size_t ring_capacity = 1 << 16)
+        : events(ring_capacity), index(n), top_k(k), capacity(2 * k), slot_of(n > 0 ? n : 0, NOT_LISTED),
+          interval(refresh_interval)
+    {
+        if (k == 0)
+        {
+            throw std::invalid_argument("TopKTracker: k must be positive.");
+        }
+        candidates.reserve(capacity);
+        refresher = std::thread([this] { run_refresher(); });
+    }
+
+    // Stops the background thread; events still in the stream are not applied.
+    ~TopKTracker()
+    {
+        {
+            std::lock_guard<std::mutex> lock(wake_mutex);
+            running = false;
+        }
+        wake.notify_one();
+        refresher.join();
+    }
+
+    TopKTracker(const TopKTracker&) = delete;
+    TopKTracker& operator=(const TopKTracker&) = delete;
+
+    // The stream to pass to the engine's setMergeEvents().
+    MergeEventStream& stream()
+    {
+        return events;
+    }
+
+    // Up to k largest components, largest first (ties in any order), as of the last refresh.
+    std::vector<ComponentSize> topK() const
+    {
+        std::lock_guard<std::mutex> lock(snapshot_mutex);
+        return snapshot;
+    }
+
+    // Applies every event published so far and publishes a new snapshot.
+    // Safe while unions run; concurrent calls serialize.
+    void refresh()
+    {
+        std::lock_guard<std::mutex> lock(state_mutex);
+        events.drain([this](const MergeEvent& e) { apply(e); });
+
+        auto larger = [](const ComponentSize& x, const ComponentSize& y) { return x.size > y.size; };
+        std::vector<ComponentSize> top = candidates;
+        std::size_t keep = std::min(top_k, top.size());
+        std::partial_sort(top.begin(), top.begin() + keep, top.end(), larger);
+        bool exact = top.size() >= top_k ? top[top_k - 1].size >= floor : floor <= 1;
+        if (!exact)
+        {
+            rebuild();
+            top = candidates;
+            keep = std::min(top_k, top.size());
+            std::partial_sort(top.begin(), top.begin() + keep, top.end(), larger);
+        }
+        top.resize(keep);
+        {
+            std::lock_guard<std::mutex> snapshot_lock(snapshot_mutex);
+            snapshot.swap(top);
+        }
+        refreshes.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    // Merge events applied so far.
+    std::uint64_t eventsApplied() const
+    {
+        return events.drainedCount();
+    }
+
+    // Snapshots published so far (background and explicit).
+    std::uint64_t refreshCount() const
+    {
+        return refreshes.load(std::memory_order_relaxed);
+    }
+
+    // Times the candidate list had to be rebuilt from the index.
+    std::uint64_t rebuildCount() const
+    {
+        return rebuilds.load(std::memory_order_relaxed);
+    }
+
+private:
+    static constexpr int NOT_LISTED = -1;
+
+    void apply(const MergeEvent& e)
+    {
+        // A component's engine root only changes when it merges, so the two parts'
+        // roots before the event are the roots they are listed under, if listed.
+        int root = index.find(e.root);
+        int other = index.find(e.child);
+        int merged = index.apply(e);
+        if (candidates.size() == capacity && merged <= candidates[0].size)
+        {
+            // Both parts were smaller than every candidate, so neither was listed.
+            floor = std::max(floor, merged);
+            return;
+        }
+        if (root == other)
+        {
+            return; // Duplicate event: nothing merged.
+        }
+        remove_listed(root);
+        remove_listed(other);
+        // The merged component keeps the root of e.root's part (MergeIndex::apply).
+        if (candidates.size() == capacity)
+        {
+            floor = std::max(floor, candidates[0].size);
+            slot_of[candidates[0].root] = NOT_LISTED;
+            place(0, ComponentSize{root, merged});
+            sift_down(0);
+        }
+        else
+        {
+            candidates.push_back(ComponentSize{root, merged});
+            slot_of[root] = static_cast<int>(candidates.size() - 1);
+            sift_up(candidates.size() - 1);
+        }
+    }
+
+    // Takes the component listed under 'root' (if any) out of the heap.
+    void remove_listed(int root)
+    {
+        int slot = slot_of[root];
+        if (slot == NOT_LISTED)
+        {
+            return;
+        }
+        slot_of[root] = NOT_LISTED;
+        std::size_t i = static_cast<std::size_t>(slot);
+        ComponentSize last = candidates.back();
+        candidates.pop_back();
+        if (i == candidates.size())
+        {
+            return;
+        }
+        place(i, last);
+        sift_up(i);
+        sift_down(slot_of[last.root]);
+    }
+
+    void place(std::size_t i, const ComponentSize& c)
+    {
+        candidates[i] = c;
+        slot_of[c.root] = static_cast<int>(i);
+    }
+
+    void sift_up(std::size_t i)
+    {
+        ComponentSize c = candidates[i];
+        while (i > 0 && candidates[(i - 1) / 2].size > c.size)
+        {
+            place(i, candidates[(i - 1) / 2]);
+            i = (i - 1) / 2;
+        }
+        place(i, c);
+    }
+
+    void sift_down(std::size_t i)
+    {
+        ComponentSize c = candidates[i];
+        while (true)
+        {
+            std::size_t child = 2 * i + 1;
+            if (child >= candidates.size())
+            {
+                break;
+            }
+            if (child + 1 < candidates.size() && candidates[child + 1].size < candidates[child].size)
+            {
+                child++;
+            }
+            if (candidates[child].size >= c.size)
+            {
+                break;
+            }
+            place(i, candidates[child]);
+            i = child;
+        }
+        place(i, c);
+    }
+
+    // Refills the candidates with the 2k largest components; floor becomes the largest left out.
+    void rebuild()
+    {
+        std::vector<ComponentSize> all;
+        index.forEachComponent([&all](int root, int size)
+        {
+            if (size > 1)
+            {
+                all.push_back(ComponentSize{root, size});
+            }
+        });
+        auto larger = [](const ComponentSize& x, const ComponentSize& y) { return x.size > y.size; };
+        std::size_t keep = std::min(capacity, all.size());
+        std::partial_sort(all.begin(), all.begin() + keep, all.end(), larger);
+        floor = 1;
+        for (std::size_t i = keep; i < all.size(); i++)
+        {
+            floor = std::max(floor, all[i].size);
+        }
+        for (const ComponentSize& c : candidates)
+        {
+            slot_of[c.root] = NOT_LISTED;
+        }
+        // Smallest first is already a valid min-heap.
+        candidates.assign(all.rend() - keep, all.rend());
+        for (std::size_t i = 0; i < candidates.size(); i++)
+        {
+            slot_of[candidates[i].root] = static_cast<int>(i);
+        }
+        rebuilds.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    void run_refresher()
+    {
+        std::unique_lock<std::mutex> lock(wake_mutex);
+        while (running)
+        {
+            wake.wait_for(lock, interval);
+            lock.unlock();
+            refresh();
+            lock.lock();
+        }
+    }
+
+    MergeEventStream events;
+    MergeIndex index;                        // Guarded by state_mutex
+    std::size_t top_k;
+    std::size_t capacity;                    // Candidate list bound (2k)
+    std::vector<ComponentSize> candidates;   // Guarded by state_mutex, a min-heap on size
+    std::vector<int> slot_of;                // Heap slot of each listed root, else NOT_LISTED; guarded by state_mutex
+    int floor = 1;                           // No component outside 'candidates' is larger
+    std::mutex state_mutex;
+    mutable std::mutex snapshot_mutex;
+    std::vector<ComponentSize> snapshot;     // Guarded by snapshot_mutex, sorted largest first
+    std::atomic<std::uint64_t> refreshes{0};
+    std::atomic<std::uint64_t> rebuilds{0};
+    std::chrono::milliseconds interval;
+    std::mutex wake_mutex;
+    std::condition_variable wake;
+    bool running = true;                     // Guarded by wake_mutex
+    std::thread refresher;
+};
+
+#endif // TOP_K_TRACKER_HPP
@@ -0,0 +1,522 @@
+#ifndef TRACE_RECORDER_HPP
+#define TRACE_RECORDER_HPP
+
+#include <vector>
+#include <string>
+#include <memory>
+#include <mutex>
+#include <atomic>
+#include <thread>
+#include <chrono>
+#include <condition_variable>
+#include <unordered_map>
+#include <algorithm>
+#include <cstdint>
+#include <cstddef>
+#include <stdexcept>
+#include <omp.h>
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h> // For __rdtsc
+#endif
+#include "union_find.hpp"
+#include "compressed_trace.hpp"
+
+// --- Production Trace Recorder ---
+
+// Opt-in recorder of the live call stream (find, unionSets, sameSet, unionRange)
+// into a compressed trace with a TraceContext (thread, timestamp) per operation.
+// The file is an ordinary compressed trace, so benchmark replays it directly.
+//
+// Hot path: every thread appends to its own single-producer/single-consumer ring
+// (same scheme as MergeEventStream), so recording is a countdown, a clock read and
+// a store plus a release increment on thread-owned lines. Unsampled calls cost
+// only the countdown. On x86 the clock is the TSC (about 8 ns against 20+ ns for
+// steady_clock here); the first drain fixes the ticks-to-nanoseconds ratio against
+// steady_clock over at least the first CALIBRATION_MS of recording, and every drain
+// scales with that one ratio (so a thread's times never go backwards between
+// drains). This assumes an invariant TSC. A full ring drops the operation and counts it instead of
+// blocking the caller. Calls with an element id outside [0, n_elements) are not
+// recorded (the engine rejects them, and one would make its block unreadable);
+// they are counted as invalid. A flusher thread drains all rings every flush interval,
+// orders the drained operations by timestamp and appends them to the trace; only
+// it does I/O.
+//
+// Options:
+//   sample_period  record one call in sample_period per thread (1 = every call)
+//   max_ops        stop recording after this many operations (0 = no cap)
+//   ring_capacity  operations buffered per thread between flushes
+//
+// Errors of the background writer are kept and rethrown by stop().
+struct TraceRecorderOptions
+{
+    int sample_period = 1;
+    std::uint64_t max_ops = 0;
+    std::size_t ring_capacity = 1 << 16;
+    std::chrono::milliseconds flush_interval{20};
+    std::uint32_t block_ops = 65536; // Operations per compressed block
+};
+
+class TraceRecorder
+{
+public:
+    using Options = TraceRecorderOptions;
+
+    // Creates the trace at 'path' for element ids in [0, n_elements) and starts the flusher.
+    TraceRecorder(const std::string& path, int n_elements, const Options& options = Options())
+        : period(options.sample_period),
+          num_elements(static_cast<unsigned>(n_elements < 0 ? 0 : n_elements)),
+          max_ops(options.max_ops),
+          flush_interval(options.flush_interval),
+          id(next_id().fetch_add(1, std::memory_order_relaxed)),
+          start(std::chrono::steady_clock::now()),
+          start_ticks(ticks()),
+          writer(path, n_elements, options.block_ops, true)
+    {
+        if (options.sample_period < 1 || options.ring_capacity == 0)
+        {
+            throw std::invalid_argument("TraceRecorder: sample_period and ring_capacity must be positive.");
+        }
+        capacity = 1;
+        while (capacity < options.ring_capacity)
+        {
+            capacity <<= 1;
+        }
+        flusher = std::thread([this] { run_flusher(); });
+    }
+
+    // Stops recording and finishes the file (errors are swallowed; call stop() to see them).
+    ~TraceRecorder()
+    {
+        try
+        {
+            stop();
+        }
+        catch (const std::exception&)
+        {
+        }
+    }
+
+    TraceRecorder(const TraceRecorder&) = delete;
+    TraceRecorder& operator=(const TraceRecorder&) = delete;
+
+    // Producer side: records one call (subject to sampling, the cap and ring space).
+    inline void record(UnionFind::OperationType type, int a, int b)
+    {
+        Ring& ring = local();
+        if (static_cast<unsigned>(a) >= num_elements ||
+            (type != UnionFind::OperationType::FIND_OP && static_cast<unsigned>(b) >= num_elements))
+        {
+            ring.invalid.store(ring.invalid.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+            return;
+        }
+        if (--ring.countdown > 0)
+        {
+            return;
+        }
+        ring.countdown = period;
+        if (stopped.load(std::memory_order_relaxed))
+        {
+            return;
+        }
+        std::uint64_t head = ring.head.load(std::memory_order_relaxed);
+        if (head - ring.cached_tail >= capacity)
+        {
+            ring.cached_tail = ring.tail.load(std::memory_order_acquire);
+            if (head - ring.cached_tail >= capacity)
+            {
+                ring.dropped.store(ring.dropped.load(std::memory_order_relaxed) + 1, std::memory_order_relaxed);
+                return;
+            }
+        }
+        ring.events[head & (capacity - 1)] = Event{ticks(), a, b, type};
+        ring.head.store(head + 1, std::memory_order_release);
+    }
+
+    // Appends everything recorded so far to the file (the flusher does this periodically).
+    void flush()
+    {
+        std::lock_guard<std::mutex> lock(flush_mutex);
+        if (error.empty() && !closed)
+        {
+            drain();
+        }
+    }
+
+    // Stops recording, drains the rings and closes the file. Idempotent.
+    // Throws std::runtime_error if writing the trace failed.
+    void stop()
+    {
+        {
+            std::lock_guard<std::mutex> lock(wake_mutex);
+            running = false;
+        }
+        stopped.store(true, std::memory_order_relaxed);
+        wake.notify_one();
+        if (flusher.joinable())
+        {
+            flusher.join();
+        }
+        std::lock_guard<std::mutex> lock(flush_mutex);
+        if (error.empty() && !closed)
+        {
+            try
+            {
+                drain();
+                writer.close();
+            }
+            catch (const std::exception& e)
+            {
+                error = e.what();
+            }
+        }
+        closed = true;
+        if (!error.empty())
+        {
+            throw std::runtime_error("TraceRecorder: " + error);
+        }
+    }
+
+    // Operations written to the trace so far.
+    std::uint64_t recordedCount() const
+    {
+        return written.load(std::memory_order_relaxed);
+    }
+
+    // Sampled operations lost to full rings (the flusher fell behind).
+    std::uint64_t droppedCount() const
+    {
+        std::lock_guard<std::mutex> lock(registry_mutex);
+        std::uint64_t total = 0;
+        for (const auto& ring : rings)
+        {
+            total += ring->dropped.load(std::memory_order_relaxed);
+        }
+        return total;
+    }
+
+    // Calls not recorded because an element id was outside [0, n_elements).
+    std::uint64_t invalidCount() const
+    {
+        std::lock_guard<std::mutex> lock(registry_mutex);
+        std::uint64_t total = 0;
+        for (const auto& ring : rings)
+        {
+            total += ring->invalid.load(std::memory_order_relaxed);
+        }
+        return total;
+    }
+
+    // True once max_ops operations are written (or after stop()); later calls are not recorded.
+    bool capReached() const
+    {
+        return stopped.load(std::memory_order_relaxed);
+    }
+
+private:
+    struct Event
+    {
+        std::uint64_t time; // ticks()
+        int a;
+        int b;
+        UnionFind::OperationType type;
+    };
+
+    // One per producer thread. Producer and consumer cursors sit on separate lines.
+    struct Ring
+    {
+        Ring(std::size_t capacity, int period) : events(capacity), countdown(period) {}
+
+        std::vector<Event> events;
+        alignas(64) std::atomic<std::uint64_t> head{0}; // Written by the producer only
+        std::uint64_t cached_tail = 0;                  // Producer's last view of 'tail'
+        int countdown;                                  // Calls until the next sample
+        std::atomic<std::uint64_t> dropped{0};          // Written by the producer only
+        std::atomic<std::uint64_t> invalid{0};          // Written by the producer only
+        alignas(64) std::atomic<std::uint64_t> tail{0}; // Written by the flusher only
+    };
+
+    static std::uint64_t ticks()
+    {
+#if defined(__x86_64__) || defined(__i386__)
+        return __rdtsc();
+#else
+        return static_cast<std::uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()).count());
+#endif
+    }
+
+    static std::atomic<std::uint64_t>& next_id()
+    {
+        static std::atomic<std::uint64_t> id{1};
+        return id;
+    }
+
+    // The calling thread's ring, created on first use (same caching scheme as MergeEventStream).
+    Ring& local()
+    {
+        if (__builtin_expect(cached_id() == id, 1))
+        {
+            return *cached_ring();
+        }
+        return register_thread();
+    }
+
+    static std::uint64_t& cached_id()
+    {
+        thread_local std::uint64_t cached = 0;
+        return cached;
+    }
+
+    static Ring*& cached_ring()
+    {
+        thread_local Ring* cached = nullptr;
+        return cached;
+    }
+
+    // Slow path of local(), kept out of line so record() stays small.
+    __attribute__((noinline)) Ring& register_thread()
+    {
+        std::lock_guard<std::mutex> lock(registry_mutex);
+        auto& slot = by_thread[std::this_thread::get_id()];
+        if (slot == nullptr)
+        {
+            rings.push_back(std::make_unique<Ring>(capacity, period));
+            slot = rings.back().get();
+        }
+        cached_id() = id;
+        cached_ring() = slot;
+        return *slot;
+    }
+
+    // Moves every published event into the file, oldest first, up to max_ops.
+    // The ring index is the recorded thread id. Caller holds flush_mutex.
+    void drain()
+    {
+        std::vector<Ring*> snapshot;
+        {
+            std::lock_guard<std::mutex> lock(registry_mutex);
+            for (const auto& ring : rings)
+            {
+                snapshot.push_back(ring.get());
+            }
+        }
+        batch.clear();
+        for (std::size_t t = 0; t < snapshot.size(); t++)
+        {
+            Ring* ring = snapshot[t];
+            std::uint64_t tail = ring->tail.load(std::memory_order_relaxed);
+            std::uint64_t head = ring->head.load(std::memory_order_acquire);
+            const std::size_t run_begin = batch.size();
+            for (std::uint64_t k = tail; k < head; k++)
+            {
+                batch.push_back(Pending{ring->events[k & (capacity - 1)], static_cast<std::uint32_t>(t)});
+            }
+            ring->tail.store(head, std::memory_order_release); // Frees the slots for the producer
+            // Each ring is already in time order: merge its run into the rest (stable,
+            // so a thread's calls with equal timestamps keep their program order).
+            std::inplace_merge(batch.begin(), batch.begin() + run_begin, batch.end(),
+                               [](const Pending& x, const Pending& y) { return x.event.time < y.event.time; });
+        }
+
+        if (ns_per_tick == 0.0)
+        {
+            calibrate();
+        }
+
+        std::uint64_t count = written.load(std::memory_order_relaxed);
+        for (const Pending& p : batch)
+        {
+            if (max_ops != 0 && count == max_ops)
+            {
+                break;
+            }
+            const std::uint64_t time_ns = p.event.time > start_ticks
+                                              ? static_cast<std::uint64_t>(static_cast<double>(p.event.time - start_ticks) * ns_per_tick)
+                                              : 0;
+            writer.append(UnionFind::Operation{p.event.type, p.event.a, p.event.b}, TraceContext{p.thread, time_ns});
+            count++;
+        }
+        written.store(count, std::memory_order_relaxed);
+        if (max_ops != 0 && count == max_ops)
+        {
+            stopped.store(true, std::memory_order_relaxed);
+        }
+    }
+
+    // Fixes ns_per_tick (1 without a TSC) from at least CALIBRATION_MS of steady_clock,
+    // waiting out the rest if the first drain comes sooner. Caller holds flush_mutex.
+    void calibrate()
+    {
+#if defined(__x86_64__) || defined(__i386__)
+        const auto min_elapsed = std::chrono::milliseconds(CALIBRATION_MS);
+        const auto elapsed = std::chrono::steady_clock::now() - start;
+        if (elapsed < min_elapsed)
+        {
+            std::this_thread::sleep_for(min_elapsed - elapsed);
+        }
+        const double elapsed_ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+        const std::uint64_t elapsed_ticks = ticks() - start_ticks;
+        ns_per_tick = elapsed_ticks > 0 ? elapsed_ns / static_cast<double>(elapsed_ticks) : 1.0;
+#else
+        ns_per_tick = 1.0;
+#endif
+    }
+
+    void run_flusher()
+    {
+        std::unique_lock<std::mutex> lock(wake_mutex);
+        while (running)
+        {
+            wake.wait_for(lock, flush_interval);
+            lock.unlock();
+            {
+                std::lock_guard<std::mutex> flush_lock(flush_mutex);
+                if (error.empty())
+                {
+                    try
+                    {
+                        drain();
+                    }
+                    catch (const std::exception& e)
+                    {
+                        error = e.what();
+                        stopped.store(true, std::memory_order_relaxed);
+                    }
+                }
+            }
+            lock.lock();
+        }
+    }
+
+    struct Pending
+    {
+        Event event;
+        std::uint32_t thread;
+    };
+
+    int period;
+    unsigned num_elements; // Ids at or above this (negative ones included) are invalid
+    std::uint64_t max_ops;
+    std::size_t capacity;
+    std::chrono::milliseconds flush_interval;
+    std::uint64_t id; // Unique per recorder, so thread-local caches never see a stale instance
+    std::chrono::steady_clock::time_point start;
+    std::uint64_t start_ticks;
+    std::atomic<bool> stopped{false};
+    std::atomic<std::uint64_t> written{0};
+
+    mutable std::mutex registry_mutex;
+    std::vector<std::unique_ptr<Ring>> rings;
+    std::unordered_map<std::thread::id, Ring*> by_thread;
+
+    static constexpr int CALIBRATION_MS = 10;
+
+    std::mutex flush_mutex; // Guards writer, batch, error, closed and ns_per_tick
+    CompressedTraceWriter writer;
+    double ns_per_tick = 0.0; // 0 until the first drain calibrates it
+    std::vector<Pending> batch;
+    std::string error;
+    bool closed = false;
+
+    std::mutex wake_mutex;
+    std::condition_variable wake;
+    bool running = true;
+    std::thread flusher;
+};
+
+// --- Recorded Union-Find ---
+
+// Wraps any dense engine's single-operation API and reports every call to an
+// attached TraceRecorder (setRecorder(&recorder); nullptr turns it off). With no
+// recorder attached a call costs one extra null check.
+//
+// processOperations() records the batch from the calling threads before running
+// it on the engine, so its operations share the batch's submission time. Batches
+// larger than the rings need sampling or larger rings, or they are dropped.
+//
+// UF must provide: UF(int), find, unionSets, sameSet and processOperations.
+template <typename UF>
+class RecordedUnionFind
+{
+public:
+    using Operation = typename UF::Operation;
+    using OperationType = typename UF::OperationType;
+
+    explicit RecordedUnionFind(int n) : uf(n) {}
+
+    RecordedUnionFind(const RecordedUnionFind&) = delete;
+    RecordedUnionFind& operator=(const RecordedUnionFind&) = delete;
+
+    // Attach or detach only while no operations are running; 'recorder' must outlive its use here.
+    void setRecorder(TraceRecorder* trace_recorder)
+    {
+        recorder = trace_recorder;
+    }
+
+    int find(int a)
+    {
+        if (recorder != nullptr)
+        {
+            recorder->record(UnionFind::OperationType::FIND_OP, a, 0);
+        }
+        return uf.find(a);
+    }
+
+    bool unionSets(int a, int b)
+    {
+        if (recorder != nullptr)
+        {
+            recorder->record(UnionFind::OperationType::UNION_OP, a, b);
+        }
+        return uf.unionSets(a, b);
+    }
+
+    bool sameSet(int a, int b)
+    {
+        if (recorder != nullptr)
+        {
+            recorder->record(UnionFind::OperationType::SAMESET_OP, a, b);
+        }
+        return uf.sameSet(a, b);
+    }
+
+    bool unionRange(int l, int r) requires requires(UF& u) { u.unionRange(0, 0); }
+    {
+        if (recorder != nullptr)
+        {
+            recorder->record(UnionFind::OperationType::RANGE_UNION_OP, l, r);
+        }
+        return uf.unionRange(l, r);
+    }
+
+    void processOperations(const std::vector<Operation>& ops, std::vector<int>& results)
+    {
+        if (recorder != nullptr)
+        {
+            #pragma omp parallel for schedule(static)
+            for (std::size_t i = 0; i < ops.size(); i++)
+            {
+                recorder->record(static_cast<UnionFind::OperationType>(ops[i].type), ops[i].a,
+                                 ops[i].type == OperationType::FIND_OP ? 0 : ops[i].b);
+            }
+        }
+        uf.processOperations(ops, results);
+    }
+
+    int size() const
+    {
+        return uf.size();
+    }
+
+    // The wrapped engine (calls made directly on it are not recorded).
+    UF& engine()
+    {
+        return uf;
+    }
+
+private:
+    UF uf;
+    TraceRecorder* recorder = nullptr;
+};
+
+#endif // TRACE_RECORDER_HPP
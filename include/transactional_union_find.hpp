@@ -0,0 +1,239 @@
+#ifndef TRANSACTIONAL_UNION_FIND_HPP
+#define TRANSACTIONAL_UNION_FIND_HPP
+
+#include <vector>
+#include <utility>
+#include <atomic>
+#include <mutex>
+#include <thread>
+#include <cstdint>
+#include <cstddef>
+#include <stdexcept>
+#include <omp.h>
+
+// --- Transactional Union-Find (multi-union commits with batch visibility) ---
+
+// Wrapper that lets a caller group unions into a Transaction and publish them as
+// one step: a concurrent find() or sameSet() sees either none of a committed
+// transaction's merges or all of them, never a prefix. Unions outside a
+// transaction (unionSets()) stay immediate, as on the engine.
+//
+// Visibility uses one version counter (a seqlock). commit() takes the commit
+// mutex, makes the version odd, applies the staged unions to the engine and
+// makes it even again. A reader notes the version, answers from the engine, and
+// retries if a commit started or finished meanwhile (or waits while one is in
+// flight). The engine's links are atomic stores, so a reader that saw any link of
+// a commit also sees the odd version; an unchanged even version therefore means
+// no commit overlapped the answer. Readers pay two loads of one read-mostly line;
+// a reader that meets a commit waits for its length (transaction size times one
+// union), which is why transactions should stay small.
+//
+// Transactions are atomic with respect to visibility only: they do not isolate
+// from immediate unions, and commits serialize among themselves. Discarding a
+// Transaction (or clear()) before commit() is an abort; nothing was applied.
+// commit() checks every staged id before applying any union and throws
+// std::out_of_range for a bad one, leaving the transaction staged. Should the
+// engine throw anyway, the version is still made even again, so readers never
+// wait on a commit that will not finish; the unions applied before the throw stay.
+//
+// UF must provide: UF(int), int find(int), bool sameSet(int, int),
+// bool unionSets(int, int), with atomic reads and links (the parallel engines).
+template <typename UF>
+class TransactionalUnionFind
+{
+public:
+    using Operation = typename UF::Operation;
+    using OperationType = typename UF::OperationType;
+
+    // Unions staged by one thread; not shared between threads.
+    class Transaction
+    {
+    public:
+        void unionSets(int a, int b)
+        {
+            staged.emplace_back(a, b);
+        }
+
+        std::size_t size() const
+        {
+            return staged.size();
+        }
+
+        bool empty() const
+        {
+            return staged.empty();
+        }
+
+        // Drops the staged unions (abort).
+        void clear()
+        {
+            staged.clear();
+        }
+
+    private:
+        friend class TransactionalUnionFind;
+        std::vector<std::pair<int, int>> staged;
+    };
+
+    explicit TransactionalUnionFind(int n)
+        : uf(n), num_elements(n)
+    {
+    }
+
+    TransactionalUnionFind(const TransactionalUnionFind&) = delete;
+    TransactionalUnionFind& operator=(const TransactionalUnionFind&) = delete;
+
+    // Applies the staged unions so they become visible together, then clears 'tx'.
+    // Returns how many of them merged two sets. Thread-safe; commits serialize.
+    // Throws std::out_of_range, with nothing applied, if a staged id is not in [0, size()).
+    int commit(Transaction& tx)
+    {
+        if (tx.staged.empty())
+        {
+            return 0;
+        }
+        for (const auto& [a, b] : tx.staged)
+        {
+            if (a < 0 || a >= num_elements || b < 0 || b >= num_elements)
+            {
+                throw std::out_of_range("Element index out of range in commit().");
+            }
+        }
+        int merged = 0;
+        {
+            std::lock_guard<std::mutex> lock(commit_mutex);
+            VersionBump in_flight(version); // Odd until this scope exits, however it exits
+            for (const auto& [a, b] : tx.staged)
+            {
+                merged += uf.unionSets(a, b) ? 1 : 0;
+            }
+        }
+        commits.fetch_add(1, std::memory_order_relaxed);
+        tx.staged.clear();
+        return merged;
+    }
+
+    // Immediate union, outside any transaction.
+    bool unionSets(int a, int b)
+    {
+        return uf.unionSets(a, b);
+    }
+
+    // Root of 'a' in a state between commits.
+    int find(int a)
+    {
+        return consistent([this, a] { return uf.find(a); });
+    }
+
+    // Same-set answer in a state between commits.
+    bool sameSet(int a, int b)
+    {
+        return consistent([this, a, b] { return uf.sameSet(a, b); });
+    }
+
+    // Every operation through the calls above, spread over the OpenMP threads (no
+    // order within the batch). Unions are immediate; range unions, where the
+    // engine has them, are immediate too.
+    void processOperations(const std::vector<Operation>& ops, std::vector<int>& results)
+    {
+        results.resize(ops.size());
+        #pragma omp parallel for schedule(static)
+        for (std::size_t i = 0; i < ops.size(); i++)
+        {
+            const Operation& op = ops[i];
+            switch (op.type)
+            {
+                case OperationType::UNION_OP: results[i] = unionSets(op.a, op.b) ? 1 : 0; break;
+                case OperationType::FIND_OP: results[i] = find(op.a); break;
+                case OperationType::SAMESET_OP: results[i] = sameSet(op.a, op.b) ? 1 : 0; break;
+                default:
+                    if constexpr (requires(UF& u) { u.unionRange(0, 0); })
+                    {
+                        results[i] = uf.unionRange(op.a, op.b) ? 1 : 0;
+                    }
+                    else
+                    {
+                        results[i] = -2; // The engine's value for an operation it could not process
+                    }
+                    break;
+            }
+        }
+    }
+
+    int size() const
+    {
+        return num_elements;
+    }
+
+    // Transactions committed so far (empty ones are not counted).
+    std::uint64_t commitCount() const
+    {
+        return commits.load(std::memory_order_relaxed);
+    }
+
+    // Reads repeated because a commit overlapped them.
+    std::uint64_t readerRetries() const
+    {
+        return retries.load(std::memory_order_relaxed);
+    }
+
+    // The wrapped engine. Reads through it may see a commit half applied.
+    UF& engine()
+    {
+        return uf;
+    }
+
+private:
+    // Makes the version odd on construction and even again on destruction.
+    class VersionBump
+    {
+    public:
+        explicit VersionBump(std::atomic<std::uint64_t>& v)
+            : v(v)
+        {
+            v.fetch_add(1, std::memory_order_acq_rel); // Odd: commit in flight
+        }
+
+        ~VersionBump()
+        {
+            v.fetch_add(1, std::memory_order_release); // Even: all of it published
+        }
+
+        VersionBump(const VersionBump&) = delete;
+        VersionBump& operator=(const VersionBump&) = delete;
+
+    private:
+        std::atomic<std::uint64_t>& v;
+    };
+
+    template <typename Read>
+    auto consistent(Read read)
+    {
+        while (true)
+        {
+            std::uint64_t before = version.load(std::memory_order_acquire);
+            if (before & 1)
+            {
+                retries.fetch_add(1, std::memory_order_relaxed);
+                std::this_thread::yield(); // The committer may share this core
+                continue;
+            }
+            auto answer = read();
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if (version.load(std::memory_order_relaxed) == before)
+            {
+                return answer;
+            }
+            retries.fetch_add(1, std::memory_order_relaxed);
+        }
+    }
+
+    UF uf;
+    int num_elements;
+    alignas(64) std::atomic<std::uint64_t> version{0}; // Odd while a commit is applying unions
+    std::mutex commit_mutex;
+    alignas(64) std::atomic<std::uint64_t> commits{0}; // Off the line readers poll
+    std::atomic<std::uint64_t> retries{0};
+};
+
+#endif // TRANSACTIONAL_UNION_FIND_HPP
@@ -2,8 +2,11 @@
 #define UNION_FIND_HPP
 
 #include <vector>
+#include <memory>  // For std::unique_ptr (range-union skip array)
 #include <cassert> // Include for assertions
-#include <numeric> // For std::iota in constructor
+#include <cstdint> // For std::uint8_t (byte-rank variant)
+#include "zeroed_buffer.hpp"
+#include "union_find_stats.hpp"
 
 // Serial Union-Find (Disjoint Set Union) Implementation with Path Compression
 // and Union by Rank. Includes basic input validation via assertions.
@@ -12,19 +15,19 @@
 class UnionFind 
 {
 public:
-    // Supported operation types.
-    enum class OperationType { UNION_OP, FIND_OP, SAMESET_OP };
+    // Supported operation types. RANGE_UNION_OP merges every element of [a, b].
+    enum class OperationType { UNION_OP, FIND_OP, SAMESET_OP, RANGE_UNION_OP };
 
     // Operation structure consistent with parallel versions.
     struct Operation 
     {
         OperationType type;
         int a;
-        int b; // Used for UNION_OP and SAMESET_OP, ignored for FIND_OP
+        int b; // Used for UNION_OP, SAMESET_OP and RANGE_UNION_OP, ignored for FIND_OP
     };
 
     // Constructs a UnionFind data structure with n elements (0 .. n-1).
-    // Precondition: n >= 0
+    // Precondition: n >= 0 (throws std::invalid_argument otherwise)
     explicit UnionFind(int n);
 
     // Finds the representative (root) of the set containing element 'a' using path compression.
@@ -40,17 +43,30 @@ public:
     // Precondition: 0 <= a < size(), 0 <= b < size()
     bool sameSet(int a, int b);
 
+    // Merges every element of [l, r] (either order) into one set.
+    // Each adjacent pair (i, i + 1) is linked at most once over the structure's
+    // lifetime: a skip array (allocated on first use) jumps over pairs an earlier
+    // range already covered, so a range costs amortized near-O(1) per new pair.
+    // Returns true if any merge occurred.
+    // Precondition: 0 <= l < size(), 0 <= r < size()
+    bool unionRange(int l, int r);
+
     // Processes a list of operations sequentially.
     // The results vector is resized to ops.size() and populated as follows:
     // - For FIND_OP: result is the root index found by find(op.a).
     // - For UNION_OP: result is 1 if unionSets(op.a, op.b) returned true (union occurred), 0 otherwise.
     // - For SAMESET_OP: result is 1 if sameSet(op.a, op.b) returned true, 0 otherwise.
+    // - For RANGE_UNION_OP: result is 1 if unionRange(op.a, op.b) returned true, 0 otherwise.
     // Precondition: For each op, 0 <= op.a < size(), and if op.type != FIND_OP, 0 <= op.b < size().
     void processOperations(const std::vector<Operation>& ops, std::vector<int>& results);
 
     // Returns the number of elements (n) the structure was initialized with.
     int size() const;
 
+    // Tree depth, rank and component-size distributions, the fraction of elements
+    // pointing directly at a root, and bytes allocated. Read-only; runs in parallel.
+    UnionFindStats introspect() const;
+
     // Destructor (default is sufficient)
     ~UnionFind() = default;
 
@@ -61,9 +77,75 @@ public:
     UnionFind& operator=(UnionFind&&) = delete;
 
 private:
-    std::vector<int> parent;
-    std::vector<int> rank;
+    // Packed parent/rank word, same encoding as the lock-free classes.
+    // If A[i] >= 0, i is a root, and A[i] is its rank.
+    // If A[i] < 0, ~A[i] is the parent index.
+    // An all-zero word is a root of rank 0, so construction is O(1).
+    // Built with UNIONFIND_BYTE_RANK, ranks live in a separate byte array
+    // instead and root words always hold make_root_val(0).
+    ZeroedBuffer<int> A;
+#ifdef UNIONFIND_BYTE_RANK
+    ZeroedBuffer<std::uint8_t> ranks;
+#endif
     int num_elements; // Store the size for bounds checking
+
+    // Range-union skip array: range_skip[i] == 0 means the pair (i, i + 1) has not
+    // been covered by a range yet; d > 0 means pairs i .. i + d - 1 all have.
+    std::unique_ptr<ZeroedBuffer<int>> range_skip;
+
+    // First uncovered pair index >= i (stops at 'limit'), compressing the jumps.
+    int next_uncovered(int i, int limit);
+
+    // Helper to check if a value represents a root (non-negative value)
+    static inline bool is_root(int val) 
+    {
+        return val >= 0;
+    }
+
+    // Helper to get the rank from a root's value
+    static inline int get_rank(int root_val) 
+    {
+        // Assumes is_root(root_val) is true
+        return root_val;
+    }
+
+    // Helper to create the value to store for a root with a given rank
+    static inline int make_root_val(int rank) 
+    {
+        return rank;
+    }
+
+    // Helper to get the parent index from a non-root's value
+    static inline int get_parent(int val) 
+    {
+        // Assumes is_root(val) is false
+        return ~val;
+    }
+
+    // Helper to create the value to store for a non-root pointing at 'parent'
+    static inline int make_parent_val(int parent) 
+    {
+        return ~parent;
+    }
+
+    // Rank accessors hiding the packed vs. byte-rank layout. 'root' must be a root.
+    inline int rank_of(int root) const 
+    {
+#ifdef UNIONFIND_BYTE_RANK
+        return ranks[root];
+#else
+        return get_rank(A[root]);
+#endif
+    }
+
+    inline void set_rank(int root, int rank) 
+    {
+#ifdef UNIONFIND_BYTE_RANK
+        ranks[root] = static_cast<std::uint8_t>(rank);
+#else
+        A[root] = make_root_val(rank);
+#endif
+    }
 };
 
 #endif // UNION_FIND_HPP
@@ -4,7 +4,9 @@
 #include <vector>
 #include <mutex>
 #include <cassert> // Include for assertions
-#include <numeric>
+#include <cstdint> // For std::uint8_t (byte-rank variant)
+#include "zeroed_buffer.hpp"
+#include "union_find_stats.hpp"
 
 // Enum to define the type of operatio
 // --- Coarse-Grained Lock Union-Find Class ---
@@ -16,6 +18,9 @@
 class UnionFindParallelCoarse 
 {
 public:
+    // find() and sameSet() may be called from several threads at once.
+    static constexpr bool thread_safe_queries = true;
+
     enum class OperationType 
     {
         UNION_OP,
@@ -32,7 +37,7 @@ public:
     };
 
     // Constructs a UnionFindParallelCoarse with n elements (0 .. n-1).
-    // Precondition: n >= 0
+    // Precondition: n >= 0 (throws std::invalid_argument otherwise)
     explicit UnionFindParallelCoarse(int n);
 
     // Finds the representative (root) of the set containing element 'a' using path compression.
@@ -63,6 +68,10 @@ public:
     // Returns the number of elements (n) the structure was initialized with.
     int size() const;
 
+    // Tree depth, rank and component-size distributions, the fraction of elements
+    // pointing directly at a root, and bytes allocated. Read-only; runs in parallel.
+    UnionFindStats introspect() const;
+
     // Destructor (default is sufficient)
     ~UnionFindParallelCoarse() = default;
 
@@ -73,11 +82,60 @@ public:
     UnionFindParallelCoarse& operator=(UnionFindParallelCoarse&&) = delete;
 
 private:
-    std::vector<int> parent;
-    std::vector<int> rank;
+    // Packed parent/rank word (see UnionFind): A[i] >= 0 marks a root with
+    // rank A[i], A[i] < 0 stores the parent index as ~A[i].
+    // With UNIONFIND_BYTE_RANK the rank is kept in 'ranks' instead.
+    ZeroedBuffer<int> A;
+#ifdef UNIONFIND_BYTE_RANK
+    ZeroedBuffer<std::uint8_t> ranks;
+#endif
     int num_elements;                   // Store the size for bounds checking
     mutable std::recursive_mutex coarse_lock; // Coarse-grained lock protecting all operations.
                                         // Recursive to allow find() called within unionSets()/sameSet() under the same lock.
                                         // Marked mutable to allow locking in const methods like size() if needed.
+
+    static inline bool is_root(int val) 
+    {
+        return val >= 0;
+    }
+
+    static inline int get_rank(int root_val) 
+    {
+        return root_val;
+    }
+
+    static inline int make_root_val(int rank) 
+    {
+        return rank;
+    }
+
+    static inline int get_parent(int val) 
+    {
+        return ~val;
+    }
+
+    static inline int make_parent_val(int parent) 
+    {
+        return ~parent;
+    }
+
+    // Rank accessors hiding the packed vs. byte-rank layout. 'root' must be a root.
+    inline int rank_of(int root) const 
+    {
+#ifdef UNIONFIND_BYTE_RANK
+        return ranks[root];
+#else
+        return get_rank(A[root]);
+#endif
+    }
+
+    inline void set_rank(int root, int rank) 
+    {
+#ifdef UNIONFIND_BYTE_RANK
+        ranks[root] = static_cast<std::uint8_t>(rank);
+#else
+        A[root] = make_root_val(rank);
+#endif
+    }
 };
 #endif // UNION_FIND_PARALLEL_COARSE_HPP
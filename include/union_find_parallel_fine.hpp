@@ -3,7 +3,9 @@
 
 #include <vector>
 #include <mutex>
-#include <numeric> // For std::iota
+#include <cstdint> // For std::uint8_t (byte-rank variant)
+#include "zeroed_buffer.hpp"
+#include "union_find_stats.hpp"
 #include <cassert> // For assertions
 #include <algorithm> // For std::min/max
 #include <memory> // For potentially managing mutexes if needed
@@ -34,7 +36,7 @@ public:
     };
 
     // Constructs a UnionFindParallelFine with n elements (0 .. n-1).
-    // Precondition: n >= 0
+    // Precondition: n >= 0 (throws std::invalid_argument otherwise)
     explicit UnionFindParallelFine(int n);
 
     // Finds the representative (root) of the set containing element 'a'.
@@ -67,6 +69,10 @@ public:
     // Returns the number of elements (n) the structure was initialized with.
     int size() const;
 
+    // Tree depth, rank and component-size distributions, the fraction of elements
+    // pointing directly at a root, and bytes allocated. Read-only; runs in parallel.
+    UnionFindStats introspect() const;
+
     // Destructor (default is sufficient)
     ~UnionFindParallelFine() = default;
 
@@ -81,12 +87,62 @@ private:
     // Helper function for find without path compression, used during locked verification.
     int find_root_no_compression(int a) const;
 
-    std::vector<int> parent;
-    std::vector<int> rank;
+    // Packed parent/rank word (see UnionFind): A[i] >= 0 marks a root with
+    // rank A[i], A[i] < 0 stores the parent index as ~A[i]. A root check is a single load.
+    // With UNIONFIND_BYTE_RANK the rank is kept in 'ranks' instead.
+    ZeroedBuffer<int> A;
+#ifdef UNIONFIND_BYTE_RANK
+    ZeroedBuffer<std::uint8_t> ranks;
+#endif
     int num_elements;
     // Vector of mutexes, one for each potential root.
     // std::vector<std::mutex> works in C++11 and later for default construction.
     mutable std::vector<std::mutex> locks;
+
+    static inline bool is_root(int val) 
+    {
+        return val >= 0;
+    }
+
+    static inline int get_rank(int root_val) 
+    {
+        return root_val;
+    }
+
+    static inline int make_root_val(int rank) 
+    {
+        return rank;
+    }
+
+    static inline int get_parent(int val) 
+    {
+        return ~val;
+    }
+
+    static inline int make_parent_val(int parent) 
+    {
+        return ~parent;
+    }
+
+    // Rank accessors hiding the packed vs. byte-rank layout.
+    // Only called on roots whose lock is held.
+    inline int rank_of(int root) const 
+    {
+#ifdef UNIONFIND_BYTE_RANK
+        return ranks[root];
+#else
+        return get_rank(A[root]);
+#endif
+    }
+
+    inline void set_rank(int root, int rank) 
+    {
+#ifdef UNIONFIND_BYTE_RANK
+        ranks[root] = static_cast<std::uint8_t>(rank);
+#else
+        A[root] = make_root_val(rank);
+#endif
+    }
 };
 
 #endif // UNION_FIND_PARALLEL_FINE_HPP
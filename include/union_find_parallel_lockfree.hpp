@@ -3,6 +3,15 @@
 
 #include <vector>
 #include <atomic>
+#include <memory> // For std::unique_ptr
+#include <mutex>  // For std::once_flag
+#include <cstdint>
+#include "zeroed_buffer.hpp"
+#include "union_find_stats.hpp"
+#include "root_hint_cache.hpp"
+#include "timeline_trace.hpp"
+#include "hot_element_profiler.hpp"
+#include "merge_event_stream.hpp"
 #include <numeric> // For std::iota
 #include <stdexcept> // For std::runtime_error
 
@@ -13,29 +22,69 @@ class UnionFindParallelLockFree
 private:
 
     // Represents the parent/rank information.
-    // If A[i] >= 0, it's the parent index.
-    // If A[i] < 0, i is a root, and -(A[i] + 1) is its rank.
+    // If A[i] >= 0, i is a root, and A[i] is its rank.
+    // If A[i] < 0, ~A[i] is the parent index.
+    // An all-zero word is a root of rank 0, so the zeroed buffer needs no init pass.
     int n_elements;
-    std::vector<std::atomic<int>> A;
+    ZeroedBuffer<std::atomic<int>> A;
+    static_assert(sizeof(std::atomic<int>) == sizeof(int) && std::atomic<int>::is_always_lock_free,
+                  "Zero-filled memory must be a valid std::atomic<int> array.");
 
-    // Helper to check if a value represents a root (negative value)
+    // Number of processOperations batches in flight; load indicator for background work.
+    std::atomic<int> active_batches{0};
+
+    // Optional thread-local root hints (see RootHintCache); off by default.
+    bool root_hints = false;
+    std::uint32_t hint_owner; // Tags this instance's entries in the per-thread caches
+
+    // Optional per-thread timeline of processOperations batches; null when off.
+    TimelineTrace* timeline = nullptr;
+
+    // Optional sampling hot-element profiler; null when off.
+    HotElementProfiler* profiler = nullptr;
+
+    // Optional change-data-capture stream of successful links; null when off.
+    MergeEventStream* merge_events = nullptr;
+
+    // Range-union skip array, allocated by the first unionRange(): 0 means the pair
+    // (i, i + 1) is unclaimed; RANGE_CLAIMED means a range claimed it and may still be
+    // linking it; d > 0 means pairs i .. i + d - 1 have all been linked. Entries only
+    // ever go 0 -> RANGE_CLAIMED -> 1 and then grow.
+    std::unique_ptr<ZeroedBuffer<std::atomic<int>>> range_skip;
+    static constexpr int RANGE_CLAIMED = -1;
+    std::once_flag range_skip_once;
+
+    // Helper to check if a value represents a root (non-negative value)
     // Corresponds to isRank() in the pseudocode, but checks the value itself
     static inline bool is_root(int val) 
     {
-        return val < 0;
+        return val >= 0;
     }
 
     // Helper to get the rank from a root's value
     static inline int get_rank(int root_val) 
     {
         // Assumes is_root(root_val) is true
-        return -(root_val + 1);
+        return root_val;
     }
 
     // Helper to create the value to store for a root with a given rank
     static inline int make_root_val(int rank) 
     {
-        return -(rank + 1);
+        return rank;
+    }
+
+    // Helper to get the parent index from a non-root's value
+    static inline int get_parent(int val) 
+    {
+        // Assumes is_root(val) is false
+        return ~val;
+    }
+
+    // Helper to create the value to store for a non-root pointing at 'parent'
+    static inline int make_parent_val(int parent) 
+    {
+        return ~parent;
     }
 
     // Internal find operation with path compression.
@@ -44,12 +93,23 @@ private:
     // but simplified to only return the root, rank is handled separately if needed.
     std::pair<int, int> find_internal(int u);
 
+    // Parent hops from u to its root, without compressing (probe argument only).
+    int path_length(int u) const;
+
+    // find_internal(u).first, answered from the calling thread's RootHintCache when
+    // the cached root is still a root; refreshes the entry otherwise.
+    int find_hinted(int u);
+
 public:
+    // find() and sameSet() may be called from several threads at once.
+    static constexpr bool thread_safe_queries = true;
+
     enum class OperationType 
     {
         UNION_OP,
         FIND_OP,
-        SAMESET_OP // Check if two elements are in the same set
+        SAMESET_OP, // Check if two elements are in the same set
+        RANGE_UNION_OP // Merge every element of [a, b]
     };
 
     // Structure to represent an operation
@@ -57,10 +117,10 @@ public:
     {
         OperationType type;
         int a;
-        int b; // Ignored for FIND_OP
+        int b; // Ignored for FIND_OP; last element of the range for RANGE_UNION_OP
     };
     // Constructs a UnionFindParallelLockFree with n elements (0 .. n-1).
-    // Precondition: n >= 0
+    // Precondition: n >= 0 (throws std::invalid_argument otherwise)
     explicit UnionFindParallelLockFree(int n);
 
     // Finds the representative (root) of the set containing element 'a'.
@@ -78,19 +138,61 @@ public:
     // Corresponds to the SameSet function in the pseudocode (lines 25-30)
     bool sameSet(int a, int b);
 
+    // Merges every element of [l, r] (either order) into one set. Each adjacent
+    // pair (i, i + 1) is claimed by one range over the structure's lifetime (CAS on
+    // a skip array), which links it and then marks it linked, so overlapping ranges
+    // share the work instead of repeating it. A range that meets a pair claimed but
+    // not yet marked links it too (union is idempotent) instead of skipping it, so
+    // [l, r] is one set when the call returns, whatever other ranges are doing.
+    // Returns true if this call merged anything (false: every pair was already
+    // connected when this call reached it).
+    bool unionRange(int l, int r);
+
     // Processes a list of operations in parallel using OpenMP.
     // Each thread calls the lock-free find/unionSets/sameSet methods.
     // Results vector will be resized and populated.
     // For FIND_OP, result is the root.
     // For UNION_OP, result is 1 if union occurred, 0 otherwise.
     // For SAMESET_OP, result is 1 if they are in the same set, 0 otherwise.
+    // For RANGE_UNION_OP, result is 1 if unionRange() merged anything, 0 otherwise.
     // Precondition: For each op, 0 <= op.a < size(), and if op.type != FIND_OP, 0 <= op.b < size().
     void processOperations(const std::vector<Operation>& ops, std::vector<int>& results);
 
     // Returns the number of elements (n) the structure was initialized with.
     int size() const;
 
-    // Destructor (default is sufficient as std::vector and std::atomic manage their own resources)
+    // Tree depth, rank and component-size distributions, the fraction of elements
+    // pointing directly at a root, and bytes allocated. Read-only; runs in parallel.
+    UnionFindStats introspect() const;
+
+    // Compresses every element in [begin, end) so it points directly at its root.
+    // Safe to call concurrently with all other operations (used by BackgroundCompactor).
+    // Returns the number of elements that were not already pointing at a root.
+    int compactRange(int begin, int end);
+
+    // True while at least one processOperations batch is running.
+    bool isBusy() const;
+
+    // Enables/disables the thread-local root hint cache for find() and sameSet().
+    // Toggle only while no operations are running. Hit/miss counters are kept
+    // per thread in RootHintCache::local().
+    void setRootHints(bool enabled);
+    bool rootHintsEnabled() const;
+
+    // Records the timeline of subsequent processOperations batches into 'trace'
+    // (nullptr turns it off). Set only while no operations are running; the trace
+    // must outlive its use here.
+    void setTimeline(TimelineTrace* trace);
+
+    // Feeds element/root accesses and link-CAS failures of subsequent operations into
+    // 'hot_profiler' (nullptr turns it off). Same rules as setTimeline().
+    void setProfiler(HotElementProfiler* hot_profiler);
+
+    // Emits a MergeEvent{new root, absorbed root} for every successful link of
+    // subsequent unions into 'stream' (nullptr turns it off). Same rules as setTimeline().
+    void setMergeEvents(MergeEventStream* stream);
+
+    // Destructor (default is sufficient as ZeroedBuffer releases its own storage)
     ~UnionFindParallelLockFree() = default;
 
     // Disable copy and move semantics for simplicity, as copying atomics needs care
@@ -98,6 +200,13 @@ public:
     UnionFindParallelLockFree& operator=(const UnionFindParallelLockFree&) = delete;
     UnionFindParallelLockFree(UnionFindParallelLockFree&&) = delete;
     UnionFindParallelLockFree& operator=(UnionFindParallelLockFree&&) = delete;
+
+private:
+    // Runs one operation of a batch; errors are reported and stored as -1/-2.
+    void process_op(const Operation& op, int& result, size_t i);
+
+    // First pair index >= i not yet marked linked (stops at 'limit'), raising the visited jumps.
+    int next_unlinked(int i, int limit);
 };
 
 #endif // UNION_FIND_PARALLEL_LOCKFREE_HPP
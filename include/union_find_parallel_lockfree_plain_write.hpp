@@ -3,6 +3,12 @@
 
 #include <vector>
 #include <atomic>
+#include <cstdint>
+#include "zeroed_buffer.hpp"
+#include "union_find_stats.hpp"
+#include "root_hint_cache.hpp"
+#include "timeline_trace.hpp"
+#include "hot_element_profiler.hpp"
 #include <utility> // For std::pair
 #include <stdexcept>
 
@@ -12,28 +18,57 @@ class UnionFindParallelLockFreePlainWrite
 {
 private:
     // Represents the parent/rank information.
-    // If A[i] >= 0, it's the parent index.
-    // If A[i] < 0, i is a root, and -(A[i] + 1) is its rank.
+    // If A[i] >= 0, i is a root, and A[i] is its rank.
+    // If A[i] < 0, ~A[i] is the parent index.
+    // An all-zero word is a root of rank 0, so the zeroed buffer needs no init pass.
     int n_elements;
-    std::vector<std::atomic<int>> A;
+    ZeroedBuffer<std::atomic<int>> A;
+    static_assert(sizeof(std::atomic<int>) == sizeof(int) && std::atomic<int>::is_always_lock_free,
+                  "Zero-filled memory must be a valid std::atomic<int> array.");
 
-    // Helper to check if a value represents a root (negative value)
+    // Number of processOperations batches in flight; load indicator for background work.
+    std::atomic<int> active_batches{0};
+
+    // Optional thread-local root hints (see RootHintCache); off by default.
+    bool root_hints = false;
+    std::uint32_t hint_owner; // Tags this instance's entries in the per-thread caches
+
+    // Optional per-thread timeline of processOperations batches; null when off.
+    TimelineTrace* timeline = nullptr;
+
+    // Optional sampling hot-element profiler; null when off.
+    HotElementProfiler* profiler = nullptr;
+
+    // Helper to check if a value represents a root (non-negative value)
     static inline bool is_root(int val) 
     {
-        return val < 0;
+        return val >= 0;
     }
 
     // Helper to get the rank from a root's value
     static inline int get_rank(int root_val) 
     {
         // Assumes is_root(root_val) is true
-        return -(root_val + 1);
+        return root_val;
     }
 
     // Helper to create the value to store for a root with a given rank
     static inline int make_root_val(int rank) 
     {
-        return -(rank + 1);
+        return rank;
+    }
+
+    // Helper to get the parent index from a non-root's value
+    static inline int get_parent(int val) 
+    {
+        // Assumes is_root(val) is false
+        return ~val;
+    }
+
+    // Helper to create the value to store for a non-root pointing at 'parent'
+    static inline int make_parent_val(int parent) 
+    {
+        return ~parent;
     }
 
     // Internal find operation matching pseudocode structure.
@@ -41,8 +76,18 @@ private:
     // Performs path compression using relaxed writes (Optimization).
     std::pair<int, int> find_internal(int u);
 
+    // Parent hops from u to its root, without compressing (probe argument only).
+    int path_length(int u) const;
+
+    // find_internal(u).first, answered from the calling thread's RootHintCache when
+    // the cached root is still a root; refreshes the entry otherwise.
+    int find_hinted(int u);
+
 
 public:
+    // find() and sameSet() may be called from several threads at once.
+    static constexpr bool thread_safe_queries = true;
+
     enum class OperationType {
         UNION_OP,
         FIND_OP,
@@ -56,7 +101,7 @@ public:
         int b; // Ignored for FIND_OP
     };
     // Constructs a UnionFindParallelLockFreePlainWrite with n elements (0 .. n-1).
-    // Precondition: n >= 0
+    // Precondition: n >= 0 (throws std::invalid_argument otherwise)
     explicit UnionFindParallelLockFreePlainWrite(int n);
 
     // Finds the representative (root) of the set containing element 'a'.
@@ -84,6 +129,33 @@ public:
     // Returns the number of elements (n) the structure was initialized with.
     int size() const;
 
+    // Tree depth, rank and component-size distributions, the fraction of elements
+    // pointing directly at a root, and bytes allocated. Read-only; runs in parallel.
+    UnionFindStats introspect() const;
+
+    // Compresses every element in [begin, end) so it points directly at its root.
+    // Safe to call concurrently with all other operations (used by BackgroundCompactor).
+    // Returns the number of elements that were not already pointing at a root.
+    int compactRange(int begin, int end);
+
+    // True while at least one processOperations batch is running.
+    bool isBusy() const;
+
+    // Enables/disables the thread-local root hint cache for find() and sameSet().
+    // Toggle only while no operations are running. Hit/miss counters are kept
+    // per thread in RootHintCache::local().
+    void setRootHints(bool enabled);
+    bool rootHintsEnabled() const;
+
+    // Records the timeline of subsequent processOperations batches into 'trace'
+    // (nullptr turns it off). Set only while no operations are running; the trace
+    // must outlive its use here.
+    void setTimeline(TimelineTrace* trace);
+
+    // Feeds element/root accesses and link-CAS failures of subsequent operations into
+    // 'hot_profiler' (nullptr turns it off). Same rules as setTimeline().
+    void setProfiler(HotElementProfiler* hot_profiler);
+
     // Destructor (default is sufficient)
     ~UnionFindParallelLockFreePlainWrite() = default;
 
@@ -92,6 +164,10 @@ public:
     UnionFindParallelLockFreePlainWrite& operator=(const UnionFindParallelLockFreePlainWrite&) = delete;
     UnionFindParallelLockFreePlainWrite(UnionFindParallelLockFreePlainWrite&&) = delete;
     UnionFindParallelLockFreePlainWrite& operator=(UnionFindParallelLockFreePlainWrite&&) = delete;
+
+private:
+    // Runs one operation of a batch; errors are reported and stored as -1/-2.
+    void process_op(const Operation& op, int& result, size_t i);
 };
 
 #endif // UNION_FIND_PARALLEL_LOCKFREE_PLAIN_WRITE_HPP
@@ -0,0 +1,124 @@
+#ifndef UNION_FIND_PHASED_HPP
+#define UNION_FIND_PHASED_HPP
+
+#include <vector>
+#include <atomic>  // For std::atomic_ref
+#include <utility> // For std::pair
+#include <cstdint>
+#include "zeroed_buffer.hpp"
+#include "union_find_stats.hpp"
+
+// Union-Find for jobs that alternate single-threaded and parallel phases.
+// One plain int array holds the packed parent/rank words (same encoding as
+// UnionFind and the lock-free classes). Sequential phases run the serial kernels
+// (plain loads and stores, full path compression). Between beginParallel() and
+// endParallel() the same memory is accessed through std::atomic_ref with the
+// lock-free CAS kernels, so any number of threads may call the operations.
+// Switching phases copies nothing; the OpenMP fork/join (or whatever else orders
+// the switching thread against the workers) separates plain from atomic accesses.
+class UnionFindPhased
+{
+public:
+    // Supported operation types (same values as UnionFind).
+    enum class OperationType { UNION_OP, FIND_OP, SAMESET_OP };
+
+    struct Operation
+    {
+        OperationType type;
+        int a;
+        int b; // Used for UNION_OP and SAMESET_OP, ignored for FIND_OP
+    };
+
+    // Constructs a UnionFindPhased with n elements (0 .. n-1), in a sequential phase.
+    // Precondition: n >= 0 (throws std::invalid_argument otherwise)
+    explicit UnionFindPhased(int n);
+
+    // Switches to the atomic kernels. Throws std::logic_error if already parallel.
+    // Call from one thread while no operations are running.
+    void beginParallel();
+
+    // Switches back to the plain kernels. Throws std::logic_error if not parallel.
+    // Call from one thread after every thread of the parallel phase has finished.
+    void endParallel();
+
+    // True between beginParallel() and endParallel().
+    bool inParallelPhase() const;
+
+    // Finds the representative (root) of the set containing element 'a'.
+    // Thread-safe only in a parallel phase.
+    // Precondition: 0 <= a < size()
+    int find(int a);
+
+    // Merges the sets that contain elements 'a' and 'b' (union by rank).
+    // Returns true if a merge occurred; false if they were already in the same set.
+    // Thread-safe only in a parallel phase.
+    // Precondition: 0 <= a < size(), 0 <= b < size()
+    bool unionSets(int a, int b);
+
+    // Checks if elements 'a' and 'b' are in the same set.
+    // Thread-safe only in a parallel phase.
+    // Precondition: 0 <= a < size(), 0 <= b < size()
+    bool sameSet(int a, int b);
+
+    // Processes a list of operations (same result convention as UnionFind):
+    // sequentially in order in a sequential phase, spread over the OpenMP threads
+    // (no order within the batch, as in the lock-free classes) in a parallel phase.
+    void processOperations(const std::vector<Operation>& ops, std::vector<int>& results);
+
+    // Returns the number of elements (n) the structure was initialized with.
+    int size() const;
+
+    // Tree depth, rank and component-size distributions, the fraction of elements
+    // pointing directly at a root, and bytes allocated. Read-only; runs in parallel.
+    UnionFindStats introspect() const;
+
+    ~UnionFindPhased() = default;
+
+    UnionFindPhased(const UnionFindPhased&) = delete;
+    UnionFindPhased& operator=(const UnionFindPhased&) = delete;
+    UnionFindPhased(UnionFindPhased&&) = delete;
+    UnionFindPhased& operator=(UnionFindPhased&&) = delete;
+
+private:
+    // Packed parent/rank word: A[i] >= 0 means i is a root of rank A[i];
+    // A[i] < 0 means ~A[i] is the parent index. All-zero is n roots of rank 0.
+    ZeroedBuffer<int> A;
+    int num_elements;
+    bool parallel = false;
+
+    static_assert(std::atomic_ref<int>::is_always_lock_free, "Parallel phases need lock-free int atomics.");
+    static_assert(std::atomic_ref<int>::required_alignment <= alignof(int),
+                  "Plain int storage must be valid for std::atomic_ref<int>.");
+
+    static inline bool is_root(int val)
+    {
+        return val >= 0;
+    }
+
+    static inline int get_parent(int val)
+    {
+        return ~val;
+    }
+
+    static inline int make_parent_val(int parent)
+    {
+        return ~parent;
+    }
+
+    inline std::atomic_ref<int> word(int i)
+    {
+        return std::atomic_ref<int>(A[i]);
+    }
+
+    // Sequential-phase kernels: plain accesses, as in UnionFind.
+    int find_plain(int a);
+    bool union_plain(int a, int b);
+
+    // Parallel-phase kernels: CAS on atomic_ref, as in UnionFindParallelLockFree.
+    // find_atomic returns the root and its word as last read.
+    std::pair<int, int> find_atomic(int u);
+    bool union_atomic(int a, int b);
+    bool same_set_atomic(int a, int b);
+};
+
+#endif // UNION_FIND_PHASED_HPP
@@ -0,0 +1,361 @@
+#ifndef UNION_FIND_POOL_HPP
+#define UNION_FIND_POOL_HPP
+
+#include <vector>
+#include <atomic>
+#include <memory>
+#include <cassert>
+#include <cstdint>
+#include <cstddef>
+#include <stdexcept>
+#include <omp.h>
+#include "zeroed_buffer.hpp"
+
+// --- Union-Find Pool ---
+
+// Many small, independent Union-Find instances carved out of one arena
+// allocation, for workloads made of thousands of tiny partitions (one per request)
+// where allocating a structure per job costs more than the job itself.
+//
+// Every instance is a slice of a single ZeroedBuffer<int> using the packed
+// encoding of UnionFind (A[i] >= 0: root of rank A[i], A[i] < 0: parent ~A[i]),
+// so a fresh slice is already n singleton roots. A word only leaves zero when its
+// root is linked or bumped (path compression rewrites words that are already
+// negative), so link() logs those words in a parallel slice of a second arena and
+// reset() zeroes only them: O(touched) instead of O(n).
+//
+// processJobs() runs a batch of (instance, operations) jobs across OpenMP threads.
+// Instances never share memory, so each job runs the plain serial kernel (same
+// results as UnionFind::processOperations) with no atomics. Jobs are split into one
+// contiguous range per thread; a thread that finishes its range steals the next
+// job of the other ranges, so a few large jobs do not leave threads idle.
+class UnionFindPool
+{
+public:
+    // Same operation types and result convention as UnionFind.
+    enum class OperationType { UNION_OP, FIND_OP, SAMESET_OP };
+
+    struct Operation
+    {
+        OperationType type;
+        int a;
+        int b; // Used for UNION_OP and SAMESET_OP, ignored for FIND_OP
+    };
+
+    // One job: run 'ops' on 'instance' and write the results to '*results' (resized).
+    struct Job
+    {
+        int instance;
+        const std::vector<Operation>* ops;
+        std::vector<int>* results;
+    };
+
+    // arena_elements: total elements of all instances this pool can hold.
+    explicit UnionFindPool(std::size_t arena_elements)
+        : arena(arena_elements), touched_log(arena_elements)
+    {
+    }
+
+    UnionFindPool(const UnionFindPool&) = delete;
+    UnionFindPool& operator=(const UnionFindPool&) = delete;
+    UnionFindPool(UnionFindPool&&) = delete;
+    UnionFindPool& operator=(UnionFindPool&&) = delete;
+
+    // Carves an instance of n elements (all singletons) and returns its id.
+    // Throws std::length_error when the arena is full. Not thread-safe.
+    int createInstance(int n)
+    {
+        if (n < 0)
+        {
+            throw std::invalid_argument("Number of elements cannot be negative.");
+        }
+        if (used + static_cast<std::size_t>(n) > arena.size())
+        {
+            throw std::length_error("UnionFindPool arena exhausted.");
+        }
+        instances.push_back(Instance{used, n, 0});
+        used += static_cast<std::size_t>(n);
+        return static_cast<int>(instances.size()) - 1;
+    }
+
+    // Single-instance operations (serial kernel; one thread per instance at a time).
+    int find(int id, int a)
+    {
+        Instance& inst = instance(id);
+        assert(a >= 0 && a < inst.n && "Element index out of bounds in find().");
+        Slice s = slice(inst);
+        return find_root(s, a);
+    }
+
+    bool unionSets(int id, int a, int b)
+    {
+        Instance& inst = instance(id);
+        assert(a >= 0 && a < inst.n && "Element index 'a' out of bounds in unionSets().");
+        assert(b >= 0 && b < inst.n && "Element index 'b' out of bounds in unionSets().");
+        Slice s = slice(inst);
+        bool merged = link(s, a, b);
+        inst.touched = s.touched;
+        return merged;
+    }
+
+    bool sameSet(int id, int a, int b)
+    {
+        Instance& inst = instance(id);
+        assert(a >= 0 && a < inst.n && "Element index 'a' out of bounds in sameSet().");
+        assert(b >= 0 && b < inst.n && "Element index 'b' out of bounds in sameSet().");
+        Slice s = slice(inst);
+        return find_root(s, a) == find_root(s, b);
+    }
+
+    // Runs 'ops' on one instance (same results as UnionFind::processOperations).
+    void processOperations(int id, const std::vector<Operation>& ops, std::vector<int>& results)
+    {
+        run_ops(instance(id), ops, results);
+    }
+
+    // Runs every job of the batch in parallel with work stealing. Each instance may
+    // appear in at most one job of a batch (throws std::invalid_argument otherwise).
+    void processJobs(const std::vector<Job>& jobs)
+    {
+        std::vector<unsigned char> seen(instances.size(), 0);
+        for (const Job& job : jobs)
+        {
+            instance(job.instance);
+            if (seen[job.instance]++)
+            {
+                throw std::invalid_argument("An instance appears in two jobs of one batch.");
+            }
+        }
+
+        const int threads = omp_get_max_threads();
+        auto ranges = std::make_unique<JobRange[]>(threads);
+        for (int t = 0; t < threads; t++)
+        {
+            ranges[t].next.store(jobs.size() * t / threads, std::memory_order_relaxed);
+            ranges[t].end = jobs.size() * (t + 1) / threads;
+        }
+
+        std::uint64_t stolen = 0;
+        #pragma omp parallel num_threads(threads) reduction(+ : stolen)
+        {
+            const int self = omp_get_thread_num();
+            for (int k = 0; k < threads; k++)
+            {
+                JobRange& range = ranges[(self + k) % threads];
+                for (std::size_t j = range.next.fetch_add(1, std::memory_order_relaxed); j < range.end;
+                     j = range.next.fetch_add(1, std::memory_order_relaxed))
+                {
+                    const Job& job = jobs[j];
+                    run_ops(instances[job.instance], *job.ops, *job.results);
+                    stolen += k > 0 ? 1 : 0;
+                }
+            }
+        }
+        last_steals = stolen;
+    }
+
+    // Returns the instance to n singletons, touching only the words it wrote.
+    void reset(int id)
+    {
+        Instance& inst = instance(id);
+        int* A = arena.data() + inst.offset;
+        const int* log = touched_log.data() + inst.offset;
+        for (int k = 0; k < inst.touched; k++)
+        {
+            A[log[k]] = 0;
+        }
+        inst.touched = 0;
+    }
+
+    // reset() for every instance, in parallel.
+    void resetAll()
+    {
+        #pragma omp parallel for schedule(dynamic, 64)
+        for (std::size_t id = 0; id < instances.size(); id++)
+        {
+            reset(static_cast<int>(id));
+        }
+    }
+
+    int instanceCount() const
+    {
+        return static_cast<int>(instances.size());
+    }
+
+    int instanceSize(int id) const
+    {
+        return instance(id).n;
+    }
+
+    // Words written since the instance was created or last reset.
+    std::size_t touchedCount(int id) const
+    {
+        return static_cast<std::size_t>(instance(id).touched);
+    }
+
+    // Arena elements handed out / available in total.
+    std::size_t usedElements() const
+    {
+        return used;
+    }
+
+    std::size_t capacity() const
+    {
+        return arena.size();
+    }
+
+    // Jobs of the last processJobs() batch that ran on a thread other than their owner.
+    std::uint64_t lastBatchSteals() const
+    {
+        return last_steals;
+    }
+
+private:
+    struct Instance
+    {
+        std::size_t offset; // First element in the arena (and in touched_log)
+        int n;
+        int touched;        // Entries of touched_log in use since the last reset
+    };
+
+    // One thread's share of a batch; the cursor is shared with thieves.
+    struct alignas(64) JobRange
+    {
+        std::atomic<std::size_t> next{0};
+        std::size_t end = 0;
+    };
+
+    Instance& instance(int id)
+    {
+        if (id < 0 || id >= static_cast<int>(instances.size()))
+        {
+            throw std::out_of_range("Invalid UnionFindPool instance id.");
+        }
+        return instances[id];
+    }
+
+    const Instance& instance(int id) const
+    {
+        if (id < 0 || id >= static_cast<int>(instances.size()))
+        {
+            throw std::out_of_range("Invalid UnionFindPool instance id.");
+        }
+        return instances[id];
+    }
+
+    // Working view of one instance. Kernels run on a local copy so the compiler can
+    // keep the pointers and the log cursor in registers across the stores to A.
+    struct Slice
+    {
+        int* A;      // Packed parent/rank words
+        int* log;    // Touched-word log
+        int touched; // Entries of log in use
+    };
+
+    Slice slice(const Instance& inst)
+    {
+        return Slice{arena.data() + inst.offset, touched_log.data() + inst.offset, inst.touched};
+    }
+
+    // Logs root i before link() changes it if it still holds its initial 0.
+    // Stored values are never 0 again (parents are ~p < 0, bumped ranks >= 1),
+    // so every word is logged at most once and the log never exceeds n entries.
+    static inline void log_root(Slice& s, int i)
+    {
+        if (s.A[i] == 0)
+        {
+            s.log[s.touched++] = i;
+        }
+    }
+
+    // Root of 'a' with path halving (one pass). Roots depend only on the order of
+    // the links, so results match UnionFind's full compression exactly.
+    static int find_root(Slice& s, int a)
+    {
+        int* A = s.A;
+        while (A[a] < 0)
+        {
+            int p = ~A[a];
+            int gp = A[p];
+            if (gp >= 0)
+            {
+                return p;
+            }
+            A[a] = gp; // Skip to the grandparent (already a parent encoding).
+            a = ~gp;
+        }
+        return a;
+    }
+
+    // Union by rank with the same tie rule as UnionFind (rootA wins ties).
+    static bool link(Slice& s, int a, int b)
+    {
+        int* A = s.A;
+        int root_a = find_root(s, a);
+        int root_b = find_root(s, b);
+        if (root_a == root_b)
+        {
+            return false;
+        }
+        int rank_a = A[root_a];
+        int rank_b = A[root_b];
+        if (rank_a < rank_b)
+        {
+            log_root(s, root_a);
+            A[root_a] = ~root_b;
+        }
+        else if (rank_a > rank_b)
+        {
+            log_root(s, root_b);
+            A[root_b] = ~root_a;
+        }
+        else
+        {
+            log_root(s, root_b);
+            log_root(s, root_a);
+            A[root_b] = ~root_a;
+            A[root_a] = rank_a + 1;
+        }
+        return true;
+    }
+
+    void run_ops(Instance& inst, const std::vector<Operation>& ops, std::vector<int>& results)
+    {
+        results.resize(ops.size());
+        Slice s = slice(inst);
+        [[maybe_unused]] const int n = inst.n;
+        int* out = results.data();
+        for (std::size_t i = 0; i < ops.size(); i++)
+        {
+            const Operation& op = ops[i];
+            assert(op.a >= 0 && op.a < n && "Operation element 'a' out of bounds.");
+            assert((op.type == OperationType::FIND_OP || (op.b >= 0 && op.b < n)) &&
+                   "Operation element 'b' out of bounds.");
+            switch (op.type)
+            {
+                case OperationType::UNION_OP:
+                    out[i] = link(s, op.a, op.b) ? 1 : 0;
+                    break;
+                case OperationType::FIND_OP:
+                    out[i] = find_root(s, op.a);
+                    break;
+                case OperationType::SAMESET_OP:
+                    out[i] = find_root(s, op.a) == find_root(s, op.b) ? 1 : 0;
+                    break;
+                default:
+                    assert(false && "Unknown operation type encountered.");
+                    out[i] = -2;
+                    break;
+            }
+        }
+        inst.touched = s.touched;
+    }
+
+    ZeroedBuffer<int> arena;
+    ZeroedBuffer<int> touched_log; // Per-instance log of words that left zero
+    std::size_t used = 0;
+    std::vector<Instance> instances;
+    std::uint64_t last_steals = 0;
+};
+
+#endif // UNION_FIND_POOL_HPP
@@ -0,0 +1,69 @@
+#ifndef UNION_FIND_PROBES_HPP
+#define UNION_FIND_PROBES_HPP
+
+// --- USDT Static Tracepoints ---
+
+// Probes (provider "unionfind") on the hot paths of the lock-free engines, for
+// attaching bpftrace/perf to a running process without rebuilding. They are
+// compiled in when UNIONFIND_USDT_ENABLED is set (Makefile USDT=1) and
+// <sys/sdt.h> is found; that header is all it takes, there is no runtime
+// library. An unattached probe is a single nop in the instruction stream.
+//
+// Path lengths are not free to compute, so the probes carrying them are gated
+// by their USDT semaphore: the tracer increments it on attach, and the extra
+// walk only runs while somebody is listening.
+//
+// Probes and arguments (in order):
+//   find         element, root, path_len
+//   union_link   a, b, root, child, path_len, retries   root: surviving root, child: root linked under it
+//   union_fail   a, b, root, path_len, retries          a and b already in the same set
+//   union_retry  a, b, root_a, root_b, retries          a root moved or the link CAS was lost
+//   compress     element, root, old_parent              a path-compression write succeeded
+//   batch_start  engine, num_ops                        processOperations() entry ('engine' is this)
+//   batch_end    engine, num_ops                        processOperations() exit
+// path_len is the number of parent hops from the element(s) to the root(s)
+// before the operation compresses them.
+//
+// Example scripts live in scripts/usdt_*.bt.
+
+#if defined(UNIONFIND_USDT_ENABLED) && __has_include(<sys/sdt.h>)
+
+#define _SDT_HAS_SEMAPHORES 1
+#include <sys/sdt.h>
+
+#define UNIONFIND_HAS_USDT 1
+
+// Semaphores are defined in src/union_find_probes.cpp.
+#define UF_DECLARE_PROBE_SEMAPHORE(name) \
+    extern unsigned short unionfind_##name##_semaphore __attribute__((section(".probes")))
+
+UF_DECLARE_PROBE_SEMAPHORE(find);
+UF_DECLARE_PROBE_SEMAPHORE(union_link);
+UF_DECLARE_PROBE_SEMAPHORE(union_fail);
+UF_DECLARE_PROBE_SEMAPHORE(union_retry);
+UF_DECLARE_PROBE_SEMAPHORE(compress);
+UF_DECLARE_PROBE_SEMAPHORE(batch_start);
+UF_DECLARE_PROBE_SEMAPHORE(batch_end);
+
+// True while a tracer is attached to probe 'name'.
+#define UF_PROBE_ENABLED(name) __builtin_expect(unionfind_##name##_semaphore != 0, 0)
+
+#define UF_PROBE2(name, a1, a2) DTRACE_PROBE2(unionfind, name, a1, a2)
+#define UF_PROBE3(name, a1, a2, a3) DTRACE_PROBE3(unionfind, name, a1, a2, a3)
+#define UF_PROBE5(name, a1, a2, a3, a4, a5) DTRACE_PROBE5(unionfind, name, a1, a2, a3, a4, a5)
+#define UF_PROBE6(name, a1, a2, a3, a4, a5, a6) DTRACE_PROBE6(unionfind, name, a1, a2, a3, a4, a5, a6)
+
+#else
+
+// Probes compiled out: arguments are only referenced so locals kept for them do not warn.
+#define UF_PROBE_ENABLED(name) false
+#define UF_PROBE2(name, a1, a2) do { (void)(a1); (void)(a2); } while (0)
+#define UF_PROBE3(name, a1, a2, a3) do { (void)(a1); (void)(a2); (void)(a3); } while (0)
+#define UF_PROBE5(name, a1, a2, a3, a4, a5) \
+    do { (void)(a1); (void)(a2); (void)(a3); (void)(a4); (void)(a5); } while (0)
+#define UF_PROBE6(name, a1, a2, a3, a4, a5, a6) \
+    do { (void)(a1); (void)(a2); (void)(a3); (void)(a4); (void)(a5); (void)(a6); } while (0)
+
+#endif
+
+#endif // UNION_FIND_PROBES_HPP
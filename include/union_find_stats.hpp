@@ -0,0 +1,183 @@
+#ifndef UNION_FIND_STATS_HPP
+#define UNION_FIND_STATS_HPP
+
+#include <vector>
+#include <atomic>
+#include <cstdint>
+#include <cstddef>
+#include <ostream>
+#include <iomanip>
+#include <algorithm> // For std::max
+#include <utility>   // For std::move
+
+// --- Structure Introspection ---
+
+// Snapshot of a Union-Find forest returned by introspect() on every implementation.
+// Depth is measured in parent hops (a root has depth 0); component sizes are
+// bucketed by powers of two (bucket k holds sizes in [2^k, 2^(k+1))).
+struct UnionFindStats
+{
+    int elements = 0;
+    int components = 0;
+    int max_depth = 0;
+    int largest_component = 0;
+    std::vector<std::uint64_t> depth_histogram; // [d] = elements at depth d
+    std::vector<std::uint64_t> rank_histogram;  // [r] = roots of rank r
+    std::vector<std::uint64_t> size_histogram;  // [k] = components of size 2^k .. 2^(k+1)-1
+    double direct_fraction = 1.0;               // Non-roots whose parent is a root (1.0 if there are none)
+    double mean_depth = 0.0;
+    std::size_t bytes = 0;                      // Bytes allocated by the structure, including the object itself
+
+    // One line: components, depths, direct-pointer fraction and memory.
+    void printSummary(std::ostream& out) const
+    {
+        std::ios_base::fmtflags flags = out.flags();
+        std::streamsize precision = out.precision();
+        out << "components=" << components << " largest=" << largest_component
+            << " max_depth=" << max_depth << " mean_depth=" << std::fixed << std::setprecision(3) << mean_depth
+            << " direct=" << std::setprecision(1) << 100.0 * direct_fraction << "%"
+            << " bytes=" << bytes << std::endl;
+        out.flags(flags);
+        out.precision(precision);
+    }
+
+    // Summary followed by the three histograms (empty buckets omitted).
+    void print(std::ostream& out) const
+    {
+        printSummary(out);
+        print_histogram(out, "depth", depth_histogram, false);
+        print_histogram(out, "rank", rank_histogram, false);
+        print_histogram(out, "component size", size_histogram, true);
+    }
+
+private:
+    static void print_histogram(std::ostream& out, const char* name, const std::vector<std::uint64_t>& h, bool log2)
+    {
+        out << "  " << name << ":";
+        for (std::size_t i = 0; i < h.size(); i++)
+        {
+            if (h[i] == 0)
+            {
+                continue;
+            }
+            out << " ";
+            if (log2)
+            {
+                out << (std::uint64_t{1} << i) << "+";
+            }
+            else
+            {
+                out << i;
+            }
+            out << ":" << h[i];
+        }
+        out << std::endl;
+    }
+};
+
+// Computes UnionFindStats for n elements in parallel, without modifying the forest.
+//   parent_of(i)  parent of i, or i itself if i is a root
+//   rank_of(r)    rank of root r
+// Every element walks to its root (no memoization, so the cost is the sum of
+// depths); the walk only reads, so callers must keep the forest unchanged while
+// it runs, or at least only changed by lock-free operations that keep it acyclic.
+template <typename ParentFn, typename RankFn>
+UnionFindStats collect_union_find_stats(int n, ParentFn&& parent_of, RankFn&& rank_of, std::size_t bytes)
+{
+    UnionFindStats stats;
+    stats.elements = n;
+    stats.bytes = bytes;
+
+    std::vector<std::atomic<int>> sizes(n > 0 ? n : 0); // Elements per root
+    std::vector<std::uint64_t> depths, ranks;
+    std::uint64_t direct = 0, non_roots = 0, depth_sum = 0;
+
+    #pragma omp parallel
+    {
+        std::vector<std::uint64_t> local_depths(1, 0), local_ranks(1, 0);
+        std::uint64_t local_direct = 0, local_non_roots = 0, local_depth_sum = 0;
+
+        #pragma omp for schedule(static)
+        for (int i = 0; i < n; i++)
+        {
+            int depth = 0;
+            int u = i;
+            int p = parent_of(u);
+            while (p != u)
+            {
+                depth++;
+                u = p;
+                p = parent_of(u);
+            }
+            sizes[u].fetch_add(1, std::memory_order_relaxed);
+
+            if (static_cast<std::size_t>(depth) >= local_depths.size())
+            {
+                local_depths.resize(depth + 1, 0);
+            }
+            local_depths[depth]++;
+            local_depth_sum += depth;
+            if (depth == 0)
+            {
+                std::size_t r = static_cast<std::size_t>(rank_of(i));
+                if (r >= local_ranks.size())
+                {
+                    local_ranks.resize(r + 1, 0);
+                }
+                local_ranks[r]++;
+            }
+            else
+            {
+                local_non_roots++;
+                local_direct += depth == 1 ? 1 : 0;
+            }
+        }
+
+        #pragma omp critical
+        {
+            depths.resize(std::max(depths.size(), local_depths.size()), 0);
+            for (std::size_t d = 0; d < local_depths.size(); d++)
+            {
+                depths[d] += local_depths[d];
+            }
+            ranks.resize(std::max(ranks.size(), local_ranks.size()), 0);
+            for (std::size_t r = 0; r < local_ranks.size(); r++)
+            {
+                ranks[r] += local_ranks[r];
+            }
+            direct += local_direct;
+            non_roots += local_non_roots;
+            depth_sum += local_depth_sum;
+        }
+    }
+
+    for (int i = 0; i < n; i++)
+    {
+        int s = sizes[i].load(std::memory_order_relaxed);
+        if (s == 0)
+        {
+            continue;
+        }
+        stats.components++;
+        stats.largest_component = std::max(stats.largest_component, s);
+        std::size_t bucket = 0;
+        while ((std::uint64_t{2} << bucket) <= static_cast<std::uint64_t>(s))
+        {
+            bucket++;
+        }
+        if (bucket >= stats.size_histogram.size())
+        {
+            stats.size_histogram.resize(bucket + 1, 0);
+        }
+        stats.size_histogram[bucket]++;
+    }
+
+    stats.depth_histogram = std::move(depths);
+    stats.rank_histogram = std::move(ranks);
+    stats.max_depth = stats.depth_histogram.empty() ? 0 : static_cast<int>(stats.depth_histogram.size()) - 1;
+    stats.direct_fraction = non_roots == 0 ? 1.0 : static_cast<double>(direct) / non_roots;
+    stats.mean_depth = n == 0 ? 0.0 : static_cast<double>(depth_sum) / n;
+    return stats;
+}
+
+#endif // UNION_FIND_STATS_HPP
@@ -0,0 +1,113 @@
+#ifndef ZEROED_BUFFER_HPP
+#define ZEROED_BUFFER_HPP
+
+#include <cstddef>
+#include <cstdlib>
+#include <cstring>
+#include <new>         // For std::bad_alloc
+#include <stdexcept>   // For std::invalid_argument
+#include <type_traits>
+#include <sys/mman.h>  // For mmap/munmap
+#include <unistd.h>    // For sysconf
+
+// Fixed-size array whose storage starts out all-zero without the constructor
+// writing it. Large buffers come straight from anonymous mmap, so pages are
+// zero-filled by the kernel lazily on first touch; small ones use calloc.
+// All implementations encode "root with rank 0" as an all-zero word, so a
+// freshly constructed structure is valid in O(1).
+// Built with UNIONFIND_EAGER_INIT, the buffer is touched up front instead
+// (the old O(n) behaviour), which is useful to compare startup costs.
+template <typename T>
+class ZeroedBuffer
+{
+    static_assert(std::is_trivially_destructible_v<T>, "ZeroedBuffer elements are never destroyed.");
+
+public:
+    explicit ZeroedBuffer(std::size_t n)
+        : count(n), bytes(n * sizeof(T)), mapped(bytes >= MMAP_MIN_BYTES)
+    {
+        void* mem;
+        if (mapped)
+        {
+            mem = mmap(nullptr, bytes, PROT_READ | PROT_WRITE, MAP_PRIVATE | MAP_ANONYMOUS, -1, 0);
+            if (mem == MAP_FAILED)
+            {
+                throw std::bad_alloc();
+            }
+        }
+        else
+        {
+            mem = std::calloc(n > 0 ? n : 1, sizeof(T));
+            if (mem == nullptr)
+            {
+                throw std::bad_alloc();
+            }
+        }
+        ptr = static_cast<T*>(mem);
+#ifdef UNIONFIND_EAGER_INIT
+        std::memset(mem, 0, bytes); // Fault every page in now, like the old per-element init.
+#endif
+    }
+
+    ~ZeroedBuffer()
+    {
+        if (mapped)
+        {
+            munmap(ptr, bytes);
+        }
+        else
+        {
+            std::free(ptr);
+        }
+    }
+
+    ZeroedBuffer(const ZeroedBuffer&) = delete;
+    ZeroedBuffer& operator=(const ZeroedBuffer&) = delete;
+    ZeroedBuffer(ZeroedBuffer&&) = delete;
+    ZeroedBuffer& operator=(ZeroedBuffer&&) = delete;
+
+    T& operator[](std::size_t i) { return ptr[i]; }
+    const T& operator[](std::size_t i) const { return ptr[i]; }
+
+    T* data() { return ptr; }
+    const T* data() const { return ptr; }
+    std::size_t size() const { return count; }
+
+    // Bytes actually reserved: whole pages when mapped, the calloc request otherwise.
+    std::size_t allocatedBytes() const
+    {
+        if (mapped)
+        {
+            std::size_t page = static_cast<std::size_t>(sysconf(_SC_PAGESIZE));
+            return (bytes + page - 1) / page * page;
+        }
+        return (count > 0 ? count : 1) * sizeof(T);
+    }
+
+    T* begin() { return ptr; }
+    T* end() { return ptr + count; }
+    const T* begin() const { return ptr; }
+    const T* end() const { return ptr + count; }
+
+private:
+    static constexpr std::size_t MMAP_MIN_BYTES = 64 * 1024;
+
+    std::size_t count;
+    std::size_t bytes;
+    bool mapped;
+    T* ptr;
+};
+
+// Element count for an engine's buffers, for use in its member initializer list.
+// Converting a negative int to std::size_t would turn it into a huge mmap request
+// that fails with std::bad_alloc before the engine's own check could run.
+inline std::size_t checked_size(int n)
+{
+    if (n < 0)
+    {
+        throw std::invalid_argument("Number of elements cannot be negative.");
+    }
+    return static_cast<std::size_t>(n);
+}
+
+#endif // ZEROED_BUFFER_HPP
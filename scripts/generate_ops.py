@@ -1,8 +1,11 @@
 import random
 import argparse
+import bisect
+import itertools
 import os
 import math
 import sys
+import json
 
 def generate_operations(
     n_elements,
@@ -12,10 +15,15 @@ def generate_operations(
     contention_level,
     hot_element_index,
     extreme_contention,
-    output_filename
+    output_filename,
+    grid=False,
+    locality_window=0,
+    zipf_s=0.0,
+    range_ratio=0.0,
+    max_range=64
 ):
     """
-    Generates a file containing Union-Find operations (UNION=0, FIND=1, SAMESET=2).
+    Generates a file containing Union-Find operations (UNION=0, FIND=1, SAMESET=2, RANGE_UNION=3).
     Supports uniform, focused (hot element), or extreme (elements 0 and 1 only) contention.
 
     Args:
@@ -28,6 +36,15 @@ def generate_operations(
         hot_element_index (int): Index for focused contention. Ignored if extreme_contention is True.
         extreme_contention (bool): If True, forces all operations onto elements 0 and 1.
         output_filename (str): The path to the output file.
+        grid (bool): If True, elements form a side x side lattice (row-major) and the
+                     second element of UNION/SAMESET is a right or down neighbour of the first.
+        locality_window (int): If > 0, the second element is drawn within +/- window of the
+                               first, modelling a locality-ordered (relabeled) graph.
+        zipf_s (float): If > 0, elements are drawn from a Zipf(s) distribution over a random
+                        permutation of the elements (a few hot elements, long tail).
+        range_ratio (float): Fraction of UNION operations emitted as RANGE_UNION(a, b), which
+                             merges every element of [a, b] with b - a uniform in [1, max_range].
+        max_range (int): Longest range of a RANGE_UNION operation.
     """
     # --- Input Validation ---
     if not (0.0 <= find_ratio <= 1.0):
@@ -42,6 +59,20 @@ def generate_operations(
         raise ValueError("n_elements must be at least 2 for --extreme-contention mode")
     if n_operations <= 0:
         raise ValueError("n_operations must be positive")
+    if zipf_s < 0.0:
+        raise ValueError("zipf_s must be non-negative")
+    if zipf_s > 0.0 and (grid or extreme_contention):
+        raise ValueError("zipf cannot be combined with grid or extreme_contention")
+    if locality_window < 0:
+        raise ValueError("locality_window must be non-negative")
+    if not (0.0 <= range_ratio <= 1.0):
+        raise ValueError("range_ratio must be between 0.0 and 1.0")
+    if range_ratio > 0.0 and (max_range < 1 or n_elements < 2):
+        raise ValueError("range unions need max_range >= 1 and at least 2 elements")
+    if grid and (extreme_contention or locality_window > 0):
+        raise ValueError("grid cannot be combined with extreme_contention or locality_window")
+    if grid and n_elements < 4:
+        raise ValueError("n_elements must be at least 4 for grid mode")
     if not extreme_contention and not (0 <= hot_element_index < n_elements):
         raise ValueError(f"hot_element_index ({hot_element_index}) must be between 0 and {n_elements-1} unless --extreme-contention is used")
 
@@ -86,6 +117,45 @@ def generate_operations(
                 return random.randint(0, n_elements - 1)
         select_element_func = select_element_focused
 
+    if zipf_s > 0.0 and n_elements > 1:
+        print(f"Distribution: Zipf(s={zipf_s}) over a random permutation (overrides contention level)")
+        cum_weights = list(itertools.accumulate(1.0 / (rank ** zipf_s) for rank in range(1, n_elements + 1)))
+        total_weight = cum_weights[-1]
+        zipf_order = list(range(n_elements))
+        random.shuffle(zipf_order)
+        def select_element_zipf():
+            rank = bisect.bisect_left(cum_weights, random.random() * total_weight)
+            return zipf_order[min(rank, n_elements - 1)]
+        select_element_func = select_element_zipf
+
+    # --- Partner Selection (second element of UNION/SAMESET) ---
+    select_partner_func = None
+    if grid:
+        side = math.isqrt(n_elements)
+        print(f"Pattern: Grid {side}x{side} (neighbour unions, row-major labels)")
+        def select_grid_element():
+            return random.randint(0, side * side - 1)
+        def select_partner_grid(a):
+            row, col = divmod(a, side)
+            candidates = []
+            if col + 1 < side: candidates.append(a + 1)
+            if col > 0: candidates.append(a - 1)
+            if row + 1 < side: candidates.append(a + side)
+            if row > 0: candidates.append(a - side)
+            return random.choice(candidates)
+        select_element_func = select_grid_element
+        select_partner_func = select_partner_grid
+    elif locality_window > 0 and not extreme_contention:
+        print(f"Pattern: Locality window +/-{locality_window}")
+        def select_partner_local(a):
+            lo = max(0, a - locality_window)
+            hi = min(n_elements - 1, a + locality_window)
+            return random.randint(lo, hi)
+        select_partner_func = select_partner_local
+
+
+    if range_ratio > 0.0:
+        print(f"Range unions: {range_ratio:.2f} of UNION operations, up to {max_range} elements past the start")
 
     print(f"Output file: {output_filename}")
 
@@ -109,6 +179,7 @@ def generate_operations(
             find_count = 0
             union_count = 0
             sameset_count = 0
+            range_count = 0
             # Track accesses involving elements 0 or 1 in extreme mode, or the hot element otherwise
             relevant_element_accesses = 0
             relevant_element_indices = set([0, 1]) if extreme_contention else set([hot_element_index])
@@ -160,7 +231,7 @@ def generate_operations(
 
                         # Select 'b' ensuring b != a
                         while True:
-                            b = select_element_func()
+                            b = select_partner_func(a) if select_partner_func else select_element_func()
                             if a != b:
                                 if b in relevant_element_indices:
                                     relevant_element_accesses += 1
@@ -170,6 +241,13 @@ def generate_operations(
                         if random.random() < sameset_ratio:
                             op_type_val = 2 # SAMESET
                             sameset_count += 1
+                        elif random.random() < range_ratio:
+                            op_type_val = 3 # RANGE_UNION of [a, b]
+                            if a == n_elements - 1:
+                                a -= 1
+                            b = min(n_elements - 1, a + random.randint(1, max_range))
+                            range_count += 1
+                            union_count += 1
                         else:
                             op_type_val = 0 # UNION
                             union_count += 1
@@ -189,6 +267,8 @@ def generate_operations(
 
             print(f"Actual FIND operations:    {find_count:>10} ({actual_find_ratio:.4f})")
             print(f"Actual UNION operations:   {union_count:>10}")
+            if range_count > 0:
+                print(f"  (of which RANGE_UNION:    {range_count:>10})")
             print(f"Actual SAMESET operations: {sameset_count:>10}")
             if non_find_count > 0:
                  print(f"  (SAMESET ratio of non-FIND: {actual_sameset_ratio:.4f})")
@@ -204,6 +284,201 @@ def generate_operations(
     except Exception as e:
         print(f"An unexpected error occurred during generation: {e}", file=sys.stderr)
 
+# --- Phase Scripts ---
+
+PHASE_KEYS = {"name", "length", "fraction", "find_ratio", "sameset_ratio", "range_ratio", "max_range",
+              "distribution", "hot_set", "hot_prob", "zipf", "drift", "reshuffle"}
+
+
+def load_phase_script(path, n_operations, defaults):
+    """
+    Reads a phase script: a JSON list of phase objects, run in order. Each phase needs
+    "length" (operations) or "fraction" (of n_operations); any other key overrides the
+    matching command-line default:
+        find_ratio, sameset_ratio, range_ratio, max_range: operation mix, as the CLI options.
+        distribution: "uniform", "hot" (hot_prob of accesses go to a hot set of hot_set
+                      elements) or "zipf" (exponent zipf over all elements).
+        hot_set (int): size of the hot set; for "zipf" the top ranks that drift.
+        drift (float): probability per operation that one hot-set member is swapped with
+                       a random element (a hot set that moves over time).
+        reshuffle (bool): draw a completely new hot set / Zipf order when the phase starts.
+    The hot set (the element order behind the ranks) carries over between phases.
+    """
+    with open(path) as f:
+        phases = json.load(f)
+    if not isinstance(phases, list) or not phases:
+        raise ValueError("phase script must be a non-empty JSON list of phases")
+    resolved = []
+    for index, phase in enumerate(phases):
+        if not isinstance(phase, dict):
+            raise ValueError(f"phase {index} is not a JSON object")
+        unknown = set(phase) - PHASE_KEYS
+        if unknown:
+            raise ValueError(f"phase {index}: unknown keys {sorted(unknown)}")
+        p = dict(defaults)
+        p.update(phase)
+        p.setdefault("name", f"phase{index}")
+        if "length" not in phase:
+            if "fraction" not in phase:
+                raise ValueError(f"phase {index}: needs 'length' or 'fraction'")
+            p["length"] = int(round(phase["fraction"] * n_operations))
+        if p["length"] < 0:
+            raise ValueError(f"phase {index}: length must be non-negative")
+        for key in ("find_ratio", "sameset_ratio", "range_ratio", "hot_prob", "drift"):
+            if not (0.0 <= p[key] <= 1.0):
+                raise ValueError(f"phase {index}: {key} must be between 0.0 and 1.0")
+        if p["distribution"] not in ("uniform", "hot", "zipf"):
+            raise ValueError(f"phase {index}: distribution must be uniform, hot or zipf")
+        if p["distribution"] == "zipf" and p["zipf"] <= 0.0:
+            raise ValueError(f"phase {index}: zipf distribution needs a positive 'zipf' exponent")
+        if p["range_ratio"] > 0.0 and p["max_range"] < 1:
+            raise ValueError(f"phase {index}: range unions need max_range >= 1")
+        resolved.append(p)
+    return resolved
+
+
+def generate_phased_operations(n_elements, phases, output_filename):
+    """
+    Generates a trace whose operation mix and access distribution change from phase to
+    phase (see load_phase_script()), e.g. union-heavy ingest, then a query storm on a
+    drifting hot set. Writes the same format as generate_operations().
+    """
+    if n_elements < 2:
+        raise ValueError("n_elements must be at least 2 for phase scripts")
+    total = sum(p["length"] for p in phases)
+    if total <= 0:
+        raise ValueError("phase script generates no operations")
+    print(f"Generating {total} operations for {n_elements} elements in {len(phases)} phases...")
+
+    order = list(range(n_elements)) # rank -> element; ranks below hot_set form the hot set
+    random.shuffle(order)
+    zipf_tables = {}
+
+    with open(output_filename, 'w') as f:
+        f.write(f"{n_elements} {total}\n")
+        for p in phases:
+            hot_set = max(1, min(int(p["hot_set"]), n_elements))
+            if p["reshuffle"]:
+                random.shuffle(order)
+
+            if p["distribution"] == "zipf":
+                if p["zipf"] not in zipf_tables:
+                    cum = list(itertools.accumulate(1.0 / (rank ** p["zipf"]) for rank in range(1, n_elements + 1)))
+                    zipf_tables[p["zipf"]] = (cum, cum[-1])
+                cum_weights, total_weight = zipf_tables[p["zipf"]]
+                def select_rank():
+                    return min(bisect.bisect_left(cum_weights, random.random() * total_weight), n_elements - 1)
+            elif p["distribution"] == "hot":
+                hot_prob = p["hot_prob"]
+                def select_rank():
+                    if random.random() < hot_prob:
+                        return random.randrange(hot_set)
+                    return random.randrange(n_elements)
+            else:
+                def select_rank():
+                    return random.randrange(n_elements)
+
+            counts = [0, 0, 0, 0]
+            drift = p["drift"]
+            for _ in range(p["length"]):
+                if drift > 0.0 and random.random() < drift:
+                    i = random.randrange(hot_set)
+                    j = random.randrange(n_elements)
+                    order[i], order[j] = order[j], order[i]
+
+                a = order[select_rank()]
+                if random.random() < p["find_ratio"]:
+                    op, b = 1, 0
+                else:
+                    b = order[select_rank()]
+                    tries = 0
+                    while b == a: # A tiny hot set may keep drawing 'a'; fall back to uniform.
+                        tries += 1
+                        b = order[select_rank()] if tries < 8 else random.randrange(n_elements)
+                    if random.random() < p["sameset_ratio"]:
+                        op = 2
+                    elif random.random() < p["range_ratio"]:
+                        op = 3
+                        a = min(a, n_elements - 2)
+                        b = min(n_elements - 1, a + random.randint(1, p["max_range"]))
+                    else:
+                        op = 0
+                counts[op] += 1
+                f.write(f"{op} {a} {b}\n")
+
+            print(f"  {p['name']:<16} {p['length']:>10} ops: {counts[0]} union, {counts[1]} find, "
+                  f"{counts[2]} sameset, {counts[3]} range ({p['distribution']}, drift {drift})")
+    print(f"Output file: {output_filename}")
+
+
+# --- Adversarial Traces ---
+
+def binomial_depths(n_elements):
+    """
+    Depth of every element after the 'binomial' unions below: [0, n) is split into
+    power-of-two blocks, and in a block of 2^k elements starting at s, element s + o
+    ends at depth k - popcount(o) (o = 0 is the deepest, at depth k).
+    """
+    depths = [0] * n_elements
+    start = 0
+    for k in range(n_elements.bit_length() - 1, -1, -1):
+        if n_elements - start >= (1 << k):
+            for o in range(1 << k):
+                depths[start + o] = k - bin(o).count("1")
+            start += 1 << k
+    return depths
+
+
+def generate_adversarial_operations(n_elements, n_operations, mode, sameset_ratio, output_filename):
+    """
+    Builds a worst-case tree shape with unions on roots only (so no union compresses a
+    path), then spends the rest of the trace on queries of the deepest elements first.
+
+    mode "binomial": the longest paths union by rank allows. Each power-of-two block
+        is merged bottom-up, always pairing two trees of equal rank, into a binomial
+        tree of depth log2(block). The larger root index is passed first, so both tie
+        rules in this repository (first argument wins, as in UnionFind, or larger index
+        wins, as in the lock-free engines) produce the same shape.
+    mode "chain": union(i, i + 1) for every i. Linking the first root under the second
+        (no rank, or union by index) gives one path of length n - 1. Under union by rank
+        the same unions give a star, which is the point of comparing the two.
+    """
+    if n_elements < 2:
+        raise ValueError("adversarial traces need at least 2 elements")
+    if mode == "chain":
+        unions = [(i, i + 1) for i in range(n_elements - 1)]
+        depths = list(range(n_elements - 1, -1, -1)) # Under first-under-second linking
+    else:
+        unions = []
+        start = 0
+        for k in range(n_elements.bit_length() - 1, -1, -1):
+            if n_elements - start < (1 << k):
+                continue
+            # Level j pairs the trees [s, s + 2^j) and [s + 2^j, s + 2^(j+1)); their roots are
+            # their last elements, and the right one (larger index) stays the root.
+            for j in range(k):
+                for s in range(start, start + (1 << k), 1 << (j + 1)):
+                    unions.append((s + (1 << (j + 1)) - 1, s + (1 << j) - 1))
+            start += 1 << k
+        depths = binomial_depths(n_elements)
+    if n_operations < len(unions):
+        raise ValueError(f"mode {mode} needs at least {len(unions)} operations for its unions")
+
+    deepest_first = sorted(range(n_elements), key=lambda x: -depths[x])
+    n_queries = n_operations - len(unions)
+    print(f"Generating adversarial '{mode}' trace: {len(unions)} unions (max depth {max(depths)}), {n_queries} queries")
+    with open(output_filename, 'w') as f:
+        f.write(f"{n_elements} {n_operations}\n")
+        for a, b in unions:
+            f.write(f"0 {a} {b}\n")
+        for q in range(n_queries):
+            a = deepest_first[q % n_elements]
+            if random.random() < sameset_ratio:
+                f.write(f"2 {a} {deepest_first[(q + 1) % n_elements]}\n")
+            else:
+                f.write(f"1 {a} 0\n")
+    print(f"Output file: {output_filename}")
+
 
 if __name__ == "__main__":
     parser = argparse.ArgumentParser(
@@ -225,6 +500,28 @@ if __name__ == "__main__":
                         help="Index of the element for focused contention. Ignored if --extreme-contention is used.")
     parser.add_argument("--extreme-contention", action="store_true",
                         help="Use extreme contention mode: all operations target only elements 0 and 1. Overrides --contention-level and --hot-element.")
+    parser.add_argument("--grid", action="store_true",
+                        help="Treat elements as a square lattice and draw UNION/SAMESET partners from lattice neighbours.")
+    parser.add_argument("--locality-window", type=int, default=0,
+                        help="If > 0, draw UNION/SAMESET partners within +/- this distance of the first element (locality-ordered labels).")
+    parser.add_argument("--zipf", type=float, default=0.0,
+                        help="If > 0, draw elements from a Zipf distribution with this exponent (hot-element query traces).")
+    parser.add_argument("--range-ratio", type=float, default=0.0,
+                        help="Fraction of UNION operations emitted as RANGE_UNION (type 3) over [a, b] (interval workloads).")
+    parser.add_argument("--max-range", type=int, default=64,
+                        help="Longest RANGE_UNION: b - a is uniform in [1, max-range].")
+    parser.add_argument("--phases", type=str, default=None,
+                        help="JSON phase script (list of phases with their own mix, distribution, drift and length); "
+                             "the other mix options become the phase defaults.")
+    parser.add_argument("--hot-set", type=int, default=1000,
+                        help="Phase default: size of the hot set (distribution 'hot') or of the drifting top ranks ('zipf').")
+    parser.add_argument("--hot-prob", type=float, default=0.9,
+                        help="Phase default: probability that an access goes to the hot set (distribution 'hot').")
+    parser.add_argument("--drift", type=float, default=0.0,
+                        help="Phase default: probability per operation that one hot-set member is replaced by a random element.")
+    parser.add_argument("--adversarial", choices=["chain", "binomial"], default=None,
+                        help="Worst-case tree shape built from root-only unions, then queries on the deepest elements "
+                             "(chain: no-rank/index linking; binomial: union by rank).")
     parser.add_argument("--seed", type=int, default=None,
                         help="Optional random seed for reproducibility.")
 
@@ -244,6 +541,26 @@ if __name__ == "__main__":
         if args.extreme_contention and args.n_elements < 2:
             raise ValueError(f"n_elements ({args.n_elements}) must be at least 2 for --extreme-contention mode.")
 
+        if args.adversarial:
+            generate_adversarial_operations(args.n_elements, args.n_operations, args.adversarial,
+                                            args.sameset_ratio, args.output_file)
+            sys.exit(0)
+        if args.phases:
+            defaults = {
+                "find_ratio": args.find_ratio,
+                "sameset_ratio": args.sameset_ratio,
+                "range_ratio": args.range_ratio,
+                "max_range": args.max_range,
+                "distribution": "zipf" if args.zipf > 0.0 else "uniform",
+                "zipf": args.zipf,
+                "hot_set": args.hot_set,
+                "hot_prob": args.hot_prob,
+                "drift": args.drift,
+                "reshuffle": False,
+            }
+            phases = load_phase_script(args.phases, args.n_operations, defaults)
+            generate_phased_operations(args.n_elements, phases, args.output_file)
+            sys.exit(0)
         generate_operations(
             args.n_elements,
             args.n_operations,
@@ -252,7 +569,12 @@ if __name__ == "__main__":
             args.contention_level,
             args.hot_element,
             args.extreme_contention, # Pass the flag
-            args.output_file
+            args.output_file,
+            grid=args.grid,
+            locality_window=args.locality_window,
+            zipf_s=args.zipf,
+            range_ratio=args.range_ratio,
+            max_range=args.max_range
         )
     except ValueError as e:
         print(f"Input Error: {e}", file=sys.stderr)
@@ -1,25 +1,33 @@
 #include "union_find.hpp" 
 #include <vector>
 #include <cassert>
-#include <numeric>
+#include <cstddef>
+#include <algorithm> // For std::max
+#include <utility>   // For std::swap
 
-// Constructor
+// Constructor: zeroed storage already holds n roots of rank 0.
 UnionFind::UnionFind(int n)
-    : parent(n), rank(n, 0), num_elements(n) 
+    : A(checked_size(n)),
+#ifdef UNIONFIND_BYTE_RANK
+      ranks(checked_size(n)),
+#endif
+      num_elements(n) 
 {
     assert(n >= 0 && "Number of elements cannot be negative.");
-    std::iota(parent.begin(), parent.end(), 0);
 }
 
 int UnionFind::find(int a) 
 {
     assert(a >= 0 && a < num_elements && "Element index out of bounds in find().");
 
-    if (parent[a] != a) 
+    int p = A[a];
+    if (is_root(p)) 
     {
-        parent[a] = find(parent[a]);
+        return a;
     }
-    return parent[a];
+    int root = find(get_parent(p));
+    A[a] = make_parent_val(root);
+    return root;
 }
 
 bool UnionFind::unionSets(int a, int b) 
@@ -35,18 +43,21 @@ bool UnionFind::unionSets(int a, int b)
         return false; 
     }
 
-    if (rank[rootA] < rank[rootB]) 
+    int rankA = rank_of(rootA);
+    int rankB = rank_of(rootB);
+
+    if (rankA < rankB) 
     {
-        parent[rootA] = rootB; 
+        A[rootA] = make_parent_val(rootB); 
     } 
-    else if (rank[rootA] > rank[rootB]) 
+    else if (rankA > rankB) 
     {
-        parent[rootB] = rootA; 
+        A[rootB] = make_parent_val(rootA); 
     } 
     else 
     {
-        parent[rootB] = rootA;
-        ++rank[rootA];
+        A[rootB] = make_parent_val(rootA);
+        set_rank(rootA, rankA + 1);
     }
     return true;
 }
@@ -91,6 +102,12 @@ void UnionFind::processOperations(const std::vector<Operation>& ops, std::vector
                 results[i] = are_same ? 1 : 0; 
                 break;
             }
+            case OperationType::RANGE_UNION_OP: 
+            {
+                assert(op.b >= 0 && op.b < num_elements && "Operation element 'b' out of bounds for RANGE_UNION_OP.");
+                results[i] = unionRange(op.a, op.b) ? 1 : 0;
+                break;
+            }
             default:
                 assert(false && "Unknown operation type encountered.");
                 results[i] = -2; // Indicate an error or unexpected state
@@ -98,8 +115,68 @@ void UnionFind::processOperations(const std::vector<Operation>& ops, std::vector
         }
     }
 }
+// Merge [l, r] one uncovered adjacent pair at a time
+bool UnionFind::unionRange(int l, int r) 
+{
+    assert(l >= 0 && l < num_elements && "Element index 'l' out of bounds in unionRange().");
+    assert(r >= 0 && r < num_elements && "Element index 'r' out of bounds in unionRange().");
+    if (l > r) 
+    {
+        std::swap(l, r);
+    }
+    if (l == r) 
+    {
+        return false;
+    }
+    if (!range_skip) 
+    {
+        range_skip = std::make_unique<ZeroedBuffer<int>>(num_elements);
+    }
+
+    ZeroedBuffer<int>& skip = *range_skip;
+    bool merged = false;
+    for (int i = next_uncovered(l, r); i < r; i = next_uncovered(i + 1, r)) 
+    {
+        merged = unionSets(i, i + 1) || merged;
+        skip[i] = 1;
+    }
+    // Every pair in [l, r) is covered now, so the next range starting at l jumps straight to r.
+    skip[l] = std::max(skip[l], r - l);
+    return merged;
+}
+
+int UnionFind::next_uncovered(int i, int limit) 
+{
+    ZeroedBuffer<int>& skip = *range_skip;
+    int j = i;
+    while (j < limit && skip[j] > 0) 
+    {
+        j += skip[j];
+    }
+    // Second pass: point every visited entry at j (path compression on the jumps).
+    while (i < j) 
+    {
+        int next = i + skip[i];
+        skip[i] = j - i;
+        i = next;
+    }
+    return j;
+}
 
 int UnionFind::size() const 
 {
     return num_elements;
 }
+
+UnionFindStats UnionFind::introspect() const 
+{
+    std::size_t bytes = sizeof(*this) + A.allocatedBytes() + (range_skip ? range_skip->allocatedBytes() : 0);
+#ifdef UNIONFIND_BYTE_RANK
+    bytes += ranks.allocatedBytes();
+#endif
+    return collect_union_find_stats(
+        num_elements,
+        [this](int i) { int val = A[i]; return is_root(val) ? i : get_parent(val); },
+        [this](int root) { return rank_of(root); },
+        bytes);
+}
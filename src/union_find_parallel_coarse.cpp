@@ -5,14 +5,14 @@
 
 // Constructor
 UnionFindParallelCoarse::UnionFindParallelCoarse(int n)
-    : parent(n), rank(n, 0), num_elements(n) 
+    : A(checked_size(n)), // Zeroed storage: each element is initially a root of rank 0.
+#ifdef UNIONFIND_BYTE_RANK
+      ranks(checked_size(n)),
+#endif
+      num_elements(n) 
 {
     // Precondition: n should not be negative.
     assert(n >= 0 && "Number of elements cannot be negative.");
-    for (int i = 0; i < n; i++) 
-    {
-        parent[i] = i; // Each element is initially its own parent.
-    }
     // Note: The mutex 'coarse_lock' is default-initialized.
 }
 
@@ -22,10 +22,13 @@ int UnionFindParallelCoarse::find(int a)
     assert(a >= 0 && a < num_elements && "Element index out of bounds in find().");
 
     std::lock_guard<std::recursive_mutex> guard(coarse_lock); // Lock before accessing shared data
-    if (parent[a] != a) {
-        parent[a] = find(parent[a]);
+    int p = A[a];
+    if (is_root(p)) {
+        return a;
     }
-    return parent[a]; // Return the root of the set.
+    int root = find(get_parent(p));
+    A[a] = make_parent_val(root);
+    return root; // Return the root of the set.
 }
 
 // Union operation with union by rank (thread-safe via coarse lock)
@@ -43,13 +46,16 @@ bool UnionFindParallelCoarse::unionSets(int a, int b)
         return false; 
     }
 
-    if (rank[rootA] < rank[rootB]) {
-        parent[rootA] = rootB; 
-    } else if (rank[rootA] > rank[rootB]) {
-        parent[rootB] = rootA; 
+    int rankA = rank_of(rootA);
+    int rankB = rank_of(rootB);
+
+    if (rankA < rankB) {
+        A[rootA] = make_parent_val(rootB); 
+    } else if (rankA > rankB) {
+        A[rootB] = make_parent_val(rootA); 
     } else {
-        parent[rootB] = rootA;
-        ++rank[rootA];
+        A[rootB] = make_parent_val(rootA);
+        set_rank(rootA, rankA + 1);
     }
     return true;
 }
@@ -109,4 +115,18 @@ void UnionFindParallelCoarse::processOperations(const std::vector<Operation>& op
 int UnionFindParallelCoarse::size() const 
 {
     return num_elements;
+}
+
+UnionFindStats UnionFindParallelCoarse::introspect() const 
+{
+    std::lock_guard<std::recursive_mutex> guard(coarse_lock);
+    std::size_t bytes = sizeof(*this) + A.allocatedBytes();
+#ifdef UNIONFIND_BYTE_RANK
+    bytes += ranks.allocatedBytes();
+#endif
+    return collect_union_find_stats(
+        num_elements,
+        [this](int i) { int val = A[i]; return is_root(val) ? i : get_parent(val); },
+        [this](int root) { return rank_of(root); },
+        bytes);
 }
\ No newline at end of file
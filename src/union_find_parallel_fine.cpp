@@ -2,16 +2,19 @@
 #include <omp.h>
 #include <vector>
 #include <mutex>
-#include <numeric>   
 #include <cassert>
 #include <algorithm> 
 #include <stdexcept> 
 // Constructor
+// Zeroed storage already holds n roots of rank 0; only the mutex vector is built eagerly.
 UnionFindParallelFine::UnionFindParallelFine(int n)
-    : parent(n), rank(n, 0), num_elements(n), locks(n) 
+    : A(checked_size(n)),
+#ifdef UNIONFIND_BYTE_RANK
+      ranks(checked_size(n)),
+#endif
+      num_elements(n), locks(checked_size(n)) 
 { 
     assert(n >= 0 && "Number of elements cannot be negative.");
-    std::iota(parent.begin(), parent.end(), 0);
 }
 
 // Find operation with best-effort path compression (no locks during traversal/compression)
@@ -22,10 +25,14 @@ int UnionFindParallelFine::find(int a)
 
     // 1. Find the root (potentially racing with writes)
     int root = a;
-    while (parent[root] != root) 
+    while (true) 
     {
-        int next_parent = parent[root];
-        root = next_parent;
+        int next_parent = A[root];
+        if (is_root(next_parent)) 
+        {
+            break;
+        }
+        root = get_parent(next_parent);
         assert(root >= 0 && root < num_elements && "Invalid parent index encountered during find.");
     }
 
@@ -33,10 +40,16 @@ int UnionFindParallelFine::find(int a)
     int current = a;
     while (current != root) 
     {
-        int next = parent[current];
-        // Racy write: Another thread might be updating parent[current] concurrently.
-        parent[current] = root;
-        current = next;
+        int next = A[current];
+        if (is_root(next)) 
+        {
+            // A concurrent compression moved us past 'root' onto a newer root;
+            // never overwrite a root's rank word.
+            break;
+        }
+        // Racy write: Another thread might be updating A[current] concurrently.
+        A[current] = make_parent_val(root);
+        current = get_parent(next);
     }
     return root;
 }
@@ -45,9 +58,14 @@ int UnionFindParallelFine::find_root_no_compression(int a) const
 {
     assert(a >= 0 && a < num_elements && "Element index out of bounds in find_root_no_compression().");
     int current = a;
-    while (parent[current] != current) 
+    while (true) 
     {
-        current = parent[current];
+        int next = A[current];
+        if (is_root(next)) 
+        {
+            break;
+        }
+        current = get_parent(next);
         assert(current >= 0 && current < num_elements && "Invalid parent index encountered during find_root_no_compression.");
     }
     return current;
@@ -91,18 +109,21 @@ bool UnionFindParallelFine::unionSets(int a, int b)
 
         // Proceed with the union using the verified roots (rootA, rootB)
         // which are guaranteed to be the correct roots at this point and are different.
-        assert(parent[rootA] == rootA && parent[rootB] == rootB); // Assert they are indeed roots
+        assert(is_root(A[rootA]) && is_root(A[rootB])); // Assert they are indeed roots
+
+        int rankA = rank_of(rootA);
+        int rankB = rank_of(rootB);
 
-        if (rank[rootA] < rank[rootB]) 
+        if (rankA < rankB) 
         {
-            parent[rootA] = rootB;
-        } else if (rank[rootA] > rank[rootB]) 
+            A[rootA] = make_parent_val(rootB);
+        } else if (rankA > rankB) 
         {
-            parent[rootB] = rootA;
+            A[rootB] = make_parent_val(rootA);
         } else 
         {
-            parent[rootB] = rootA;
-            rank[rootA]++;
+            A[rootB] = make_parent_val(rootA);
+            set_rank(rootA, rankA + 1);
         }
         // *** Critical Section End ***
 
@@ -166,3 +187,16 @@ int UnionFindParallelFine::size() const
 {
     return num_elements;
 }
+
+UnionFindStats UnionFindParallelFine::introspect() const 
+{
+    std::size_t bytes = sizeof(*this) + A.allocatedBytes() + locks.capacity() * sizeof(std::mutex);
+#ifdef UNIONFIND_BYTE_RANK
+    bytes += ranks.allocatedBytes();
+#endif
+    return collect_union_find_stats(
+        num_elements,
+        [this](int i) { int val = A[i]; return is_root(val) ? i : get_parent(val); },
+        [this](int root) { return rank_of(root); },
+        bytes);
+}
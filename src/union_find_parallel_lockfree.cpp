@@ -1,4 +1,6 @@
 #include "union_find_parallel_lockfree.hpp"
+#include "union_find_probes.hpp"
+#include "compact_range.hpp"
 #include <omp.h> 
 #include <stdexcept> 
 #include <iostream> 
@@ -7,16 +9,9 @@
 
 UnionFindParallelLockFree::UnionFindParallelLockFree(int n)
     : n_elements(n),
-      A(n) 
+      A(checked_size(n)), 
+      hint_owner(RootHintCache::nextOwnerId())
 {
-    if (n < 0)
-    {
-        throw std::invalid_argument("Number of elements cannot be negative.");
-    }
-    for (int i = 0; i < n; i++) 
-    {
-        A[i].store(make_root_val(0), std::memory_order_relaxed);
-    }
 }
 
 // --- Core Lock-Free Operations (Aligned with Pseudocode) ---
@@ -29,14 +24,17 @@ std::pair<int, int> UnionFindParallelLockFree::find_internal(int u)
         return {u, p_val};
     }
 
-    int p_idx = p_val;
+    int p_idx = get_parent(p_val);
     std::pair<int, int> root_info = find_internal(p_idx);
     int root_idx = root_info.first;
     if (p_idx != root_idx) 
     {
-        A[u].compare_exchange_weak(p_val, root_idx,
-                                    std::memory_order_release, // Make write visible if successful
-                                    std::memory_order_relaxed); // Relaxed on failure is fine
+        if (A[u].compare_exchange_weak(p_val, make_parent_val(root_idx),
+                                       std::memory_order_release, // Make write visible if successful
+                                       std::memory_order_relaxed)) // Relaxed on failure is fine
+        {
+            UF_PROBE3(compress, u, root_idx, p_idx);
+        }
         // We don't retry or loop here; if CAS fails, it means A[u] changed concurrently.
         // The recursive structure ensures we still return the correct root found deeper.
         // Subsequent finds involving 'u' will benefit if the compression succeeded.
@@ -50,7 +48,14 @@ int UnionFindParallelLockFree::find(int a)
     {
         throw std::out_of_range("Element index out of range in find().");
     }
-    return find_internal(a).first;
+    int path_len = UF_PROBE_ENABLED(find) ? path_length(a) : 0;
+    int root = root_hints ? find_hinted(a) : find_internal(a).first;
+    UF_PROBE3(find, a, root, path_len);
+    if (profiler != nullptr) 
+    {
+        profiler->noteAccess(a, root);
+    }
+    return root;
 }
 
 bool UnionFindParallelLockFree::unionSets(int a, int b) {
@@ -59,7 +64,9 @@ bool UnionFindParallelLockFree::unionSets(int a, int b) {
         throw std::out_of_range("Element index out of range in unionSets().");
     }
 
-    while (true) 
+    int path_len = UF_PROBE_ENABLED(union_link) || UF_PROBE_ENABLED(union_fail) ? path_length(a) + path_length(b) : 0;
+
+    for (int retries = 0; ; retries++) 
     {
         std::pair<int, int> info_a = find_internal(a);
         int root_a_idx = info_a.first;
@@ -69,6 +76,20 @@ bool UnionFindParallelLockFree::unionSets(int a, int b) {
         int root_b_idx = info_b.first;
         int root_b_val = info_b.second;
 
+        if (retries > 0) 
+        {
+            UF_PROBE5(union_retry, a, b, root_a_idx, root_b_idx, retries);
+            if (timeline != nullptr) 
+            {
+                TimelineTrace::noteRetry(a, b, retries);
+            }
+        }
+        else if (profiler != nullptr) 
+        {
+            profiler->noteAccess(a, root_a_idx);
+            profiler->noteAccess(b, root_b_idx);
+        }
+
         root_a_val = A[root_a_idx].load(std::memory_order_acquire);
         root_b_val = A[root_b_idx].load(std::memory_order_acquire);
 
@@ -83,6 +104,7 @@ bool UnionFindParallelLockFree::unionSets(int a, int b) {
 
         if (root_a_idx == root_b_idx) 
         {
+            UF_PROBE5(union_fail, a, b, root_a_idx, path_len, retries);
             return false;
         }
 
@@ -91,17 +113,27 @@ bool UnionFindParallelLockFree::unionSets(int a, int b) {
 
         if (rank_a < rank_b) 
         {
-            if (A[root_a_idx].compare_exchange_weak(root_a_val, root_b_idx,
+            if (A[root_a_idx].compare_exchange_weak(root_a_val, make_parent_val(root_b_idx),
                                                     std::memory_order_release, std::memory_order_relaxed)) 
             {
+                UF_PROBE6(union_link, a, b, root_b_idx, root_a_idx, path_len, retries);
+                if (merge_events != nullptr) 
+                {
+                    merge_events->emit(root_b_idx, root_a_idx);
+                }
                 return true; // Union successful
             }
         } 
         else if (rank_a > rank_b) 
         {
-            if (A[root_b_idx].compare_exchange_weak(root_b_val, root_a_idx,
+            if (A[root_b_idx].compare_exchange_weak(root_b_val, make_parent_val(root_a_idx),
                                                     std::memory_order_release, std::memory_order_relaxed)) 
             {
+                UF_PROBE6(union_link, a, b, root_a_idx, root_b_idx, path_len, retries);
+                if (merge_events != nullptr) 
+                {
+                    merge_events->emit(root_a_idx, root_b_idx);
+                }
                 return true; // Union successful
             }
         } 
@@ -109,27 +141,41 @@ bool UnionFindParallelLockFree::unionSets(int a, int b) {
         { 
             if (root_a_idx < root_b_idx) 
             {
-                if (A[root_a_idx].compare_exchange_weak(root_a_val, root_b_idx,
+                if (A[root_a_idx].compare_exchange_weak(root_a_val, make_parent_val(root_b_idx),
                                                         std::memory_order_release, std::memory_order_relaxed)) 
                 {
                     int new_rank_b_val = make_root_val(rank_b + 1);
                     A[root_b_idx].compare_exchange_weak(root_b_val, new_rank_b_val,
                                                         std::memory_order_release, std::memory_order_relaxed);
+                    UF_PROBE6(union_link, a, b, root_b_idx, root_a_idx, path_len, retries);
+                    if (merge_events != nullptr) 
+                    {
+                        merge_events->emit(root_b_idx, root_a_idx);
+                    }
                     return true;
                 }
             } 
             else 
             { 
-                if (A[root_b_idx].compare_exchange_weak(root_b_val, root_a_idx,
+                if (A[root_b_idx].compare_exchange_weak(root_b_val, make_parent_val(root_a_idx),
                                                         std::memory_order_release, std::memory_order_relaxed)) 
                 {
                     int new_rank_a_val = make_root_val(rank_a + 1);
                     A[root_a_idx].compare_exchange_weak(root_a_val, new_rank_a_val,
                                                         std::memory_order_release, std::memory_order_relaxed);
+                    UF_PROBE6(union_link, a, b, root_a_idx, root_b_idx, path_len, retries);
+                    if (merge_events != nullptr) 
+                    {
+                        merge_events->emit(root_a_idx, root_b_idx);
+                    }
                     return true;
                 }
             }
         }
+        if (profiler != nullptr) 
+        {
+            profiler->noteCasFailure(root_a_idx, root_b_idx); // Only a lost link CAS gets here
+        }
     }
 }
 
@@ -142,8 +188,13 @@ bool UnionFindParallelLockFree::sameSet(int a, int b)
 
     while (true) 
     {
-        int root_a_idx = find_internal(a).first; 
-        int root_b_idx = find_internal(b).first; 
+        int root_a_idx = root_hints ? find_hinted(a) : find_internal(a).first;
+        int root_b_idx = root_hints ? find_hinted(b) : find_internal(b).first; 
+        if (profiler != nullptr) 
+        {
+            profiler->noteAccess(a, root_a_idx);
+            profiler->noteAccess(b, root_b_idx);
+        }
 
         if (root_a_idx == root_b_idx) 
         {
@@ -159,51 +210,225 @@ bool UnionFindParallelLockFree::sameSet(int a, int b)
     }
 }
 
-void UnionFindParallelLockFree::processOperations(const std::vector<Operation>& ops, std::vector<int>& results) 
+bool UnionFindParallelLockFree::unionRange(int l, int r) 
 {
-    size_t num_ops = ops.size();
-    results.resize(num_ops); 
+    if (l < 0 || l >= n_elements || r < 0 || r >= n_elements) 
+    {
+        throw std::out_of_range("Element index out of range in unionRange().");
+    }
+    if (l > r) 
+    {
+        std::swap(l, r);
+    }
+    if (l == r) 
+    {
+        return false;
+    }
+    std::call_once(range_skip_once, [this] { range_skip = std::make_unique<ZeroedBuffer<std::atomic<int>>>(n_elements); });
 
-    #pragma omp parallel for schedule(static)
-    for (size_t i = 0; i < num_ops; i++) 
+    ZeroedBuffer<std::atomic<int>>& skip = *range_skip;
+    bool merged = false;
+    int i = next_unlinked(l, r);
+    while (i < r) 
     {
-        const auto& op = ops[i];
-        try {
-            if (op.type == OperationType::FIND_OP) 
-            {
-                results[i] = find(op.a);
-            } 
-            else if (op.type == OperationType::UNION_OP) 
-            {
-                bool success = unionSets(op.a, op.b);
-                results[i] = success ? 1 : 0;
-            } 
-            else if (op.type == OperationType::SAMESET_OP) 
-            {
-                bool same = sameSet(op.a, op.b);
-                results[i] = same ? 1 : 0;
-            }
+        // Claim the pair, or help the range that claimed it but has not marked it
+        // linked yet; either way the pair is linked before this call moves past it.
+        int state = 0;
+        skip[i].compare_exchange_strong(state, RANGE_CLAIMED, std::memory_order_acq_rel);
+        if (state <= 0) 
+        {
+            merged = unionSets(i, i + 1) || merged;
+            int claimed = RANGE_CLAIMED;
+            skip[i].compare_exchange_strong(claimed, 1, std::memory_order_acq_rel); // Fails if a helper marked it first
+        }
+        i = next_unlinked(i, r);
+    }
+    // Every pair in [l, r) is linked now, so later ranges from l jump straight to r.
+    int cur = skip[l].load(std::memory_order_relaxed);
+    while (cur < r - l && !skip[l].compare_exchange_weak(cur, r - l, std::memory_order_acq_rel)) 
+    {
+    }
+    return merged;
+}
+
+int UnionFindParallelLockFree::next_unlinked(int i, int limit) 
+{
+    ZeroedBuffer<std::atomic<int>>& skip = *range_skip;
+    int j = i;
+    while (j < limit) 
+    {
+        int d = skip[j].load(std::memory_order_acquire);
+        if (d <= 0) 
+        {
+            break; // Unclaimed, or claimed and possibly not linked yet
+        }
+        j += d;
+    }
+    // Raise the visited entries to point at j. A racing writer may have raised one
+    // further already; jumps never shrink, so any value seen stays valid.
+    while (i < j) 
+    {
+        int cur = skip[i].load(std::memory_order_relaxed);
+        int next = i + cur;
+        while (cur < j - i && !skip[i].compare_exchange_weak(cur, j - i, std::memory_order_acq_rel)) 
+        {
+        }
+        i = next;
+    }
+    return j;
+}
+
+// Runs one operation and stores its result (shared by the plain and traced loops).
+void UnionFindParallelLockFree::process_op(const Operation& op, int& result, size_t i) 
+{
+    try {
+        if (op.type == OperationType::FIND_OP) 
+        {
+            result = find(op.a);
         } 
-        catch (const std::out_of_range& e) 
+        else if (op.type == OperationType::UNION_OP) 
         {
-            #pragma omp critical
-            {
-                std::cerr << "Error processing operation " << i << ": " << e.what() << std::endl;
-            }
-            results[i] = -1; // Indicate error
+            bool success = unionSets(op.a, op.b);
+            result = success ? 1 : 0;
         } 
-        catch (const std::exception& e) 
+        else if (op.type == OperationType::SAMESET_OP) 
         {
-            #pragma omp critical
-            {
-                std::cerr << "Generic error processing operation " << i << ": " << e.what() << std::endl;
-            }
-            results[i] = -2; // Indicate error
+            bool same = sameSet(op.a, op.b);
+            result = same ? 1 : 0;
+        }
+        else if (op.type == OperationType::RANGE_UNION_OP) 
+        {
+            result = unionRange(op.a, op.b) ? 1 : 0;
+        }
+    } 
+    catch (const std::out_of_range& e) 
+    {
+        #pragma omp critical
+        {
+            std::cerr << "Error processing operation " << i << ": " << e.what() << std::endl;
+        }
+        result = -1; // Indicate error
+    } 
+    catch (const std::exception& e) 
+    {
+        #pragma omp critical
+        {
+            std::cerr << "Generic error processing operation " << i << ": " << e.what() << std::endl;
         }
+        result = -2; // Indicate error
     }
 }
 
+void UnionFindParallelLockFree::processOperations(const std::vector<Operation>& ops, std::vector<int>& results) 
+{
+    size_t num_ops = ops.size();
+    results.resize(num_ops);
+    active_batches.fetch_add(1, std::memory_order_relaxed);
+    UF_PROBE2(batch_start, this, num_ops);
+
+    if (timeline != nullptr) 
+    {
+        timeline->runBatch(num_ops, [&](size_t i) { process_op(ops[i], results[i], i); });
+    } 
+    else 
+    {
+        #pragma omp parallel for schedule(static)
+        for (size_t i = 0; i < num_ops; i++) 
+        {
+            process_op(ops[i], results[i], i);
+        }
+    }
+    UF_PROBE2(batch_end, this, num_ops);
+    active_batches.fetch_sub(1, std::memory_order_relaxed);
+}
+
 int UnionFindParallelLockFree::size() const 
 {
     return n_elements;
 }
+
+UnionFindStats UnionFindParallelLockFree::introspect() const 
+{
+    return collect_union_find_stats(
+        n_elements,
+        [this](int i) { int val = A[i].load(std::memory_order_relaxed); return is_root(val) ? i : get_parent(val); },
+        [this](int root) { return get_rank(A[root].load(std::memory_order_relaxed)); },
+        sizeof(*this) + A.allocatedBytes() + (range_skip ? range_skip->allocatedBytes() : 0));
+}
+
+int UnionFindParallelLockFree::compactRange(int begin, int end) 
+{
+    if (begin < 0 || end > n_elements || begin > end) 
+    {
+        throw std::out_of_range("Range out of bounds in compactRange().");
+    }
+    return compact_word_range(begin, end, [this](int i) -> std::atomic<int>& { return A[i]; });
+}
+
+bool UnionFindParallelLockFree::isBusy() const 
+{
+    return active_batches.load(std::memory_order_relaxed) > 0;
+}
+
+int UnionFindParallelLockFree::path_length(int u) const 
+{
+    int hops = 0;
+    int val = A[u].load(std::memory_order_relaxed);
+    while (!is_root(val)) 
+    {
+        hops++;
+        val = A[get_parent(val)].load(std::memory_order_relaxed);
+    }
+    return hops;
+}
+
+int UnionFindParallelLockFree::find_hinted(int u) 
+{
+    int val = A[u].load(std::memory_order_acquire);
+    if (is_root(val)) 
+    {
+        return u; // Roots answer themselves; keep them out of the cache.
+    }
+    int parent = get_parent(val);
+    if (is_root(A[parent].load(std::memory_order_acquire))) 
+    {
+        return parent; // Already flat: cheaper than a cache probe.
+    }
+
+    RootHintCache& cache = RootHintCache::local();
+    int root;
+    if (cache.lookup(hint_owner, u, root) && is_root(A[root].load(std::memory_order_acquire))) 
+    {
+        cache.hits++;
+        return root; // Cached root is still a root, so it is still u's root.
+    }
+    cache.misses++;
+    root = find_internal(u).first;
+    cache.store(hint_owner, u, root);
+    return root;
+}
+
+void UnionFindParallelLockFree::setRootHints(bool enabled) 
+{
+    root_hints = enabled;
+}
+
+bool UnionFindParallelLockFree::rootHintsEnabled() const 
+{
+    return root_hints;
+}
+
+void UnionFindParallelLockFree::setTimeline(TimelineTrace* trace) 
+{
+    timeline = trace;
+}
+
+void UnionFindParallelLockFree::setProfiler(HotElementProfiler* hot_profiler) 
+{
+    profiler = hot_profiler;
+}
+
+void UnionFindParallelLockFree::setMergeEvents(MergeEventStream* stream) 
+{
+    merge_events = stream;
+}
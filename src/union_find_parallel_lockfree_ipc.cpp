@@ -1,4 +1,6 @@
 #include "union_find_parallel_lockfree_ipc.hpp"
+#include "union_find_probes.hpp"
+#include "compact_range.hpp"
 #include <omp.h>       
 #include <iostream>     
 #include <vector>       
@@ -13,17 +15,9 @@
 // --- Constructor ---
 UnionFindParallelLockFreeIPC::UnionFindParallelLockFreeIPC(int n)
     : n_elements(n),
-      A(n) // Default-construct n atomic<int> elements
+      A(checked_size(n)), // Zeroed storage: n roots of rank 0
+      hint_owner(RootHintCache::nextOwnerId())
 {
-    if (n < 0) 
-    {
-        throw std::invalid_argument("Number of elements cannot be negative.");
-    }
-    for (int i = 0; i < n; i++) 
-    {
-        // Initialize each element as a root with rank 0. Store rank 0 as value -1.
-        A[i].store(make_root_val(0), std::memory_order_relaxed);
-    }
 }
 
 // --- Core Lock-Free Operations (Based on original lockfree + IPC) ---
@@ -39,15 +33,18 @@ std::pair<int, int> UnionFindParallelLockFreeIPC::find_internal(int u)
         return {u, p_val};
     }
 
-    int p_idx = p_val; 
+    int p_idx = get_parent(p_val); 
     std::pair<int, int> root_info = find_internal(p_idx);
     int root_idx = root_info.first;
 
     if (p_idx != root_idx) 
     {
-        A[u].compare_exchange_weak(p_val, root_idx,
-                                   std::memory_order_release, // Make write visible if successful
-                                   std::memory_order_relaxed); // Relaxed on failure is fine
+        if (A[u].compare_exchange_weak(p_val, make_parent_val(root_idx),
+                                       std::memory_order_release, // Make write visible if successful
+                                       std::memory_order_relaxed)) // Relaxed on failure is fine
+        {
+            UF_PROBE3(compress, u, root_idx, p_idx);
+        }
     }
 
     return root_info;
@@ -60,7 +57,14 @@ int UnionFindParallelLockFreeIPC::find(int a)
     {
         throw std::out_of_range("Element index out of range in find().");
     }
-    return find_internal(a).first;
+    int path_len = UF_PROBE_ENABLED(find) ? path_length(a) : 0;
+    int root = root_hints ? find_hinted(a) : find_internal(a).first;
+    UF_PROBE3(find, a, root, path_len);
+    if (profiler != nullptr) 
+    {
+        profiler->noteAccess(a, root);
+    }
+    return root;
 }
 
 bool UnionFindParallelLockFreeIPC::unionSets(int a, int b) 
@@ -70,7 +74,9 @@ bool UnionFindParallelLockFreeIPC::unionSets(int a, int b)
         throw std::out_of_range("Element index out of range in unionSets().");
     }
 
-    while (true) 
+    int path_len = UF_PROBE_ENABLED(union_link) || UF_PROBE_ENABLED(union_fail) ? path_length(a) + path_length(b) : 0;
+
+    for (int retries = 0; ; retries++) 
     {
         // --- Immediate Parent Check (IPC) Optimization ---
         int parent_a_ipc = A[a].load(std::memory_order_relaxed);
@@ -82,6 +88,7 @@ bool UnionFindParallelLockFreeIPC::unionSets(int a, int b)
         if (!is_root(parent_a_ipc) && parent_a_ipc == parent_b_ipc) {
             // If immediate parents are the same index, they are likely in the same set.
             // The full find/traversal below would confirm, but IPC provides a fast path.
+            UF_PROBE5(union_fail, a, b, -1, path_len, retries); // Root not resolved on this path
             return false;
         }
         // --- End IPC Optimization ---
@@ -91,6 +98,19 @@ bool UnionFindParallelLockFreeIPC::unionSets(int a, int b)
 
         std::pair<int, int> info_b = find_internal(b);
         int root_b_idx = info_b.first;
+        if (retries > 0) 
+        {
+            UF_PROBE5(union_retry, a, b, root_a_idx, root_b_idx, retries);
+            if (timeline != nullptr) 
+            {
+                TimelineTrace::noteRetry(a, b, retries);
+            }
+        }
+        else if (profiler != nullptr) 
+        {
+            profiler->noteAccess(a, root_a_idx);
+            profiler->noteAccess(b, root_b_idx);
+        }
 
         int current_root_a_val = A[root_a_idx].load(std::memory_order_acquire);
         int current_root_b_val = A[root_b_idx].load(std::memory_order_acquire);
@@ -106,6 +126,7 @@ bool UnionFindParallelLockFreeIPC::unionSets(int a, int b)
 
         if (root_a_idx == root_b_idx) 
         {
+            UF_PROBE5(union_fail, a, b, root_a_idx, path_len, retries);
             return false; // Already in the same set
         }
 
@@ -152,7 +173,7 @@ bool UnionFindParallelLockFreeIPC::unionSets(int a, int b)
         }
 
         // Attempt to link the child root to the parent root index
-        if (A[child_root_idx].compare_exchange_weak(child_val_expected, parent_root_idx,
+        if (A[child_root_idx].compare_exchange_weak(child_val_expected, make_parent_val(parent_root_idx),
                                                     std::memory_order_release, std::memory_order_relaxed))
         {
             // Successfully linked child to parent.
@@ -163,9 +184,14 @@ bool UnionFindParallelLockFreeIPC::unionSets(int a, int b)
                 A[parent_root_idx].compare_exchange_weak(parent_val_expected, new_parent_rank_val,
                                                          std::memory_order_release, std::memory_order_relaxed);
             }
+            UF_PROBE6(union_link, a, b, parent_root_idx, child_root_idx, path_len, retries);
             return true; // Union successful
         }
         // If CAS failed, loop and retry the entire operation.
+        if (profiler != nullptr) 
+        {
+            profiler->noteCasFailure(root_a_idx, root_b_idx); // Only a lost link CAS gets here
+        }
     } 
 }
 
@@ -189,8 +215,13 @@ bool UnionFindParallelLockFreeIPC::sameSet(int a, int b)
         }
         // --- End IPC Optimization ---
 
-        int root_a_idx = find_internal(a).first; 
-        int root_b_idx = find_internal(b).first;
+        int root_a_idx = root_hints ? find_hinted(a) : find_internal(a).first;
+        int root_b_idx = root_hints ? find_hinted(b) : find_internal(b).first;
+        if (profiler != nullptr) 
+        {
+            profiler->noteAccess(a, root_a_idx);
+            profiler->noteAccess(b, root_b_idx);
+        }
 
         if (root_a_idx == root_b_idx) 
         {
@@ -206,52 +237,149 @@ bool UnionFindParallelLockFreeIPC::sameSet(int a, int b)
     } 
 }
 
-void UnionFindParallelLockFreeIPC::processOperations(const std::vector<Operation>& ops, std::vector<int>& results) 
+// Runs one operation and stores its result (shared by the plain and traced loops).
+void UnionFindParallelLockFreeIPC::process_op(const Operation& op, int& result, size_t i) 
 {
-    size_t num_ops = ops.size();
-    results.resize(num_ops);
-
-    #pragma omp parallel for schedule(static)
-    for (size_t i = 0; i < num_ops; i++) 
+    try 
     {
-        const auto& op = ops[i];
-        try 
+        if (op.type == OperationType::FIND_OP) 
         {
-            if (op.type == OperationType::FIND_OP) 
-            {
-                results[i] = find(op.a);
-            } 
-            else if (op.type == OperationType::UNION_OP) 
-            {
-                bool success = unionSets(op.a, op.b);
-                results[i] = success ? 1 : 0;
-            } 
-            else if (op.type == OperationType::SAMESET_OP) 
-            {
-                bool same = sameSet(op.a, op.b);
-                results[i] = same ? 1 : 0;
-            }
+            result = find(op.a);
         } 
-        catch (const std::out_of_range& e) 
+        else if (op.type == OperationType::UNION_OP) 
         {
-            #pragma omp critical
-            {
-                std::cerr << "Error processing operation " << i << ": " << e.what() << std::endl;
-            }
-            results[i] = -1; // Indicate error
+            bool success = unionSets(op.a, op.b);
+            result = success ? 1 : 0;
         } 
-        catch (const std::exception& e) 
+        else if (op.type == OperationType::SAMESET_OP) 
         {
-            #pragma omp critical
-            {
-                std::cerr << "Generic error processing operation " << i << ": " << e.what() << std::endl;
-            }
-            results[i] = -2; // Indicate generic error
+            bool same = sameSet(op.a, op.b);
+            result = same ? 1 : 0;
         }
+    } 
+    catch (const std::out_of_range& e) 
+    {
+        #pragma omp critical
+        {
+            std::cerr << "Error processing operation " << i << ": " << e.what() << std::endl;
+        }
+        result = -1; // Indicate error
+    } 
+    catch (const std::exception& e) 
+    {
+        #pragma omp critical
+        {
+            std::cerr << "Generic error processing operation " << i << ": " << e.what() << std::endl;
+        }
+        result = -2; // Indicate generic error
     }
 }
 
+void UnionFindParallelLockFreeIPC::processOperations(const std::vector<Operation>& ops, std::vector<int>& results) 
+{
+    size_t num_ops = ops.size();
+    results.resize(num_ops);
+    active_batches.fetch_add(1, std::memory_order_relaxed);
+    UF_PROBE2(batch_start, this, num_ops);
+
+    if (timeline != nullptr) 
+    {
+        timeline->runBatch(num_ops, [&](size_t i) { process_op(ops[i], results[i], i); });
+    } 
+    else 
+    {
+        #pragma omp parallel for schedule(static)
+        for (size_t i = 0; i < num_ops; i++) 
+        {
+            process_op(ops[i], results[i], i);
+        }
+    }
+    UF_PROBE2(batch_end, this, num_ops);
+    active_batches.fetch_sub(1, std::memory_order_relaxed);
+}
+
 int UnionFindParallelLockFreeIPC::size() const 
 {
     return n_elements;
 }
+
+UnionFindStats UnionFindParallelLockFreeIPC::introspect() const 
+{
+    return collect_union_find_stats(
+        n_elements,
+        [this](int i) { int val = A[i].load(std::memory_order_relaxed); return is_root(val) ? i : get_parent(val); },
+        [this](int root) { return get_rank(A[root].load(std::memory_order_relaxed)); },
+        sizeof(*this) + A.allocatedBytes());
+}
+
+int UnionFindParallelLockFreeIPC::compactRange(int begin, int end) 
+{
+    if (begin < 0 || end > n_elements || begin > end) 
+    {
+        throw std::out_of_range("Range out of bounds in compactRange().");
+    }
+    return compact_word_range(begin, end, [this](int i) -> std::atomic<int>& { return A[i]; });
+}
+
+bool UnionFindParallelLockFreeIPC::isBusy() const 
+{
+    return active_batches.load(std::memory_order_relaxed) > 0;
+}
+
+int UnionFindParallelLockFreeIPC::path_length(int u) const 
+{
+    int hops = 0;
+    int val = A[u].load(std::memory_order_relaxed);
+    while (!is_root(val)) 
+    {
+        hops++;
+        val = A[get_parent(val)].load(std::memory_order_relaxed);
+    }
+    return hops;
+}
+
+int UnionFindParallelLockFreeIPC::find_hinted(int u) 
+{
+    int val = A[u].load(std::memory_order_acquire);
+    if (is_root(val)) 
+    {
+        return u; // Roots answer themselves; keep them out of the cache.
+    }
+    int parent = get_parent(val);
+    if (is_root(A[parent].load(std::memory_order_acquire))) 
+    {
+        return parent; // Already flat: cheaper than a cache probe.
+    }
+
+    RootHintCache& cache = RootHintCache::local();
+    int root;
+    if (cache.lookup(hint_owner, u, root) && is_root(A[root].load(std::memory_order_acquire))) 
+    {
+        cache.hits++;
+        return root; // Cached root is still a root, so it is still u's root.
+    }
+    cache.misses++;
+    root = find_internal(u).first;
+    cache.store(hint_owner, u, root);
+    return root;
+}
+
+void UnionFindParallelLockFreeIPC::setRootHints(bool enabled) 
+{
+    root_hints = enabled;
+}
+
+bool UnionFindParallelLockFreeIPC::rootHintsEnabled() const 
+{
+    return root_hints;
+}
+
+void UnionFindParallelLockFreeIPC::setTimeline(TimelineTrace* trace) 
+{
+    timeline = trace;
+}
+
+void UnionFindParallelLockFreeIPC::setProfiler(HotElementProfiler* hot_profiler) 
+{
+    profiler = hot_profiler;
+}
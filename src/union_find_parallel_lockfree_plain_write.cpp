@@ -1,4 +1,6 @@
 #include "union_find_parallel_lockfree_plain_write.hpp"
+#include "union_find_probes.hpp"
+#include "compact_range.hpp"
 #include <omp.h>        
 #include <iostream>     
 #include <vector>      
@@ -12,15 +14,9 @@
 // --- Constructor ---
 UnionFindParallelLockFreePlainWrite::UnionFindParallelLockFreePlainWrite(int n)
     : n_elements(n),
-      A(n) 
+      A(checked_size(n)), 
+      hint_owner(RootHintCache::nextOwnerId())
 {
-    if (n < 0) {
-        throw std::invalid_argument("Number of elements cannot be negative.");
-    }
-    for (int i = 0; i < n; ++i) {
-        // Initialize each element as a root with rank 0. Store rank 0 as value -1.
-        A[i].store(make_root_val(0), std::memory_order_relaxed);
-    }
 }
 
 // --- Core Lock-Free Operations (Aligned with Pseudocode + Full Plain Write Optimization) ---
@@ -32,14 +28,15 @@ std::pair<int, int> UnionFindParallelLockFreePlainWrite::find_internal(int u)
     {
         return {u, p_val}; 
     }
-    int p_idx = p_val; 
+    int p_idx = get_parent(p_val); 
     std::pair<int, int> root_info = find_internal(p_idx);
     int root_idx = root_info.first;
 
     // --- Optimization: Path Compaction via Plain Writes ---
     if (p_idx != root_idx) 
     {
-        A[u].store(root_idx, std::memory_order_relaxed);
+        A[u].store(make_parent_val(root_idx), std::memory_order_relaxed);
+        UF_PROBE3(compress, u, root_idx, p_idx);
     }
 
     return root_info;
@@ -52,7 +49,14 @@ int UnionFindParallelLockFreePlainWrite::find(int a)
         throw std::out_of_range("Element index out of range in find().");
     }
 
-    return find_internal(a).first;
+    int path_len = UF_PROBE_ENABLED(find) ? path_length(a) : 0;
+    int root = root_hints ? find_hinted(a) : find_internal(a).first;
+    UF_PROBE3(find, a, root, path_len);
+    if (profiler != nullptr) 
+    {
+        profiler->noteAccess(a, root);
+    }
+    return root;
 }
 
 bool UnionFindParallelLockFreePlainWrite::unionSets(int a, int b) 
@@ -62,12 +66,27 @@ bool UnionFindParallelLockFreePlainWrite::unionSets(int a, int b)
         throw std::out_of_range("Element index out of range in unionSets().");
     }
 
-    while (true) {
+    int path_len = UF_PROBE_ENABLED(union_link) || UF_PROBE_ENABLED(union_fail) ? path_length(a) + path_length(b) : 0;
+
+    for (int retries = 0; ; retries++) {
         std::pair<int, int> info_a = find_internal(a);
         int root_a_idx = info_a.first;
 
         std::pair<int, int> info_b = find_internal(b);
         int root_b_idx = info_b.first;
+        if (retries > 0) 
+        {
+            UF_PROBE5(union_retry, a, b, root_a_idx, root_b_idx, retries);
+            if (timeline != nullptr) 
+            {
+                TimelineTrace::noteRetry(a, b, retries);
+            }
+        }
+        else if (profiler != nullptr) 
+        {
+            profiler->noteAccess(a, root_a_idx);
+            profiler->noteAccess(b, root_b_idx);
+        }
 
         int current_root_a_val = A[root_a_idx].load(std::memory_order_acquire);
         int current_root_b_val = A[root_b_idx].load(std::memory_order_acquire);
@@ -83,6 +102,7 @@ bool UnionFindParallelLockFreePlainWrite::unionSets(int a, int b)
 
         if (root_a_idx == root_b_idx) 
         {
+            UF_PROBE5(union_fail, a, b, root_a_idx, path_len, retries);
             return false; // Already in the same set
         }
 
@@ -91,17 +111,19 @@ bool UnionFindParallelLockFreePlainWrite::unionSets(int a, int b)
 
         if (rank_a < rank_b) 
         {
-            if (A[root_a_idx].compare_exchange_weak(current_root_a_val, root_b_idx,
+            if (A[root_a_idx].compare_exchange_weak(current_root_a_val, make_parent_val(root_b_idx),
                                                     std::memory_order_release, std::memory_order_relaxed)) 
             {
+                UF_PROBE6(union_link, a, b, root_b_idx, root_a_idx, path_len, retries);
                 return true; 
             }
         } 
         else if (rank_a > rank_b) 
         {
-            if (A[root_b_idx].compare_exchange_weak(current_root_b_val, root_a_idx,
+            if (A[root_b_idx].compare_exchange_weak(current_root_b_val, make_parent_val(root_a_idx),
                                                     std::memory_order_release, std::memory_order_relaxed)) 
             {
+                UF_PROBE6(union_link, a, b, root_a_idx, root_b_idx, path_len, retries);
                 return true; 
             }
         } 
@@ -109,28 +131,34 @@ bool UnionFindParallelLockFreePlainWrite::unionSets(int a, int b)
         {
             if (root_a_idx < root_b_idx) 
             {
-                if (A[root_a_idx].compare_exchange_weak(current_root_a_val, root_b_idx,
+                if (A[root_a_idx].compare_exchange_weak(current_root_a_val, make_parent_val(root_b_idx),
                                                         std::memory_order_release, std::memory_order_relaxed)) 
                 {
                     int new_rank_b_val = make_root_val(rank_b + 1);
                     A[root_b_idx].compare_exchange_weak(current_root_b_val, new_rank_b_val,
                                                         std::memory_order_release, std::memory_order_relaxed);
+                    UF_PROBE6(union_link, a, b, root_b_idx, root_a_idx, path_len, retries);
                     return true;
                 }
             }
             else 
             {
-                if (A[root_b_idx].compare_exchange_weak(current_root_b_val, root_a_idx,
+                if (A[root_b_idx].compare_exchange_weak(current_root_b_val, make_parent_val(root_a_idx),
                                                     std::memory_order_release, std::memory_order_relaxed)) 
                 {
                     int new_rank_a_val = make_root_val(rank_a + 1);
                     A[root_a_idx].compare_exchange_weak(current_root_a_val, new_rank_a_val,
                                                         std::memory_order_release, std::memory_order_relaxed);
+                    UF_PROBE6(union_link, a, b, root_a_idx, root_b_idx, path_len, retries);
                     return true;
                 }
             }
         }
         // If any linking CAS failed, the while(true) loop ensures we retry the entire operation.
+        if (profiler != nullptr) 
+        {
+            profiler->noteCasFailure(root_a_idx, root_b_idx); // Only a lost link CAS gets here
+        }
     }
 }
 
@@ -143,8 +171,13 @@ bool UnionFindParallelLockFreePlainWrite::sameSet(int a, int b)
 
     while (true) 
     {
-        int root_a_idx = find_internal(a).first;
-        int root_b_idx = find_internal(b).first; 
+        int root_a_idx = root_hints ? find_hinted(a) : find_internal(a).first;
+        int root_b_idx = root_hints ? find_hinted(b) : find_internal(b).first; 
+        if (profiler != nullptr) 
+        {
+            profiler->noteAccess(a, root_a_idx);
+            profiler->noteAccess(b, root_b_idx);
+        }
 
         if (root_a_idx == root_b_idx) 
         {
@@ -160,49 +193,147 @@ bool UnionFindParallelLockFreePlainWrite::sameSet(int a, int b)
     }
 }
 
-void UnionFindParallelLockFreePlainWrite::processOperations(const std::vector<Operation>& ops, std::vector<int>& results) {
-    size_t num_ops = ops.size();
-    results.resize(num_ops); 
-
-    #pragma omp parallel for schedule(static) 
-    for (size_t i = 0; i < num_ops; ++i) {
-        const auto& op = ops[i];
-        try 
+// Runs one operation and stores its result (shared by the plain and traced loops).
+void UnionFindParallelLockFreePlainWrite::process_op(const Operation& op, int& result, size_t i) 
+{
+    try 
+    {
+        if (op.type == OperationType::FIND_OP) 
         {
-            if (op.type == OperationType::FIND_OP) 
-            {
-                results[i] = find(op.a);
-            } 
-            else if (op.type == OperationType::UNION_OP) 
-            {
-                bool success = unionSets(op.a, op.b);
-                results[i] = success ? 1 : 0;
-            } 
-            else if (op.type == OperationType::SAMESET_OP) 
-            {
-                bool same = sameSet(op.a, op.b);
-                results[i] = same ? 1 : 0;
-            }
+            result = find(op.a);
         } 
-        catch (const std::out_of_range& e) 
+        else if (op.type == OperationType::UNION_OP) 
         {
-            #pragma omp critical
-            {
-                std::cerr << "Error processing operation " << i << " [" << static_cast<int>(op.type) << "(" << op.a << "," << op.b << ")]: " << e.what() << std::endl;
-            }
-            results[i] = -1; // Indicate error
+            bool success = unionSets(op.a, op.b);
+            result = success ? 1 : 0;
         } 
-        catch (const std::exception& e) 
+        else if (op.type == OperationType::SAMESET_OP) 
         {
-            #pragma omp critical
-            {
-                std::cerr << "Generic error processing operation " << i << " [" << static_cast<int>(op.type) << "(" << op.a << "," << op.b << ")]: " << e.what() << std::endl;
-            }
-            results[i] = -2; // Indicate generic error
+            bool same = sameSet(op.a, op.b);
+            result = same ? 1 : 0;
+        }
+    } 
+    catch (const std::out_of_range& e) 
+    {
+        #pragma omp critical
+        {
+            std::cerr << "Error processing operation " << i << " [" << static_cast<int>(op.type) << "(" << op.a << "," << op.b << ")]: " << e.what() << std::endl;
+        }
+        result = -1; // Indicate error
+    } 
+    catch (const std::exception& e) 
+    {
+        #pragma omp critical
+        {
+            std::cerr << "Generic error processing operation " << i << " [" << static_cast<int>(op.type) << "(" << op.a << "," << op.b << ")]: " << e.what() << std::endl;
+        }
+        result = -2; // Indicate generic error
+    }
+}
+
+void UnionFindParallelLockFreePlainWrite::processOperations(const std::vector<Operation>& ops, std::vector<int>& results) {
+    size_t num_ops = ops.size();
+    results.resize(num_ops);
+    active_batches.fetch_add(1, std::memory_order_relaxed);
+    UF_PROBE2(batch_start, this, num_ops);
+
+    if (timeline != nullptr) 
+    {
+        timeline->runBatch(num_ops, [&](size_t i) { process_op(ops[i], results[i], i); });
+    } 
+    else 
+    {
+        #pragma omp parallel for schedule(static)
+        for (size_t i = 0; i < num_ops; i++) 
+        {
+            process_op(ops[i], results[i], i);
         }
     }
+    UF_PROBE2(batch_end, this, num_ops);
+    active_batches.fetch_sub(1, std::memory_order_relaxed);
 }
 
 int UnionFindParallelLockFreePlainWrite::size() const {
     return n_elements;
 }
+
+UnionFindStats UnionFindParallelLockFreePlainWrite::introspect() const 
+{
+    return collect_union_find_stats(
+        n_elements,
+        [this](int i) { int val = A[i].load(std::memory_order_relaxed); return is_root(val) ? i : get_parent(val); },
+        [this](int root) { return get_rank(A[root].load(std::memory_order_relaxed)); },
+        sizeof(*this) + A.allocatedBytes());
+}
+
+int UnionFindParallelLockFreePlainWrite::compactRange(int begin, int end) 
+{
+    if (begin < 0 || end > n_elements || begin > end) 
+    {
+        throw std::out_of_range("Range out of bounds in compactRange().");
+    }
+    return compact_word_range(begin, end, [this](int i) -> std::atomic<int>& { return A[i]; });
+}
+
+bool UnionFindParallelLockFreePlainWrite::isBusy() const 
+{
+    return active_batches.load(std::memory_order_relaxed) > 0;
+}
+
+int UnionFindParallelLockFreePlainWrite::path_length(int u) const 
+{
+    int hops = 0;
+    int val = A[u].load(std::memory_order_relaxed);
+    while (!is_root(val)) 
+    {
+        hops++;
+        val = A[get_parent(val)].load(std::memory_order_relaxed);
+    }
+    return hops;
+}
+
+int UnionFindParallelLockFreePlainWrite::find_hinted(int u) 
+{
+    int val = A[u].load(std::memory_order_acquire);
+    if (is_root(val)) 
+    {
+        return u; // Roots answer themselves; keep them out of the cache.
+    }
+    int parent = get_parent(val);
+    if (is_root(A[parent].load(std::memory_order_acquire))) 
+    {
+        return parent; // Already flat: cheaper than a cache probe.
+    }
+
+    RootHintCache& cache = RootHintCache::local();
+    int root;
+    if (cache.lookup(hint_owner, u, root) && is_root(A[root].load(std::memory_order_acquire))) 
+    {
+        cache.hits++;
+        return root; // Cached root is still a root, so it is still u's root.
+    }
+    cache.misses++;
+    root = find_internal(u).first;
+    cache.store(hint_owner, u, root);
+    return root;
+}
+
+void UnionFindParallelLockFreePlainWrite::setRootHints(bool enabled) 
+{
+    root_hints = enabled;
+}
+
+bool UnionFindParallelLockFreePlainWrite::rootHintsEnabled() const 
+{
+    return root_hints;
+}
+
+void UnionFindParallelLockFreePlainWrite::setTimeline(TimelineTrace* trace) 
+{
+    timeline = trace;
+}
+
+void UnionFindParallelLockFreePlainWrite::setProfiler(HotElementProfiler* hot_profiler) 
+{
+    profiler = hot_profiler;
+}
@@ -0,0 +1,245 @@
+#include "union_find_phased.hpp"
+#include <vector>
+#include <cassert>
+#include <cstddef>
+#include <stdexcept>
+#include <omp.h>
+
+// Constructor: zeroed storage already holds n roots of rank 0.
+UnionFindPhased::UnionFindPhased(int n)
+    : A(checked_size(n)), num_elements(n)
+{
+    assert(n >= 0 && "Number of elements cannot be negative.");
+}
+
+void UnionFindPhased::beginParallel()
+{
+    if (parallel)
+    {
+        throw std::logic_error("beginParallel() called during a parallel phase.");
+    }
+    parallel = true;
+}
+
+void UnionFindPhased::endParallel()
+{
+    if (!parallel)
+    {
+        throw std::logic_error("endParallel() called outside a parallel phase.");
+    }
+    parallel = false;
+}
+
+bool UnionFindPhased::inParallelPhase() const
+{
+    return parallel;
+}
+
+int UnionFindPhased::find(int a)
+{
+    assert(a >= 0 && a < num_elements && "Element index out of bounds in find().");
+    return parallel ? find_atomic(a).first : find_plain(a);
+}
+
+bool UnionFindPhased::unionSets(int a, int b)
+{
+    assert(a >= 0 && a < num_elements && "Element index 'a' out of bounds in unionSets().");
+    assert(b >= 0 && b < num_elements && "Element index 'b' out of bounds in unionSets().");
+    return parallel ? union_atomic(a, b) : union_plain(a, b);
+}
+
+bool UnionFindPhased::sameSet(int a, int b)
+{
+    assert(a >= 0 && a < num_elements && "Element index 'a' out of bounds in sameSet().");
+    assert(b >= 0 && b < num_elements && "Element index 'b' out of bounds in sameSet().");
+    return parallel ? same_set_atomic(a, b) : find_plain(a) == find_plain(b);
+}
+
+// --- Sequential-phase kernels ---
+
+int UnionFindPhased::find_plain(int a)
+{
+    int p = A[a];
+    if (is_root(p))
+    {
+        return a;
+    }
+    int root = find_plain(get_parent(p));
+    A[a] = make_parent_val(root);
+    return root;
+}
+
+bool UnionFindPhased::union_plain(int a, int b)
+{
+    int rootA = find_plain(a);
+    int rootB = find_plain(b);
+
+    if (rootA == rootB)
+    {
+        return false;
+    }
+
+    int rankA = A[rootA];
+    int rankB = A[rootB];
+
+    if (rankA < rankB)
+    {
+        A[rootA] = make_parent_val(rootB);
+    }
+    else if (rankA > rankB)
+    {
+        A[rootB] = make_parent_val(rootA);
+    }
+    else
+    {
+        A[rootB] = make_parent_val(rootA);
+        A[rootA] = rankA + 1;
+    }
+    return true;
+}
+
+// --- Parallel-phase kernels ---
+
+std::pair<int, int> UnionFindPhased::find_atomic(int u)
+{
+    int p_val = word(u).load(std::memory_order_acquire);
+    if (is_root(p_val))
+    {
+        return {u, p_val};
+    }
+
+    int p_idx = get_parent(p_val);
+    std::pair<int, int> root_info = find_atomic(p_idx);
+    if (p_idx != root_info.first)
+    {
+        // A failed CAS means A[u] changed concurrently; the root found is still valid.
+        word(u).compare_exchange_weak(p_val, make_parent_val(root_info.first),
+                                      std::memory_order_release, std::memory_order_relaxed);
+    }
+    return root_info;
+}
+
+bool UnionFindPhased::union_atomic(int a, int b)
+{
+    while (true)
+    {
+        int root_a = find_atomic(a).first;
+        int root_b = find_atomic(b).first;
+
+        int root_a_val = word(root_a).load(std::memory_order_acquire);
+        int root_b_val = word(root_b).load(std::memory_order_acquire);
+        if (!is_root(root_a_val) || !is_root(root_b_val))
+        {
+            continue; // State changed, retry find
+        }
+        if (root_a == root_b)
+        {
+            return false;
+        }
+
+        // Link the lower rank under the higher; on a tie the lower index goes under
+        // the higher and the new root's rank is bumped (a lost bump only costs balance).
+        if (root_a_val < root_b_val || (root_a_val == root_b_val && root_a < root_b))
+        {
+            if (word(root_a).compare_exchange_weak(root_a_val, make_parent_val(root_b),
+                                                   std::memory_order_release, std::memory_order_relaxed))
+            {
+                if (root_a_val == root_b_val)
+                {
+                    word(root_b).compare_exchange_weak(root_b_val, root_b_val + 1,
+                                                       std::memory_order_release, std::memory_order_relaxed);
+                }
+                return true;
+            }
+        }
+        else
+        {
+            if (word(root_b).compare_exchange_weak(root_b_val, make_parent_val(root_a),
+                                                   std::memory_order_release, std::memory_order_relaxed))
+            {
+                if (root_a_val == root_b_val)
+                {
+                    word(root_a).compare_exchange_weak(root_a_val, root_a_val + 1,
+                                                       std::memory_order_release, std::memory_order_relaxed);
+                }
+                return true;
+            }
+        }
+    }
+}
+
+bool UnionFindPhased::same_set_atomic(int a, int b)
+{
+    while (true)
+    {
+        int root_a = find_atomic(a).first;
+        int root_b = find_atomic(b).first;
+        if (root_a == root_b)
+        {
+            return true;
+        }
+        // Still a root after b's find: the two were in different sets at that point.
+        if (is_root(word(root_a).load(std::memory_order_acquire)))
+        {
+            return false;
+        }
+    }
+}
+
+void UnionFindPhased::processOperations(const std::vector<Operation>& ops, std::vector<int>& results)
+{
+    size_t nOps = ops.size();
+    results.resize(nOps);
+
+    auto run = [&](size_t i)
+    {
+        const auto& op = ops[i];
+        assert(op.a >= 0 && op.a < num_elements && "Operation element 'a' out of bounds.");
+        switch (op.type)
+        {
+            case OperationType::UNION_OP:
+                results[i] = unionSets(op.a, op.b) ? 1 : 0;
+                break;
+            case OperationType::FIND_OP:
+                results[i] = find(op.a);
+                break;
+            case OperationType::SAMESET_OP:
+                results[i] = sameSet(op.a, op.b) ? 1 : 0;
+                break;
+            default:
+                assert(false && "Unknown operation type encountered.");
+                results[i] = -2; // Indicate an error or unexpected state
+                break;
+        }
+    };
+
+    if (parallel)
+    {
+        #pragma omp parallel for schedule(static)
+        for (size_t i = 0; i < nOps; i++)
+        {
+            run(i);
+        }
+    }
+    else
+    {
+        for (size_t i = 0; i < nOps; i++)
+        {
+            run(i);
+        }
+    }
+}
+
+int UnionFindPhased::size() const
+{
+    return num_elements;
+}
+
+UnionFindStats UnionFindPhased::introspect() const
+{
+    return collect_union_find_stats(
+        num_elements,
+        [this](int i) { int val = A[i]; return is_root(val) ? i : get_parent(val); },
+        [this](int root) { return A[root]; },
+        sizeof(*this) + A.allocatedBytes());
+}
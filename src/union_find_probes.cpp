@@ -0,0 +1,16 @@
+#include "union_find_probes.hpp"
+
+// USDT semaphores for the probes in union_find_probes.hpp. The tracer finds them
+// through the probe notes and increments them on attach; they must live in .probes.
+#ifdef UNIONFIND_HAS_USDT
+#define UF_DEFINE_PROBE_SEMAPHORE(name) \
+    __extension__ unsigned short unionfind_##name##_semaphore __attribute__((unused)) __attribute__((section(".probes"))) = 0
+
+UF_DEFINE_PROBE_SEMAPHORE(find);
+UF_DEFINE_PROBE_SEMAPHORE(union_link);
+UF_DEFINE_PROBE_SEMAPHORE(union_fail);
+UF_DEFINE_PROBE_SEMAPHORE(union_retry);
+UF_DEFINE_PROBE_SEMAPHORE(compress);
+UF_DEFINE_PROBE_SEMAPHORE(batch_start);
+UF_DEFINE_PROBE_SEMAPHORE(batch_end);
+#endif
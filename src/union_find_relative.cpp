@@ -0,0 +1,147 @@
+#include "union_find_relative.hpp"
+#include <vector>
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+
+// Constructor: every delta is 0, i.e. every element is its own root with rank 0.
+UnionFindRelative::UnionFindRelative(int n)
+    : D(checked_size(n)), ranks(checked_size(n)), num_elements(n)
+{
+    assert(n >= 0 && "Number of elements cannot be negative.");
+}
+
+void UnionFindRelative::set_parent(int i, int p)
+{
+    assert(i != p && "A non-root cannot point at itself.");
+    std::int64_t delta = static_cast<std::int64_t>(p) - i;
+    bool fits = delta > ESCAPE_DELTA && delta <= INT16_MAX;
+
+    if (fits)
+    {
+        if (D[i] == ESCAPE_DELTA)
+        {
+            overflow.erase(i); // Pointer moved close again; release the far entry.
+        }
+        D[i] = static_cast<std::int16_t>(delta);
+    }
+    else
+    {
+        D[i] = ESCAPE_DELTA;
+        overflow[i] = p;
+    }
+}
+
+int UnionFindRelative::find(int a)
+{
+    assert(a >= 0 && a < num_elements && "Element index out of bounds in find().");
+
+    std::int16_t d = D[a];
+    if (d == 0)
+    {
+        return a;
+    }
+    int p = decode_parent(a, d);
+    int root = find(p);
+    if (root != p)
+    {
+        set_parent(a, root);
+    }
+    return root;
+}
+
+bool UnionFindRelative::unionSets(int a, int b)
+{
+    assert(a >= 0 && a < num_elements && "Element index 'a' out of bounds in unionSets().");
+    assert(b >= 0 && b < num_elements && "Element index 'b' out of bounds in unionSets().");
+
+    int rootA = find(a);
+    int rootB = find(b);
+
+    if (rootA == rootB)
+    {
+        return false;
+    }
+
+    if (ranks[rootA] < ranks[rootB])
+    {
+        set_parent(rootA, rootB);
+    }
+    else if (ranks[rootA] > ranks[rootB])
+    {
+        set_parent(rootB, rootA);
+    }
+    else
+    {
+        set_parent(rootB, rootA);
+        ++ranks[rootA];
+    }
+    return true;
+}
+
+bool UnionFindRelative::sameSet(int a, int b)
+{
+    assert(a >= 0 && a < num_elements && "Element index 'a' out of bounds in sameSet().");
+    assert(b >= 0 && b < num_elements && "Element index 'b' out of bounds in sameSet().");
+    return find(a) == find(b);
+}
+
+void UnionFindRelative::processOperations(const std::vector<Operation>& ops, std::vector<int>& results)
+{
+    size_t nOps = ops.size();
+    results.resize(nOps);
+
+    for (size_t i = 0; i < nOps; i++)
+    {
+        const auto& op = ops[i];
+        assert(op.a >= 0 && op.a < num_elements && "Operation element 'a' out of bounds.");
+
+        switch (op.type)
+        {
+            case OperationType::UNION_OP:
+            {
+                assert(op.b >= 0 && op.b < num_elements && "Operation element 'b' out of bounds for UNION_OP.");
+                results[i] = unionSets(op.a, op.b) ? 1 : 0;
+                break;
+            }
+            case OperationType::FIND_OP:
+            {
+                results[i] = find(op.a);
+                break;
+            }
+            case OperationType::SAMESET_OP:
+            {
+                assert(op.b >= 0 && op.b < num_elements && "Operation element 'b' out of bounds for SAMESET_OP.");
+                results[i] = sameSet(op.a, op.b) ? 1 : 0;
+                break;
+            }
+            default:
+                assert(false && "Unknown operation type encountered.");
+                results[i] = -2; // Indicate an error or unexpected state
+                break;
+        }
+    }
+}
+
+int UnionFindRelative::size() const
+{
+    return num_elements;
+}
+
+size_t UnionFindRelative::overflowCount() const
+{
+    return overflow.size();
+}
+
+UnionFindStats UnionFindRelative::introspect() const
+{
+    // The overflow table's share is estimated from libstdc++'s layout:
+    // one pointer per bucket plus one node (next pointer + key/value) per entry.
+    std::size_t overflow_bytes = overflow.bucket_count() * sizeof(void*) +
+                                 overflow.size() * (sizeof(void*) + sizeof(std::pair<const int, int>));
+    return collect_union_find_stats(
+        num_elements,
+        [this](int i) { std::int16_t d = D[i]; return d == 0 ? i : decode_parent(i, d); },
+        [this](int root) { return static_cast<int>(ranks[root]); },
+        sizeof(*this) + D.allocatedBytes() + ranks.allocatedBytes() + overflow_bytes);
+}
\ No newline at end of file
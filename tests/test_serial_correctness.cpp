@@ -6,8 +6,11 @@
 #include <memory> 
 #include <cassert> 
 #include <iomanip> 
+#include <array>
+#include <cstdint>
 
 #include "union_find.hpp"
+#include "small_union_find.hpp"
 
 using CanonicalOperation = UnionFind::Operation;
 using CanonicalOperationType = UnionFind::OperationType;
@@ -101,6 +104,76 @@ bool load_operations_for_test(const std::string& filename, int& n_elements, std:
     return true;
 }
 
+// SmallUnionFind must be usable in constant expressions: {0,1,2,3}, {4}, {5}, {6,7}.
+constexpr int small_union_find_constexpr_labels()
+{
+    SmallUnionFind<8> uf;
+    uf.unionSets(0, 1);
+    uf.unionSets(2, 3);
+    uf.unionSets(1, 3);
+    uf.unionSets(6, 7);
+    std::array<std::uint8_t, 8> labels{};
+    int components = uf.label(labels);
+    return components * 100 + labels[3] * 10 + labels[7];
+}
+static_assert(small_union_find_constexpr_labels() == 403, "SmallUnionFind constexpr labeling is wrong.");
+
+// Runs the file's operations on SmallUnionFind<65536> (results must equal the
+// serial baseline), then checks label() against find() for every element.
+bool run_small_union_find_test(int n_elements, const std::vector<CanonicalOperation>& operations,
+                               const std::vector<int>& expected) 
+{
+    using Small = SmallUnionFind<65536>;
+    if (n_elements > Small::size()) 
+    {
+        std::cout << "SmallUnionFind test skipped (" << n_elements << " elements > " << Small::size() << ")." << std::endl;
+        return true;
+    }
+    std::vector<Small::Operation> small_ops;
+    small_ops.reserve(operations.size());
+    for (const auto& op : operations) 
+    {
+        small_ops.push_back(Small::Operation{static_cast<Small::OperationType>(op.type), op.a, op.b});
+    }
+    auto uf = std::make_unique<Small>();
+    std::vector<int> results;
+    uf->processOperations(small_ops, results);
+    if (results != expected) 
+    {
+        std::cerr << "SmallUnionFind results differ from the serial baseline." << std::endl;
+        return false;
+    }
+
+    std::vector<int> roots(Small::size());
+    for (int i = 0; i < Small::size(); i++) 
+    {
+        roots[i] = uf->find(i);
+    }
+    auto labels = std::make_unique<std::array<Small::index_type, 65536>>();
+    int components = uf->label(*labels);
+    std::vector<int> root_of_label(components, -1);
+    for (int i = 0; i < Small::size(); i++) 
+    {
+        int& root = root_of_label[(*labels)[i]];
+        if (root < 0) 
+        {
+            root = roots[i];
+        }
+        if (root != roots[i] || (*labels)[roots[i]] != (*labels)[i]) 
+        {
+            std::cerr << "SmallUnionFind label() disagrees with find() at element " << i << "." << std::endl;
+            return false;
+        }
+    }
+    if (components != uf->components()) 
+    {
+        std::cerr << "SmallUnionFind label() returned " << components << " components, expected " << uf->components() << "." << std::endl;
+        return false;
+    }
+    std::cout << "SmallUnionFind<65536> matches the serial baseline (" << components << " components)." << std::endl;
+    return true;
+}
+
 
 int main(int argc, char* argv[]) 
 {
@@ -161,6 +234,9 @@ int main(int argc, char* argv[])
             // std::cout << "First " << print_limit << " results: ";
             // for(size_t i=0; i<print_limit; ++i) std::cout << serial_op_results[i] << " ";
             // std::cout << std::endl;
+
+            // Same operations on the fixed-capacity variant.
+            test_passed = run_small_union_find_test(n_elements, operations, serial_op_results);
         }
     } 
     catch (const std::exception& e) 